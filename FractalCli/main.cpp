@@ -0,0 +1,706 @@
+/*********************************************************************************************
+**
+**	File Name:		main.cpp
+**	Description:	This is the file that contains the command line renderer, it renders one
+**                  view of a fractal to an image file without a window
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include "Fractals.h"
+
+// Render host of the command line, the choices of the user come from the arguments
+class CliHost : public RenderHost
+{
+public:
+    UINT m_language = ID_LANGUAGE_AVX_MT;
+    UINT m_gradient = ID_GRADIENT_1;
+    bool m_pinThreads{};
+    bool m_perturbation{};
+    TuningProfile m_tuningProfile;
+
+    UINT GetLanguage() override
+    {
+        return m_language;
+    }
+
+    UINT GetGradient() override
+    {
+        return m_gradient;
+    }
+
+    bool GetPinThreads() const override
+    {
+        return m_pinThreads;
+    }
+
+    bool GetPerturbation() const override
+    {
+        return m_perturbation;
+    }
+
+    const TuningProfile& GetTuningProfile() const override
+    {
+        return m_tuningProfile;
+    }
+};
+
+static void PrintUsage()
+{
+    printf(
+        "usage: fractal-cli [options] -o IMAGE\n"
+        "  --fractal NAME        mandelbrot, burningship, multibrot, nova or pheonix (mandelbrot)\n"
+        "  --size WxH            size of the image in pixels (900x600)\n"
+        "  --view X Y WIDTH      centre and width of the view on the complex plane, the height\n"
+        "                        follows the image so pixels are square (the start view)\n"
+        "  --backend NAME        CPP, SSE, AVX, CPP_MT, SSE_MT, AVX_MT or AUTO (AVX_MT)\n"
+        "  --gradient N          colour gradient 1 to 7 (1)\n"
+        "  --profile FILE        tuning profile, used by AUTO and for the threads and tiles\n"
+        "  --autotune PROFILE    time the backends, threads and tiles of every fractal at --size\n"
+        "                        on this machine and write the fastest to PROFILE, instead of -o\n"
+        "                        (entries of --profile that are not tuned again are kept)\n"
+        "  --pin                 pin the render threads to cores and NUMA nodes\n"
+        "  --topology            print the NUMA nodes, cores and logical processors found\n"
+        "  --perturbation        render deep tiles from a reference orbit\n"
+        "  --memory MB           memory the bands of rows may take, any size renders in it (256)\n"
+        "  --progress            report the rows that are finished\n"
+        "  --checkpoint          journal the finished tiles to IMAGE.checkpoint, a killed or\n"
+        "                        interrupted run of the same options carries on from it (PPM)\n"
+        "  --frames N            stream N frames zooming into the centre of the view, as Y4M\n"
+        "                        or raw RGB, for video encoders (a still image)\n"
+        "  --zoom FACTOR         width of each frame over the one before it (0.98)\n"
+        "  --fps N               frame rate in the Y4M header (30)\n"
+        "  --rgb                 stream raw RGB frames instead of Y4M\n"
+        "  --ring NAME           publish the frames into the shared memory ring NAME instead,\n"
+        "                        RGBA (RGB with --rgb), for viewers and encoders to read in place\n"
+        "  --slots N             frames the ring holds, at least 2 (3)\n"
+        "  --uncompressed        store the tiles of an iteration archive without runs\n"
+        "  --recolour ARCHIVE    colour the counts of an iteration archive instead of rendering,\n"
+        "                        with --gradient (the gradient it was rendered with)\n"
+        "  --crop X Y WxH        only the pixels of this rectangle of the archive\n"
+        "  --batch SCENES        render every scene of a scene file on one pool of threads,\n"
+        "                        with the backend options, instead of -o\n"
+        "  --save-scene FILE     write the scene of this image to FILE, to render it again\n"
+        "  -o, --output FILE     image to write, PNG for .png, the iteration counts for .iters\n"
+        "                        (an archive to recolour later), otherwise binary PPM\n"
+        "                        - (stdout), .y4m, .rgb or a named pipe with --frames stream\n");
+}
+
+// New fractal of the given name at its starting view, nullptr if the name is unknown
+static std::unique_ptr<Fractal> MakeFractal(const std::string& name, std::shared_ptr<RenderHost> host)
+{
+    if (name == "mandelbrot")
+    {
+        return std::make_unique<Mandelbrot>(host);
+    }
+    if (name == "burningship")
+    {
+        return std::make_unique<BurningShip>(host);
+    }
+    if (name == "multibrot")
+    {
+        return std::make_unique<Multibrot>(host);
+    }
+    if (name == "nova")
+    {
+        return std::make_unique<Nova>(host);
+    }
+    if (name == "pheonix")
+    {
+        return std::make_unique<Pheonix>(host);
+    }
+
+    return nullptr;
+}
+
+// Set by Ctrl+C, the render stops at the next tile and journals what it finished
+static std::atomic<bool> s_interrupted = false;
+
+static void OnInterrupt(int)
+{
+    s_interrupted = true;
+}
+
+// Scenes of a file on one pool of threads, every scene is tried even if some fail
+static int RenderBatch(const std::string& path, std::shared_ptr<RenderHost> host, size_t memoryMB, bool progress)
+{
+    std::vector<Scene> scenes;
+    int badLine;
+    if (!SceneFile::Load(path, scenes, badLine))
+    {
+        if (badLine)
+        {
+            fprintf(stderr, "fractal-cli: %s:%d is not a scene line\n", path.c_str(), badLine);
+        }
+        else
+        {
+            fprintf(stderr, "fractal-cli: can not read %s\n", path.c_str());
+        }
+        return 1;
+    }
+
+    Batch batch([host](const std::string& name) { return MakeFractal(name, host); }, 0, memoryMB << 20);
+    signal(SIGINT, OnInterrupt);
+
+    size_t finished = 0;
+    auto start = std::chrono::steady_clock::now();
+    const size_t written = batch.Run(scenes, [&](size_t scene, bool saved)
+        {
+            ++finished;
+            if (!saved && !s_interrupted)
+            {
+                fprintf(stderr, "%sfractal-cli: can not render %s to %s\n", progress ? "\n" : "",
+                    scenes[scene].fractal.c_str(), scenes[scene].output.string().c_str());
+            }
+            if (progress)
+            {
+                fprintf(stderr, "\r%zu / %zu scenes   %s", finished, scenes.size(), finished == scenes.size() ? "\n" : "");
+            }
+        }, &s_interrupted);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%zu of %zu scenes written in %.1f ms (%.1f per second)\n", written, scenes.size(), ms, written * 1000.0 / ms);
+    return written == scenes.size() ? 0 : 1;
+}
+
+// Tune every fractal at its start view in both precisions and write the profile
+static int Autotune(const std::string& path, std::shared_ptr<CliHost> host)
+{
+    std::vector<std::unique_ptr<Fractal>> fractals;
+    std::vector<Fractal*> tuned;
+    for (const char* name : { "mandelbrot", "burningship", "multibrot", "nova", "pheonix" })
+    {
+        fractals.push_back(MakeFractal(name, host));
+        tuned.push_back(fractals.back().get());
+    }
+
+    signal(SIGINT, OnInterrupt);
+
+    // Starts from --profile, so only the fractals tuned here change
+    TuningProfile profile = host->m_tuningProfile;
+    Autotuner autotuner(static_cast<size_t>(host->m_widthW) * host->m_heightW);
+    auto start = std::chrono::steady_clock::now();
+    const bool finished = autotuner.Run(tuned, profile, &s_interrupted, [](const TuningProfile::Entry& entry)
+        {
+            const RenderSettings& settings = entry.settings;
+            printf("%s %s: %s %d threads, %dx%d tiles, interleave %d%s: %.1f ms\n", entry.fractal.c_str(),
+                entry.useFloat ? "float" : "double", TuningProfile::LanguageName(settings.language), settings.threads,
+                settings.tileWidth, settings.tileHeight, settings.interleave, settings.fma ? ", fma" : "", entry.ms);
+        });
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (!finished)
+    {
+        fprintf(stderr, "fractal-cli: autotune interrupted, %s is not written\n", path.c_str());
+        return 1;
+    }
+
+    if (!profile.Save(path))
+    {
+        fprintf(stderr, "fractal-cli: can not write the tuning profile %s\n", path.c_str());
+        return 1;
+    }
+
+    printf("tuned in %.1f s -> %s\n", ms / 1000, path.c_str());
+    return 0;
+}
+
+// Render frames zooming into the centre of the view, each one written while the next renders
+static bool StreamFrames(const Fractal& fractal, FrameStream& stream, const std::string& output, int frames, double zoom, bool progress)
+{
+    RenderRequest request = fractal.GetRequest();
+    if (!stream.Open(output, request.width, request.height))
+    {
+        return false;
+    }
+    request.format = stream.GetFormat();
+
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        uint8_t* pixels = stream.BeginFrame(request.stride);
+        if (!pixels || !fractal.Render(request, pixels) || !stream.EndFrame())
+        {
+            stream.Close();
+            return false;
+        }
+
+        request.view.Zoom(zoom);
+
+        if (progress)
+        {
+            fprintf(stderr, "\rframe %d / %d   %s", frame + 1, frames, frame + 1 == frames ? "\n" : "");
+        }
+    }
+
+    return stream.Close();
+}
+
+// Render frames zooming into the centre of the view straight into the slots of a ring
+static bool PublishFrames(const Fractal& fractal, FrameRing& ring, const std::string& name, PixelFormat format,
+    int slots, int frames, double zoom, bool progress)
+{
+    RenderRequest request = fractal.GetRequest();
+    request.format = format;
+    if (!ring.Create(name, request.width, request.height, format, slots))
+    {
+        return false;
+    }
+
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        uint8_t* pixels = ring.BeginFrame(request.stride);
+        if (!fractal.Render(request, pixels))
+        {
+            return false;
+        }
+        ring.Publish(request);
+
+        request.view.Zoom(zoom);
+
+        if (progress)
+        {
+            fprintf(stderr, "\rframe %d / %d   %s", frame + 1, frames, frame + 1 == frames ? "\n" : "");
+        }
+    }
+
+    return true;
+}
+
+// Lower case extension of a path, with its dot
+static std::string Extension(const std::string& path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return extension;
+}
+
+// Rows finished and the time left, on one line of stderr
+static std::function<void(int, int)> ProgressReport(std::chrono::steady_clock::time_point start)
+{
+    return [start](int rows, int height)
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            fprintf(stderr, "\r%d / %d rows (%.1f%%), %.0f s left   ", rows, height, 100.0 * rows / height,
+                seconds * (height - rows) / rows);
+            if (rows == height)
+            {
+                fprintf(stderr, "\n");
+            }
+        };
+}
+
+// Colour the counts of an archive into an image, the kernels are not run
+static int RecolourArchive(const std::string& path, const std::string& output, int gradient, bool cropped, Tile crop,
+    size_t memoryMB, bool progress)
+{
+    IterationArchive archive;
+    if (!archive.Open(path))
+    {
+        fprintf(stderr, "fractal-cli: %s is not a finished iteration archive\n", path.c_str());
+        return 1;
+    }
+
+    const IterationArchiveHeader& header = archive.GetHeader();
+    if (!cropped)
+    {
+        crop = { 0, 0, header.width, header.height };
+    }
+    else if (crop.xEnd > header.width || crop.yEnd > header.height)
+    {
+        fprintf(stderr, "fractal-cli: the crop is outside the %dx%d archive\n", header.width, header.height);
+        return 1;
+    }
+
+    std::unique_ptr<PosterSink> sink;
+    if (Extension(output) == ".png")
+    {
+        sink = std::make_unique<PngSink>(output);
+    }
+    else
+    {
+        sink = std::make_unique<PpmSink>(output);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const UINT colours = gradient ? ID_GRADIENT_1 + gradient - 1 : header.gradient;
+    if (!archive.Recolour(*sink, crop, colours, memoryMB << 20, progress ? ProgressReport(start) : nullptr))
+    {
+        fprintf(stderr, "fractal-cli: can not write %s\n", output.c_str());
+        return 1;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%s %dx%d of %dx%d recoloured: %.1f ms -> %s\n", archive.GetFractal().c_str(), crop.xEnd - crop.xStart,
+        crop.yEnd - crop.yStart, header.width, header.height, ms, output.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    auto host = std::make_shared<CliHost>();
+    std::string fractalName = "mandelbrot", output;
+    bool hasView = false, progress = false, checkpointed = false, rawFrames = false, compress = true, cropped = false, topology = false;
+    int frames = 0, fps = 30, slots = 3, gradient = 0;
+    std::string ringName, archivePath, batchPath, scenePath, autotunePath;
+    Tile crop{};
+    double zoom = 0.98;
+    double viewX = 0, viewY = 0, viewWidth = 0;
+    size_t memoryMB = 256;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--fractal" && hasValue)
+        {
+            fractalName = argv[++i];
+            std::transform(fractalName.begin(), fractalName.end(), fractalName.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        }
+        else if (arg == "--size" && hasValue)
+        {
+            if (sscanf(argv[++i], "%dx%d", &host->m_widthW, &host->m_heightW) != 2 || host->m_widthW <= 0 || host->m_heightW <= 0)
+            {
+                fprintf(stderr, "fractal-cli: bad size %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--view" && i + 3 < argc)
+        {
+            viewX = atof(argv[++i]);
+            viewY = atof(argv[++i]);
+            viewWidth = atof(argv[++i]);
+            hasView = viewWidth > 0;
+        }
+        else if (arg == "--backend" && hasValue)
+        {
+            std::string name = argv[++i];
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(toupper(c)); });
+            host->m_language = name == "AUTO" ? ID_LANGUAGE_AUTO : TuningProfile::LanguageFromName(name);
+            if (!host->m_language)
+            {
+                fprintf(stderr, "fractal-cli: unknown backend %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--gradient" && hasValue)
+        {
+            gradient = atoi(argv[++i]);
+            if (gradient < 1 || gradient > 7)
+            {
+                fprintf(stderr, "fractal-cli: the gradient is 1 to 7\n");
+                return 1;
+            }
+            host->m_gradient = ID_GRADIENT_1 + gradient - 1;
+        }
+        else if (arg == "--profile" && hasValue)
+        {
+            if (!host->m_tuningProfile.Load(argv[++i]))
+            {
+                fprintf(stderr, "fractal-cli: can not read the tuning profile %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--pin")
+        {
+            host->m_pinThreads = true;
+        }
+        else if (arg == "--perturbation")
+        {
+            host->m_perturbation = true;
+        }
+        else if (arg == "--memory" && hasValue)
+        {
+            long long megabytes = atoll(argv[++i]);
+            if (megabytes <= 0)
+            {
+                fprintf(stderr, "fractal-cli: bad memory %s\n", argv[i]);
+                return 1;
+            }
+            memoryMB = static_cast<size_t>(megabytes);
+        }
+        else if (arg == "--progress")
+        {
+            progress = true;
+        }
+        else if (arg == "--checkpoint")
+        {
+            checkpointed = true;
+        }
+        else if (arg == "--frames" && hasValue)
+        {
+            frames = atoi(argv[++i]);
+            if (frames <= 0)
+            {
+                fprintf(stderr, "fractal-cli: bad frames %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--zoom" && hasValue)
+        {
+            zoom = atof(argv[++i]);
+            if (zoom <= 0)
+            {
+                fprintf(stderr, "fractal-cli: bad zoom %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--fps" && hasValue)
+        {
+            fps = atoi(argv[++i]);
+            if (fps <= 0)
+            {
+                fprintf(stderr, "fractal-cli: bad fps %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--rgb")
+        {
+            rawFrames = true;
+        }
+        else if (arg == "--ring" && hasValue)
+        {
+            ringName = argv[++i];
+        }
+        else if (arg == "--slots" && hasValue)
+        {
+            slots = atoi(argv[++i]);
+            if (slots < 2)
+            {
+                fprintf(stderr, "fractal-cli: bad slots %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--uncompressed")
+        {
+            compress = false;
+        }
+        else if (arg == "--batch" && hasValue)
+        {
+            batchPath = argv[++i];
+        }
+        else if (arg == "--save-scene" && hasValue)
+        {
+            scenePath = argv[++i];
+        }
+        else if (arg == "--recolour" && hasValue)
+        {
+            archivePath = argv[++i];
+        }
+        else if (arg == "--crop" && i + 3 < argc)
+        {
+            int x = atoi(argv[++i]), y = atoi(argv[++i]), width, height;
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || x < 0 || y < 0 || width <= 0 || height <= 0)
+            {
+                fprintf(stderr, "fractal-cli: bad crop %s %s %s\n", argv[i - 2], argv[i - 1], argv[i]);
+                return 1;
+            }
+            crop = { x, y, x + width, y + height };
+            cropped = true;
+        }
+        else if (arg == "--topology")
+        {
+            topology = true;
+        }
+        else if (arg == "--autotune" && hasValue)
+        {
+            autotunePath = argv[++i];
+        }
+        else if ((arg == "-o" || arg == "--output") && hasValue)
+        {
+            output = argv[++i];
+        }
+        else
+        {
+            PrintUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // What the threads are pinned to with --pin
+    if (topology)
+    {
+        printf("%ls", Topology::Get().Report().c_str());
+        return 0;
+    }
+
+    if (!autotunePath.empty())
+    {
+        return Autotune(autotunePath, host);
+    }
+
+    if (!batchPath.empty())
+    {
+        return RenderBatch(batchPath, host, memoryMB, progress);
+    }
+
+    if (output.empty() && ringName.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    // Frames go to stdout, a pipe or a video file, anything else is a still image
+    const std::string extension = Extension(output);
+    const bool archived = extension == ".iters";
+
+    if (!archivePath.empty())
+    {
+        if (archived || output == "-" || extension == ".y4m" || extension == ".rgb")
+        {
+            fprintf(stderr, "fractal-cli: an archive recolours into a PPM or PNG\n");
+            return 1;
+        }
+
+        return RecolourArchive(archivePath, output, gradient, cropped, crop, memoryMB, progress);
+    }
+
+    const bool streamed = frames > 0 || output == "-" || extension == ".y4m" || extension == ".rgb";
+    rawFrames = rawFrames || extension == ".rgb";
+
+    // The summary must not end up in the frames on stdout
+    FILE* report = output == "-" ? stderr : stdout;
+
+    // A PNG is compressed as it streams, only a PPM can be picked up part way through
+    if (checkpointed && (extension == ".png" || archived || streamed || !ringName.empty()))
+    {
+        fprintf(stderr, "fractal-cli: checkpoints need a PPM output\n");
+        return 1;
+    }
+
+    if (!scenePath.empty() && (streamed || !ringName.empty()))
+    {
+        fprintf(stderr, "fractal-cli: a scene is of one still image\n");
+        return 1;
+    }
+
+    std::unique_ptr<Fractal> fractal = MakeFractal(fractalName, host);
+    if (!fractal)
+    {
+        fprintf(stderr, "fractal-cli: unknown fractal %s\n", fractalName.c_str());
+        return 1;
+    }
+
+    if (hasView)
+    {
+        double viewHeight = viewWidth * host->m_heightW / host->m_widthW;
+        fractal->SetViewport(Viewport::FromBounds(viewX - viewWidth / 2, viewX + viewWidth / 2, viewY - viewHeight / 2, viewY + viewHeight / 2));
+    }
+
+    if (!ringName.empty())
+    {
+        frames = std::max(frames, 1);
+        FrameRing ring;
+
+        auto start = std::chrono::steady_clock::now();
+        if (!PublishFrames(*fractal, ring, ringName, rawFrames ? PixelFormat::RGB : PixelFormat::RGBA, slots, frames, zoom, progress))
+        {
+            fprintf(stderr, "fractal-cli: can not publish to the ring %s\n", ringName.c_str());
+            return 1;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        printf("%s %dx%d %s: %d frames in %.1f ms (%.1f fps) -> ring %s\n", fractal->GetName(), host->m_widthW, host->m_heightW,
+            TuningProfile::LanguageName(fractal->GetSettings().language), frames, ms, frames * 1000.0 / ms, ringName.c_str());
+        return 0;
+    }
+
+    if (streamed)
+    {
+        frames = std::max(frames, 1);
+        FrameStream stream(rawFrames ? FrameStream::Format::RGB : FrameStream::Format::Y4M, fps);
+
+        auto start = std::chrono::steady_clock::now();
+        if (!StreamFrames(*fractal, stream, output, frames, zoom, progress))
+        {
+            fprintf(stderr, "fractal-cli: can not write %s\n", output.c_str());
+            return 1;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        fprintf(report, "%s %dx%d %s: %d frames in %.1f ms (%.1f fps) -> %s\n", fractal->GetName(), host->m_widthW, host->m_heightW,
+            TuningProfile::LanguageName(fractal->GetSettings().language), frames, ms, frames * 1000.0 / ms, output.c_str());
+        return 0;
+    }
+
+    // The image is rendered in bands straight into the file, so any size fits in the memory budget
+    std::unique_ptr<PosterSink> sink;
+    if (archived)
+    {
+        sink = std::make_unique<ArchiveSink>(output, *fractal, fractal->GetRequest(), compress);
+    }
+    else if (extension == ".png")
+    {
+        sink = std::make_unique<PngSink>(output);
+    }
+    else
+    {
+        sink = std::make_unique<PpmSink>(output);
+    }
+
+    // The output of a scene is relative to the folder of its file
+    if (!scenePath.empty())
+    {
+        std::error_code ignored;
+        const std::filesystem::path folder = std::filesystem::absolute(scenePath).parent_path();
+        const Scene scene{ fractalName, fractal->GetViewport(), 0, host->m_gradient, host->m_widthW, host->m_heightW,
+            std::filesystem::proximate(std::filesystem::absolute(output), folder, ignored) };
+
+        if (!SceneFile::Save(scenePath, { scene }))
+        {
+            fprintf(stderr, "fractal-cli: can not write %s\n", scenePath.c_str());
+            return 1;
+        }
+    }
+
+    Poster poster(*fractal, fractal->GetRequest(), memoryMB << 20);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<Checkpoint> checkpoint;
+    if (checkpointed)
+    {
+        checkpoint = std::make_unique<Checkpoint>(output + ".checkpoint");
+        signal(SIGINT, OnInterrupt);
+    }
+
+    bool written = poster.Render(*sink, progress ? ProgressReport(start) : nullptr, &s_interrupted, checkpoint.get());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (!written && s_interrupted)
+    {
+        fprintf(stderr, "fractal-cli: stopped, %zu tiles are journaled in %s.checkpoint, run again to carry on\n",
+            checkpoint->CountFinished(), output.c_str());
+        return 1;
+    }
+
+    if (!written)
+    {
+        // An archive is only left behind once every tile is in it
+        if (archived)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(output, ignored);
+        }
+
+        fprintf(stderr, "fractal-cli: can not write %s\n", output.c_str());
+        return 1;
+    }
+
+    fprintf(report, "%s %dx%d %s: %.1f ms -> %s\n", fractal->GetName(), host->m_widthW, host->m_heightW,
+        TuningProfile::LanguageName(fractal->GetSettings().language), ms, output.c_str());
+    return 0;
+}
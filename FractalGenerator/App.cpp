@@ -22,7 +22,13 @@ App::App()
 
 App::~App()
 {
+    // The job writes to the buffers, it has to stop first
+    CancelRender();
+    CancelAutotune();
+    CancelSave();
+
     _aligned_free(m_pixelBuffer);
+    _aligned_free(m_frontBuffer);
 }
 
 int App::Run(HINSTANCE hInstance, int nCmdShow)
@@ -55,6 +61,9 @@ int App::Run(HINSTANCE hInstance, int nCmdShow)
 
     m_hInst = hInstance;
 
+    // Use the settings tuned for this machine, if it has been tuned
+    m_tuningProfile.Load(ProfilePath());
+
     // Create the window
     m_hWnd = CreateWindowEx(
         WS_EX_OVERLAPPEDWINDOW,
@@ -121,6 +130,21 @@ UINT App::GetGradient()
     return m_menuOptionsOn.m_gradient;
 }
 
+const TuningProfile& App::GetTuningProfile() const
+{
+    return m_tuningProfile;
+}
+
+bool App::GetPinThreads() const
+{
+    return m_bPinThreads;
+}
+
+bool App::GetPerturbation() const
+{
+    return m_bPerturbation;
+}
+
 LRESULT CALLBACK App::StaticWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
     App* pThis = nullptr;
@@ -161,11 +185,13 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         if (m_bRender)
         {
             // Transfer off-screen bitmap onto the window
-            m_fractal->Draw(hdc, m_pixelBuffer, &m_gif, m_bRecording);
+            // Progressive previews are not added to the gif, only the final image
+            std::lock_guard<std::mutex> lock(m_frontMutex);
+            Draw(hdc, m_frontBuffer, &m_gif, m_bRecording && !m_bPreview);
             // The image has been generated to the window
             m_bCanZoom = true;
 
-            if (m_bTimer)
+            if (m_bTimer && !m_bPreview)
             {
                 // End timer once rendered and loaded
                 QueryPerformanceCounter(&m_liEndTime);
@@ -174,6 +200,24 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                 double dSeconds = static_cast<double>(m_liTicks.QuadPart) / m_liFrequency.QuadPart;
                 std::wstring strText = std::format(L"{:.2f} ms", dSeconds * 1000);
 
+                // Show how many zooms and moves the render covered
+                if (m_renderQueue.GetMerged() > 1)
+                {
+                    strText += std::format(L" ({} merged)", m_renderQueue.GetMerged());
+                }
+
+                if (m_bPrefetched)
+                {
+                    strText += L" (prefetched)";
+                }
+                else if (m_costMapReport.chunks > 1)
+                {
+                    // How well the threads were given equal work from the last frame's cost map
+                    // The render thread copies the report with the pass, the lock above covers it
+                    strText += std::format(L" (cost map error {:.0f}%, imbalance {:.2f})",
+                        m_costMapReport.predictionError * 100, m_costMapReport.chunkImbalance);
+                }
+
                 TextOut(hdc, 0, m_heightW - 79, strText.c_str(), static_cast<int>(strText.length()));
 
                 m_bTimer = false;
@@ -192,48 +236,35 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         {
         case ID_RENDER_GENERATE:
         {
+            // Renders would throw off the timings of the autotune
+            if (m_autotuneThread.joinable())
+            {
+                break;
+            }
+
             // Start timer at the start of render
             m_bTimer = true;
             QueryPerformanceCounter(&m_liStartTime);
 
+            // The old fractal is about to be replaced
+            CancelRender();
+            m_prefetcher.Clear();
+            m_renderQueue.Clear();
+            KillTimer(hWnd, ID_TIMER_REFINE);
+            m_fullFrameMs = 0;
+
             // Render the selected fractal to the pixel buffer
             // Resetting the complex plane zoom size after generation button
-            switch (m_menuOptionsOn.m_fractal)
-            {
-            case ID_FRACTAL_MANDELBROT:
-            {
-                m_fractal = std::make_unique<Mandelbrot>(shared_from_this());
-                break;
-            }
-            case ID_FRACTAL_BURNINGSHIP:
-            {
-                m_fractal = std::make_unique<BurningShip>(shared_from_this());
-                break;
-            }
-            case ID_FRACTAL_MULTIBROT:
-            {
-                m_fractal = std::make_unique<Multibrot>(shared_from_this());
-                break;
-            }
-            case ID_FRACTAL_NOVA:
-            {
-                m_fractal = std::make_unique<Nova>(shared_from_this());
-                break;
-            }
-            case ID_FRACTAL_PHEONIX:
+            m_fractal = MakeFractal(m_menuOptionsOn.m_fractal);
+
+            // Spread the buffer over the NUMA nodes before the first render writes it
+            if (m_bPinThreads && !m_bBufferPlaced)
             {
-                m_fractal = std::make_unique<Pheonix>(shared_from_this());
-                break;
+                PlacePixelBuffer();
             }
-            } // Switch
 
-            // Rendering the mandelbrot to the pixel buffer
-            m_fractal->Render(m_pixelBuffer);
-
-            // Painting to the window
-            // Force a repaint to transfer the bitmap buffer to the window
-            m_bRender = true;
-            InvalidateRect(hWnd, NULL, TRUE);
+            // Rendering the fractal to the window
+            RenderToWindow(hWnd);
 
             break;
         }
@@ -309,12 +340,179 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
             break;
         }
+        case ID_RENDER_SAVEIMAGE:
+        {
+            // One image at a time, and not while the autotune takes its timings
+            if (!m_fractal || m_saveThread.joinable() || m_autotuneThread.joinable())
+            {
+                break;
+            }
+
+            TCHAR folderPath[MAX_PATH];
+
+            BROWSEINFO bi = { 0 };
+            bi.lpszTitle = L"Select a Folder";
+            bi.ulFlags = BIF_RETURNONLYFSDIRS | BIF_NEWDIALOGSTYLE;
+
+            LPITEMIDLIST pidl = SHBrowseForFolder(&bi);
+            if (!pidl)
+            {
+                break;
+            }
+
+            bool hasPath = SHGetPathFromIDList(pidl, folderPath);
+            CoTaskMemFree(pidl);
+
+            if (!hasPath)
+            {
+                MessageBox(NULL,
+                    _T("Failed to get folder path."),
+                    NULL,
+                    NULL);
+
+                break;
+            }
+
+            std::filesystem::path filePath{ folderPath };
+            filePath /= "output.png";
+
+            StartSave(hWnd, filePath);
+
+            break;
+        }
+        case ID_RENDER_SAVESCENE:
+        {
+            if (!m_fractal)
+            {
+                break;
+            }
+
+            TCHAR folderPath[MAX_PATH];
+
+            BROWSEINFO bi = { 0 };
+            bi.lpszTitle = L"Select a Folder";
+            bi.ulFlags = BIF_RETURNONLYFSDIRS | BIF_NEWDIALOGSTYLE;
+
+            LPITEMIDLIST pidl = SHBrowseForFolder(&bi);
+            if (!pidl)
+            {
+                break;
+            }
+
+            bool hasPath = SHGetPathFromIDList(pidl, folderPath);
+            CoTaskMemFree(pidl);
+
+            if (!hasPath)
+            {
+                MessageBox(NULL,
+                    _T("Failed to get folder path."),
+                    NULL,
+                    NULL);
+
+                break;
+            }
+
+            // The exact view at the size of the window, fractal-cli --batch renders it to render.png
+            // beside the scene
+            std::string name = m_fractal->GetName();
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+
+            const RenderRequest request = m_fractal->GetRequest();
+            const Scene scene{ name, request.view, request.maxIterations, request.gradient, request.width, request.height, "render.png" };
+
+            std::filesystem::path filePath{ folderPath };
+            filePath /= "scene.txt";
+
+            if (!SceneFile::Save(filePath, { scene }))
+            {
+                MessageBox(hWnd, _T("Failed to save the scene."), _T("Error"), MB_OK | MB_ICONERROR);
+            }
+
+            break;
+        }
+        case ID_RENDER_PROGRESSIVE:
+        {
+            HMENU hMenu = GetMenu(hWnd);
+
+            // Toggle coarse-to-fine rendering
+            m_bProgressive = !m_bProgressive;
+            CheckMenuItem(hMenu, ID_RENDER_PROGRESSIVE, m_bProgressive ? MF_CHECKED : MF_UNCHECKED);
+
+            break;
+        }
+        case ID_RENDER_DEADLINE:
+        {
+            HMENU hMenu = GetMenu(hWnd);
+
+            // Toggle rendering in frames of a fixed time budget
+            m_bDeadline = !m_bDeadline;
+            CheckMenuItem(hMenu, ID_RENDER_DEADLINE, m_bDeadline ? MF_CHECKED : MF_UNCHECKED);
+
+            break;
+        }
+        case ID_RENDER_PREFETCH:
+        {
+            HMENU hMenu = GetMenu(hWnd);
+
+            // Toggle rendering the likely next views while idle
+            m_bPrefetch = !m_bPrefetch;
+            CheckMenuItem(hMenu, ID_RENDER_PREFETCH, m_bPrefetch ? MF_CHECKED : MF_UNCHECKED);
+
+            if (!m_bPrefetch)
+            {
+                m_prefetcher.Clear();
+            }
+
+            break;
+        }
+        case ID_RENDER_AUTOTUNE:
+        {
+            StartAutotune(hWnd);
+            break;
+        }
+        case ID_RENDER_PINTHREADS:
+        {
+            HMENU hMenu = GetMenu(hWnd);
+
+            // Toggle pinning the render threads to cores and NUMA nodes
+            m_bPinThreads = !m_bPinThreads;
+            CheckMenuItem(hMenu, ID_RENDER_PINTHREADS, m_bPinThreads ? MF_CHECKED : MF_UNCHECKED);
+
+            // The buffer was first written by threads that could have been on any node
+            m_bBufferPlaced = false;
+            if (m_bPinThreads && m_fractal)
+            {
+                PlacePixelBuffer();
+            }
+
+            break;
+        }
+        case ID_RENDER_PERTURBATION:
+        {
+            HMENU hMenu = GetMenu(hWnd);
+
+            // Toggle rendering deep zooms from a reference orbit
+            m_bPerturbation = !m_bPerturbation;
+            CheckMenuItem(hMenu, ID_RENDER_PERTURBATION, m_bPerturbation ? MF_CHECKED : MF_UNCHECKED);
+
+            // Views rendered ahead used the other mode
+            m_prefetcher.Clear();
+
+            break;
+        }
+        case ID_RENDER_TOPOLOGY:
+        {
+            std::wstring strText = Topology::Get().Report();
+            MessageBox(hWnd, strText.c_str(), _T("Topology"), MB_OK | MB_ICONINFORMATION);
+            break;
+        }
         case ID_LANGUAGE_CPP:
         case ID_LANGUAGE_SSE:
         case ID_LANGUAGE_AVX:
         case ID_LANGUAGE_CPP_MT:
         case ID_LANGUAGE_SSE_MT:
         case ID_LANGUAGE_AVX_MT:
+        case ID_LANGUAGE_AUTO:
         {
             HMENU hMenu = GetMenu(hWnd);
 
@@ -324,6 +522,10 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
             m_menuOptionsOn.m_language = param;
 
+            // A job already rendering keeps the request it started with, the next render uses this
+            // Prefetched images are from the old backend
+            m_prefetcher.Clear();
+
             break;
         }
         case ID_FRACTAL_MANDELBROT:
@@ -358,6 +560,9 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
             m_menuOptionsOn.m_gradient = param;
 
+            // Prefetched images are in the old gradient
+            m_prefetcher.Clear();
+
             break;
         }
         } // Switch
@@ -372,15 +577,9 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             GetCursorPos(&m_clickPoint);
             ScreenToClient(hWnd, &m_clickPoint);
 
-            m_fractal->MoveScreen(&m_clickPoint);
-
-            // Rendering the mandelbrot to the pixel buffer
-            m_fractal->Render(m_pixelBuffer);
-
-            // Painting to the window
-            // Force a repaint to transfer the bitmap buffer to the window
-            m_bRender = true;
-            InvalidateRect(hWnd, NULL, TRUE);
+            // Moving the view waits in the queue until the stale render has stopped
+            m_renderQueue.PushMove(m_clickPoint);
+            RequestRender(hWnd);
         }
 
         break;
@@ -392,22 +591,130 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             int wheelDelta = GET_WHEEL_DELTA_WPARAM(wParam);
 
             // Scrolling up/down (zoomin in/out)
-            m_fractal->ZoomScreen(wheelDelta > 0 ? 
+            // Zooming waits in the queue until the stale render has stopped
+            m_renderQueue.PushZoom(wheelDelta > 0 ?
                 Fractal::ZoomType::ZOOM_IN : Fractal::ZoomType::ZOOM_OUT);
+            RequestRender(hWnd);
+        }
 
-            // Rendering the mandelbrot to the pixel buffer
-            m_fractal->Render(m_pixelBuffer);
+        break;
+    }
+    case WM_RENDER_PASS:
+    {
+        // Passes of jobs that have since been cancelled are ignored
+        if (lParam == m_jobId)
+        {
+            m_bPreview = wParam > 1;
+            m_bFullFrame = wParam == 1;
 
-            // Painting to the window
-            // Force a repaint to transfer the bitmap buffer to the window
+            // Prefetched frames took no time, they say nothing about the cost of a frame
+            if (static_cast<int>(wParam) == m_previewScale && !m_bPrefetched)
+            {
+                // Measure the frame and scale it up to what a full resolution frame costs
+                LARGE_INTEGER liNow;
+                QueryPerformanceCounter(&liNow);
+                double dMs = static_cast<double>(liNow.QuadPart - m_liStartTime.QuadPart) * 1000 / m_liFrequency.QuadPart;
+                m_fullFrameMs = dMs * m_previewScale * m_previewScale;
+            }
+
+            // Force a repaint to transfer the front buffer to the window
             m_bRender = true;
-            InvalidateRect(hWnd, NULL, TRUE);
+            InvalidateRect(hWnd, NULL, FALSE);
+        }
+
+        break;
+    }
+    case WM_RENDER_DONE:
+    {
+        // Anything that came in while the job was running is rendered in one go
+        if (lParam == m_jobId && !m_renderQueue.IsEmpty())
+        {
+            RenderQueued(hWnd);
+        }
+        else if (lParam == m_jobId && m_bPrefetch && m_bFullFrame)
+        {
+            // Nothing is rendering, use the idle cores on the views that are likely next
+            m_prefetcher.Start(*m_fractal, m_pixelBuffer);
+        }
+
+        break;
+    }
+    case WM_SAVE_DONE:
+    {
+        // The thread posts this just before it returns
+        if (m_saveThread.joinable())
+        {
+            m_saveThread.join();
+        }
+        SetWindowText(hWnd, m_autotuneThread.joinable() ? _T("Fractal Playground App - Autotuning...") : m_pszTitle);
+
+        if (!wParam)
+        {
+            MessageBox(hWnd, _T("Failed to save the image."), _T("Error"), MB_OK | MB_ICONERROR);
+        }
+
+        break;
+    }
+    case WM_AUTOTUNE_DONE:
+    {
+        // The thread posts this just before it returns
+        if (m_autotuneThread.joinable())
+        {
+            m_autotuneThread.join();
+        }
+        SetWindowText(hWnd, m_pszTitle);
+
+        if (wParam)
+        {
+            // Renders and prefetches read the profile, they have to stop before it changes
+            CancelRender();
+            m_prefetcher.Clear();
+            m_tuningProfile = m_autotuneResult;
+
+            std::filesystem::path path = ProfilePath();
+            if (m_tuningProfile.Save(path))
+            {
+                std::wstring strText = L"Tuning profile saved to " + path.wstring();
+                MessageBox(hWnd, strText.c_str(), _T("Autotune"), MB_OK);
+            }
+            else
+            {
+                MessageBox(hWnd, _T("Failed to save the tuning profile."), _T("Error"), MB_OK | MB_ICONERROR);
+            }
+        }
+
+        break;
+    }
+    case WM_TIMER:
+    {
+        if (wParam == ID_TIMER_REFINE)
+        {
+            if ((m_job && !m_job->IsDone()) || !m_renderQueue.IsEmpty())
+            {
+                // Still navigating, check again later
+                break;
+            }
+
+            KillTimer(hWnd, ID_TIMER_REFINE);
+
+            // Input has gone idle, replace the preview with the full resolution image
+            if (m_previewScale > 1)
+            {
+                m_bTimer = true;
+                QueryPerformanceCounter(&m_liStartTime);
+
+                RenderToWindow(hWnd);
+            }
         }
 
         break;
     }
     case WM_DESTROY:
     {
+        CancelRender();
+        CancelAutotune();
+        CancelSave();
+        m_prefetcher.Stop();
         PostQuitMessage(0);
         break;
     }
@@ -420,6 +727,281 @@ LRESULT App::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     return 0;
 }
 
+void App::Draw(HDC hdc, Colour* pixelBuffer, GifWriter* gif, bool recording)
+{
+    // Define the bitmap
+    BITMAPINFO bmpInfo;
+    bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmpInfo.bmiHeader.biWidth = m_widthW;
+    bmpInfo.bmiHeader.biHeight = -m_heightW; // Negative to indicate top-down bitmap
+    bmpInfo.bmiHeader.biPlanes = 1;
+    bmpInfo.bmiHeader.biBitCount = 32; // 32 bits per pixel (COLORREF format)
+    bmpInfo.bmiHeader.biCompression = BI_RGB;
+
+    // Transfer the pixelBuffer to the screen
+    SetDIBitsToDevice(
+        hdc,
+        0, 0, m_widthW, m_heightW,         // Destination rectangle on the screen
+        0, 0, 0, m_heightW,             // Source rectangle in the buffer
+        pixelBuffer,                 // Pixel buffer source
+        &bmpInfo,                    // Bitmap information
+        DIB_RGB_COLORS               // Color format (RGB)
+    );
+
+    if (recording)
+    {
+        GifWriteFrame(gif, (uint8_t*)pixelBuffer, m_widthW, m_heightW, m_gifDelay);
+    }
+}
+
+void App::RenderToWindow(HWND hWnd, int previewScale)
+{
+    // Only one job at a time renders into the pixel buffer
+    // A real render always comes before the prefetching
+    CancelRender();
+    m_prefetcher.Stop();
+
+    m_previewScale = previewScale;
+    m_bFullFrame = false;
+    m_bPrefetched = false;
+
+    LPARAM jobId = ++m_jobId;
+    size_t bufferSize = sizeof(Colour) * m_widthW * m_heightW;
+
+    // Runs on the render thread, publishes the pass and lets the window know
+    auto onPass = [this, hWnd, jobId, bufferSize](RenderJob&, int step)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_frontMutex);
+                memcpy(m_frontBuffer, m_pixelBuffer, bufferSize);
+                m_costMapReport = m_fractal->GetCostMapReport();
+            }
+
+            PostMessage(hWnd, WM_RENDER_PASS, step, jobId);
+        };
+
+    // Runs on the render thread once the job has stopped
+    auto onDone = [hWnd, jobId](RenderJob&)
+        {
+            PostMessage(hWnd, WM_RENDER_DONE, 0, jobId);
+        };
+
+    // The options are read here on the window's thread, changing them later takes a new job
+    m_job = std::make_unique<RenderJob>(*m_fractal, m_fractal->GetRequest(), m_pixelBuffer, m_bProgressive, previewScale,
+        m_bDeadline ? m_frameBudgetMs : 0.0, onPass, onDone);
+}
+
+void App::CancelRender()
+{
+    // Destroying the job cancels it and waits for the render thread
+    m_job.reset();
+}
+
+void App::RequestRender(HWND hWnd)
+{
+    // Renders would throw off the timings of the autotune
+    if (m_autotuneThread.joinable())
+    {
+        m_renderQueue.Clear();
+        return;
+    }
+
+    // Full resolution follows once the input has been idle for a while
+    // Setting the timer again restarts the wait
+    SetTimer(hWnd, ID_TIMER_REFINE, m_idleRefineMs, NULL);
+
+    // Input always comes before the prefetching
+    m_prefetcher.Stop();
+
+    if (m_job && !m_job->IsDone())
+    {
+        // The stale job stops at its next tile, WM_RENDER_DONE then renders the queue
+        m_job->Cancel();
+    }
+    else
+    {
+        RenderQueued(hWnd);
+    }
+}
+
+void App::RenderQueued(HWND hWnd)
+{
+    // The job reads the view, it has to be stopped before the view changes
+    CancelRender();
+
+    // Time every render of the queue from the moment it starts
+    m_bTimer = true;
+    QueryPerformanceCounter(&m_liStartTime);
+
+    m_renderQueue.Apply(*m_fractal);
+
+    // The view may already be prefetched
+    if (m_bPrefetch && m_prefetcher.Take(m_fractal->GetViewport(), m_pixelBuffer))
+    {
+        ShowPrefetched(hWnd);
+        return;
+    }
+
+    // Navigation renders at the preview scale that keeps it interactive
+    // Deadline renders already keep every frame within the budget
+    RenderToWindow(hWnd, m_bDeadline ? 1 : PickPreviewScale());
+}
+
+void App::ShowPrefetched(HWND hWnd)
+{
+    m_previewScale = 1;
+    m_bFullFrame = false;
+    m_bPrefetched = true;
+
+    // Posted like the passes of a job so the window handles it the same way
+    LPARAM jobId = ++m_jobId;
+
+    {
+        std::lock_guard<std::mutex> lock(m_frontMutex);
+        memcpy(m_frontBuffer, m_pixelBuffer, sizeof(Colour) * m_widthW * m_heightW);
+    }
+
+    PostMessage(hWnd, WM_RENDER_PASS, 1, jobId);
+    PostMessage(hWnd, WM_RENDER_DONE, 0, jobId);
+}
+
+std::unique_ptr<Fractal> App::MakeFractal(UINT fractal)
+{
+    switch (fractal)
+    {
+    case ID_FRACTAL_BURNINGSHIP:
+    {
+        return std::make_unique<BurningShip>(shared_from_this());
+    }
+    case ID_FRACTAL_MULTIBROT:
+    {
+        return std::make_unique<Multibrot>(shared_from_this());
+    }
+    case ID_FRACTAL_NOVA:
+    {
+        return std::make_unique<Nova>(shared_from_this());
+    }
+    case ID_FRACTAL_PHEONIX:
+    {
+        return std::make_unique<Pheonix>(shared_from_this());
+    }
+    default:
+    {
+        return std::make_unique<Mandelbrot>(shared_from_this());
+    }
+    } // Switch
+}
+
+void App::PlacePixelBuffer()
+{
+    // The render thread and the prefetcher write to the buffer
+    CancelRender();
+    m_prefetcher.Stop();
+
+    // Fresh pages, the OS puts each one on the node of the thread that writes it first
+    _aligned_free(m_pixelBuffer);
+    m_pixelBuffer = (Colour*)_aligned_malloc(sizeof(Colour) * m_widthW * m_heightW, 32);
+    m_fractal->PlaceBuffer(m_pixelBuffer);
+
+    m_bBufferPlaced = true;
+}
+
+std::filesystem::path App::ProfilePath() const
+{
+    TCHAR exePath[MAX_PATH];
+    GetModuleFileName(NULL, exePath, MAX_PATH);
+
+    return std::filesystem::path(exePath).parent_path() / "tuning.profile";
+}
+
+void App::StartAutotune(HWND hWnd)
+{
+    // A save would throw off the timings
+    if (m_autotuneThread.joinable() || m_saveThread.joinable())
+    {
+        return;
+    }
+
+    // Nothing else may use the cores while the timings are taken
+    CancelRender();
+    m_prefetcher.Stop();
+    m_renderQueue.Clear();
+    KillTimer(hWnd, ID_TIMER_REFINE);
+
+    SetWindowText(hWnd, _T("Fractal Playground App - Autotuning..."));
+
+    m_autotuneCancel = false;
+    m_autotuneResult = m_tuningProfile;
+    m_autotuneThread = std::thread([this, hWnd]()
+        {
+            // Every fractal at its starting view
+            std::vector<std::unique_ptr<Fractal>> fractals;
+            std::vector<Fractal*> tuned;
+            for (UINT fractal : { ID_FRACTAL_MANDELBROT, ID_FRACTAL_BURNINGSHIP, ID_FRACTAL_MULTIBROT, ID_FRACTAL_NOVA, ID_FRACTAL_PHEONIX })
+            {
+                fractals.push_back(MakeFractal(fractal));
+                tuned.push_back(fractals.back().get());
+            }
+
+            Autotuner autotuner(static_cast<size_t>(m_widthW) * m_heightW);
+            bool finished = autotuner.Run(tuned, m_autotuneResult, &m_autotuneCancel);
+
+            PostMessage(hWnd, WM_AUTOTUNE_DONE, finished, 0);
+        });
+}
+
+void App::CancelAutotune()
+{
+    m_autotuneCancel = true;
+
+    if (m_autotuneThread.joinable())
+    {
+        m_autotuneThread.join();
+    }
+}
+
+void App::StartSave(HWND hWnd, const std::filesystem::path& path)
+{
+    SetWindowText(hWnd, _T("Fractal Playground App - Saving..."));
+
+    // The window goes on rendering and may switch fractals, the copy keeps the view of the click
+    m_saveCancel = false;
+    std::shared_ptr<Fractal> fractal = m_fractal->Clone();
+    RenderRequest request = m_fractal->GetRequest();
+    m_saveThread = std::thread([this, hWnd, path, fractal, request]()
+        {
+            // The current view at the size of the window, in full detail whatever the window
+            // is showing, in bands of at most 256 MB
+            PngSink sink(path);
+            Poster poster(*fractal, request, static_cast<size_t>(256) << 20);
+            bool saved = poster.Render(sink, nullptr, &m_saveCancel);
+
+            PostMessage(hWnd, WM_SAVE_DONE, saved, 0);
+        });
+}
+
+void App::CancelSave()
+{
+    m_saveCancel = true;
+
+    if (m_saveThread.joinable())
+    {
+        m_saveThread.join();
+    }
+}
+
+int App::PickPreviewScale() const
+{
+    // Every halving of the resolution cuts the work by four
+    int scale = 1;
+    while (scale < m_maxPreviewScale && m_fullFrameMs / (scale * scale) > m_previewBudgetMs)
+    {
+        scale *= 2;
+    }
+
+    return scale;
+}
+
 // Entry
 int WINAPI WinMain(
     _In_ HINSTANCE hInstance, 
@@ -13,27 +13,57 @@
 
 #include <Windows.h>
 #include <tchar.h>
+#include <algorithm>
 #include <cmath>
 #include <ShlObj.h>
 #include <stdlib.h>
 #include <memory>
+#include <mutex>
 #include <stdint.h>
 #include <filesystem>
 #include "Resource.h"
+#include "Gif.h"
 #include "Fractals/Fractal.h"
 #include "Fractals/Fractals.h"
 
-class App : public std::enable_shared_from_this<App>
+// The size of the window (m_widthW, m_heightW) is kept by the render host
+class App : public RenderHost, public std::enable_shared_from_this<App>
 {
 public:
-    int m_widthW = 900;
-    int m_heightW = 600;
-
     int m_widthB = 128;
     int m_heightB = 25;
 
     int m_gifDelay = 10;
 
+    // Navigation preview
+    // Time without input before a preview is rendered again at full resolution
+    int m_idleRefineMs = 250;
+    // Frame time that navigation aims for, the preview scale is picked to stay under it
+    double m_previewBudgetMs = 33.0;
+    // Largest preview scale, every 4th pixel
+    int m_maxPreviewScale = 4;
+
+    // Time each frame of a deadline render may take
+    double m_frameBudgetMs = 16.0;
+
+    // Prefetching of the next views while idle
+    // Memory for the prefetched images (each frame is about 2 MB) and the share of the cores used
+    size_t m_prefetchMemoryMB = 24;
+    double m_prefetchCpuShare = 0.5;
+
+    // Posted by the render thread when a pass is in the front buffer
+    // wParam is the step of the pass, lParam is the id of the job
+    static constexpr UINT WM_RENDER_PASS = WM_APP + 1;
+
+    // Posted by the render thread once a job has stopped, lParam is the id of the job
+    static constexpr UINT WM_RENDER_DONE = WM_APP + 2;
+
+    // Posted by the autotune thread once it has stopped, wParam is true if it finished
+    static constexpr UINT WM_AUTOTUNE_DONE = WM_APP + 3;
+
+    // Posted by the save thread once it has stopped, wParam is true if the image was written
+    static constexpr UINT WM_SAVE_DONE = WM_APP + 4;
+
 private:
     // Window variables
     HWND m_hWnd{};
@@ -60,6 +90,14 @@ private:
     bool m_bTimer{};
     bool m_bCanZoom{};
     bool m_bRecording{};
+    bool m_bProgressive{};
+    bool m_bDeadline{};
+    bool m_bPrefetch{};
+    bool m_bPinThreads{};
+    bool m_bPerturbation{};
+    // The pixel buffer was first written by the pinned render threads
+    bool m_bBufferPlaced{};
+    bool m_bPreview{};
 
     // WndProc variables
     PAINTSTRUCT m_ps{};
@@ -68,6 +106,40 @@ private:
     GifWriter m_gif = { NULL, NULL, NULL };
     std::unique_ptr<Fractal> m_fractal;
 
+    // Render thread variables
+    // The job renders into m_pixelBuffer, finished passes are copied to m_frontBuffer for painting
+    Colour* m_frontBuffer = (Colour*)_aligned_malloc(sizeof(Colour) * m_widthW * m_heightW, 32);
+    std::mutex m_frontMutex;
+    // Cost map partitioning of the pass in m_frontBuffer, under the same lock
+    CostMapReport m_costMapReport{};
+    std::unique_ptr<RenderJob> m_job;
+    LPARAM m_jobId{};
+
+    // Zooms and moves waiting for the current job to stop
+    RenderQueue m_renderQueue;
+
+    // Navigation preview variables
+    static constexpr UINT_PTR ID_TIMER_REFINE = 1;
+    int m_previewScale = 1;
+    double m_fullFrameMs{};
+
+    // Renders the likely next views once a full resolution frame is on the window
+    Prefetcher m_prefetcher{ m_widthW, m_heightW, m_prefetchMemoryMB << 20, m_prefetchCpuShare };
+    // The last pass was a full resolution frame
+    bool m_bFullFrame{};
+    // The frame on the window came from the prefetcher
+    bool m_bPrefetched{};
+
+    // Fastest settings on this machine, loaded at startup
+    TuningProfile m_tuningProfile;
+    // Autotune runs on its own thread into m_autotuneResult
+    std::thread m_autotuneThread;
+    std::atomic<bool> m_autotuneCancel{};
+    TuningProfile m_autotuneResult;
+    // Save Image renders and encodes on its own thread, from a copy of the fractal
+    std::thread m_saveThread;
+    std::atomic<bool> m_saveCancel{};
+
 public:
     App();
 
@@ -77,9 +149,12 @@ public:
     int Run(HINSTANCE hInstance, int nCmdShow);
 
     // Get methods
-    UINT GetLanguage();
+    UINT GetLanguage() override;
     UINT GetFractal();
-    UINT GetGradient();
+    UINT GetGradient() override;
+    const TuningProfile& GetTuningProfile() const override;
+    bool GetPinThreads() const override;
+    bool GetPerturbation() const override;
 
 private:
     // Static WndProc callback
@@ -87,4 +162,51 @@ private:
 
     // Non-static callback
     LRESULT WndProc(HWND, UINT, WPARAM, LPARAM);
+
+    // Transferring the pixelBuffer bitmap to the main screen and writing to the gif
+    void Draw(
+        HDC hdc,
+        Colour* pixelBuffer,
+        GifWriter* gif,
+        bool recording);
+
+    // Start rendering the current fractal on a render job, the window repaints as passes finish
+    // A preview scale above 1 renders a decimated grid and upscales it
+    void RenderToWindow(HWND hWnd, int previewScale = 1);
+
+    // Preview scale that keeps the last measured frame time under the budget
+    int PickPreviewScale() const;
+
+    // Cancel the current render job and wait for it to stop (at most one tile)
+    void CancelRender();
+
+    // Render the queued zooms and moves, right away if idle, otherwise once the current job stops
+    void RequestRender(HWND hWnd);
+
+    // Apply everything in the render queue to the fractal and render the result
+    void RenderQueued(HWND hWnd);
+
+    // Show the prefetched image in m_pixelBuffer as if a render had finished it
+    void ShowPrefetched(HWND hWnd);
+
+    // New fractal of the given ID_FRACTAL_* at its starting view
+    std::unique_ptr<Fractal> MakeFractal(UINT fractal);
+
+    // Allocate a new pixel buffer and let the pinned render threads write it first
+    void PlacePixelBuffer();
+
+    // Tuning profile next to the executable
+    std::filesystem::path ProfilePath() const;
+
+    // Tune every fractal on the autotune thread, the window is told once it is done
+    void StartAutotune(HWND hWnd);
+
+    // Stop the autotune thread (within one render) and wait for it
+    void CancelAutotune();
+
+    // Render the current view into a PNG on the save thread, the window is told once it is done
+    void StartSave(HWND hWnd, const std::filesystem::path& path);
+
+    // Stop the save thread (within one tile) and wait for it
+    void CancelSave();
 };
@@ -0,0 +1,232 @@
+/*********************************************************************************************
+**
+**	File Name:		autotuner.cpp
+**	Description:	This is the file that contains the function definitions for the autotuner
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <cmath>
+#include "Autotuner.h"
+
+Autotuner::Autotuner(size_t pixels) : m_pixels(pixels)
+{
+}
+
+double Autotuner::TimeRender(Fractal& fractal, const RenderSettings& settings, Colour* pixelBuffer, const std::atomic<bool>* cancel) const
+{
+    using Clock = std::chrono::steady_clock;
+
+    fractal.ForceSettings(settings);
+    const RenderRequest request = fractal.GetRequest();
+
+    double best = -1;
+    for (int i = 0; i < m_repeats; ++i)
+    {
+        Clock::time_point start = Clock::now();
+        if (!fractal.Render(request, pixelBuffer, cancel, 1))
+        {
+            return -1;
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        best = best < 0 || ms < best ? ms : best;
+    }
+
+    return best;
+}
+
+double Autotuner::Difference(const std::vector<TileStats>& a, const std::vector<TileStats>& b)
+{
+    if (a.size() != b.size())
+    {
+        return 1.0;
+    }
+
+    double differing = 0, total = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        differing += fabs(static_cast<double>(a[i].iterations - b[i].iterations));
+        total += static_cast<double>(a[i].iterations);
+    }
+
+    return total > 0 ? differing / total : 0.0;
+}
+
+std::optional<TuningProfile::Entry> Autotuner::Tune(Fractal& fractal, bool useFloat, const std::atomic<bool>* cancel) const
+{
+    const int cores = std::thread::hardware_concurrency() > 0 ? static_cast<int>(std::thread::hardware_concurrency()) : 1;
+
+    std::vector<Colour> pixels(m_pixels);
+
+    // Always leave the fractal rendering the way it was
+    struct Restore
+    {
+        Fractal& fractal;
+        ~Restore()
+        {
+            fractal.ForceSettings(std::nullopt);
+            fractal.ForceDouble(false);
+        }
+    } restore{ fractal };
+
+    fractal.ForceDouble(!useFloat);
+
+    // Backend on every core, C++ is also the frame the other backends have to match
+    RenderSettings best = { ID_LANGUAGE_CPP_MT, cores, 64, 64, false, 1, false, false, false };
+    double bestMs = TimeRender(fractal, best, pixels.data(), cancel);
+    if (bestMs < 0)
+    {
+        return std::nullopt;
+    }
+
+    const std::vector<TileStats> reference = fractal.GetFrameStats();
+    std::vector<TileStats> bestStats = reference;
+
+    for (UINT language : { ID_LANGUAGE_SSE_MT, ID_LANGUAGE_AVX_MT })
+    {
+        // They would render with C++ again
+        if (!fractal.HasSIMDKernels() || !Fractal::HasAVX2())
+        {
+            break;
+        }
+
+        RenderSettings settings = { language, cores, 64, 64, false, 1, false, false, false };
+        double ms = TimeRender(fractal, settings, pixels.data(), cancel);
+        if (ms < 0)
+        {
+            return std::nullopt;
+        }
+
+        // A fast backend that draws the wrong image is no use
+        if (Difference(reference, fractal.GetFrameStats()) > m_maxDifference)
+        {
+            continue;
+        }
+
+        if (ms < bestMs)
+        {
+            best = settings;
+            bestMs = ms;
+            bestStats = fractal.GetFrameStats();
+        }
+    }
+
+    // Fused multiply-adds round once where the kernels rounded twice, so a few counts move
+    // They are only kept if they stay as close to the kernels without them as the backends are to C++
+    if (best.language != ID_LANGUAGE_CPP_MT && Fractal::HasFMA())
+    {
+        RenderSettings settings = best;
+        settings.fma = true;
+
+        double ms = TimeRender(fractal, settings, pixels.data(), cancel);
+        if (ms < 0)
+        {
+            return std::nullopt;
+        }
+
+        if (Difference(bestStats, fractal.GetFrameStats()) <= m_maxDifference && ms < bestMs)
+        {
+            best = settings;
+            bestMs = ms;
+        }
+    }
+
+    // Vectors the AVX kernels iterate side by side
+    // The counts are the same whatever the interleave, only the speed changes
+    if (best.language == ID_LANGUAGE_AVX_MT)
+    {
+        for (int interleave = 2; interleave <= m_maxInterleave; ++interleave)
+        {
+            RenderSettings settings = best;
+            settings.interleave = interleave;
+
+            double ms = TimeRender(fractal, settings, pixels.data(), cancel);
+            if (ms < 0)
+            {
+                return std::nullopt;
+            }
+
+            if (ms < bestMs)
+            {
+                best = settings;
+                bestMs = ms;
+            }
+        }
+    }
+
+    // Threads, powers of two up to the number of cores
+    for (int threads = 1; threads < cores * 2; threads *= 2)
+    {
+        RenderSettings settings = best;
+        settings.threads = threads < cores ? threads : cores;
+        if (settings.threads == best.threads)
+        {
+            continue;
+        }
+
+        double ms = TimeRender(fractal, settings, pixels.data(), cancel);
+        if (ms < 0)
+        {
+            return std::nullopt;
+        }
+
+        if (ms < bestMs)
+        {
+            best = settings;
+            bestMs = ms;
+        }
+    }
+
+    // Tile shapes with the best threads
+    for (const auto& shape : m_tileShapes)
+    {
+        RenderSettings settings = best;
+        settings.tileWidth = shape[0];
+        settings.tileHeight = shape[1];
+        if (settings.tileWidth == best.tileWidth && settings.tileHeight == best.tileHeight)
+        {
+            continue;
+        }
+
+        double ms = TimeRender(fractal, settings, pixels.data(), cancel);
+        if (ms < 0)
+        {
+            return std::nullopt;
+        }
+
+        if (ms < bestMs)
+        {
+            best = settings;
+            bestMs = ms;
+        }
+    }
+
+    return TuningProfile::Entry{ fractal.GetName(), useFloat, best, bestMs };
+}
+
+bool Autotuner::Run(const std::vector<Fractal*>& fractals, TuningProfile& profile, const std::atomic<bool>* cancel, const EntryCallback& onEntry) const
+{
+    for (Fractal* fractal : fractals)
+    {
+        for (bool useFloat : { true, false })
+        {
+            std::optional<TuningProfile::Entry> entry = Tune(*fractal, useFloat, cancel);
+            if (!entry)
+            {
+                return false;
+            }
+
+            profile.Set(*entry);
+
+            if (onEntry)
+            {
+                onEntry(*entry);
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,67 @@
+/*********************************************************************************************
+**
+**	File Name:		autotuner.h
+**	Description:	This is the header file that contains the class definition for the
+**                  autotuner, which times the backends, thread counts and tile shapes on this
+**                  machine and keeps the fastest of each fractal and precision
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include "TuningProfile.h"
+
+class Autotuner
+{
+public:
+    // Called after each fractal and precision has been tuned
+    using EntryCallback = std::function<void(const TuningProfile::Entry&)>;
+
+private:
+    // Renders of each setting, the fastest one counts
+    const int m_repeats = 2;
+
+    // Share of the iterations a backend may differ from C++ by before it is treated as broken
+    // The SIMD backends sample the same points as C++, a few pixels may still round differently
+    // (the colours are not compared, the SIMD backends colour by a count that goes down)
+    const double m_maxDifference = 0.01;
+
+    // Most vectors the AVX kernels are tried with side by side
+    const int m_maxInterleave = 4;
+
+    // Tile shapes tried, multiples of twice the progressive step
+    const int m_tileShapes[6][2] = { { 32, 32 }, { 64, 64 }, { 128, 128 }, { 128, 32 }, { 32, 128 }, { 256, 16 } };
+
+    size_t m_pixels;
+
+    // Fastest of m_repeats renders in ms, below 0 if cancelled
+    double TimeRender(
+        Fractal& fractal,
+        const RenderSettings& settings,
+        Colour* pixelBuffer,
+        const std::atomic<bool>* cancel) const;
+
+    // Share of the iterations that are on different tiles between two frames
+    static double Difference(const std::vector<TileStats>& a, const std::vector<TileStats>& b);
+
+public:
+    explicit Autotuner(size_t pixels);
+
+    // Find the fastest settings of a fractal at its current view in one precision
+    // The backend is picked first, then FMA and the AVX interleave, then the threads, then the tile shape
+    // Nothing is returned if it was cancelled
+    std::optional<TuningProfile::Entry> Tune(
+        Fractal& fractal,
+        bool useFloat,
+        const std::atomic<bool>* cancel) const;
+
+    // Tune every fractal in float and double into the profile, returns false if cancelled
+    bool Run(
+        const std::vector<Fractal*>& fractals,
+        TuningProfile& profile,
+        const std::atomic<bool>* cancel,
+        const EntryCallback& onEntry = nullptr) const;
+};
@@ -0,0 +1,274 @@
+/*********************************************************************************************
+**
+**	File Name:		batch.cpp
+**	Description:	This is the file that contains the function definitions for the batch
+**                  renderer
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <thread>
+#include "Batch.h"
+#include "IterationArchive.h"
+
+Batch::Batch(FractalFactory makeFractal, int threads, size_t memoryBudget)
+    : m_makeFractal(std::move(makeFractal)),
+    m_threads(threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))),
+    m_memoryBudget(memoryBudget)
+{
+}
+
+size_t Batch::CountBytes(const Scene& scene)
+{
+    return static_cast<size_t>(scene.width) * scene.height * sizeof(uint16_t);
+}
+
+std::unique_ptr<Batch::Job> Batch::StartJob(size_t scene)
+{
+    const Scene& description = (*m_scenes)[scene];
+
+    std::unique_ptr<Fractal>& fractal = m_fractals[description.fractal];
+    if (!fractal)
+    {
+        fractal = m_makeFractal(description.fractal);
+        if (!fractal)
+        {
+            return nullptr;
+        }
+    }
+
+    auto job = std::make_unique<Job>();
+    job->scene = scene;
+    job->fractal = fractal.get();
+
+    // The backend of the host, everything else of the scene
+    RenderRequest& request = job->request;
+    request = fractal->GetRequest();
+    if (description.view)
+    {
+        request.view = *description.view;
+    }
+    else
+    {
+        request.view.aspect = static_cast<double>(description.height) / description.width;
+    }
+
+    request.width = description.width;
+    request.height = description.height;
+    request.left = 0;
+    request.top = 0;
+    request.stride = description.width * sizeof(uint16_t);
+    request.format = PixelFormat::Iterations;
+    request.maxIterations = description.maxIterations > 0 ? description.maxIterations : request.maxIterations;
+    request.gradient = description.gradient;
+
+    // Each tile is rendered by the pool thread that takes it
+    request.settings = fractal->ResolveSettings(request.settings);
+    request.settings.threads = 1;
+    request.settings.pinThreads = false;
+
+    const int tileWidth = request.settings.tileWidth, tileHeight = request.settings.tileHeight;
+    for (int y = 0; y < request.height; y += tileHeight)
+    {
+        for (int x = 0; x < request.width; x += tileWidth)
+        {
+            job->tiles.push_back({ x, y, std::min(x + tileWidth, request.width), std::min(y + tileHeight, request.height) });
+        }
+    }
+
+    job->reference = fractal->RequestReference(request);
+    job->counts.resize(static_cast<size_t>(request.width) * request.height);
+    return job;
+}
+
+bool Batch::WriteJob(const Job& job, const Scene& scene)
+{
+    const RenderRequest& request = job.request;
+
+    // Missing folders of the output are made
+    std::error_code ignored;
+    if (scene.output.has_parent_path())
+    {
+        std::filesystem::create_directories(scene.output.parent_path(), ignored);
+    }
+
+    // Only this thread compresses, the rest of the pool is rendering
+    std::string extension = scene.output.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+
+    std::unique_ptr<PosterSink> sink;
+    if (extension == ".iters")
+    {
+        sink = std::make_unique<ArchiveSink>(scene.output, *job.fractal, request);
+    }
+    else if (extension == ".png")
+    {
+        sink = std::make_unique<PngSink>(scene.output, 1);
+    }
+    else
+    {
+        sink = std::make_unique<PpmSink>(scene.output);
+    }
+
+    const PixelFormat format = sink->GetFormat();
+    const int width = request.width, height = request.height;
+
+    size_t stride;
+    uint8_t* pixels = sink->Open(width, height) ? sink->BeginBand(0, height, stride) : nullptr;
+    if (!pixels)
+    {
+        sink->Close();
+        return false;
+    }
+
+    if (format == PixelFormat::Iterations)
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy(pixels + y * stride, job.counts.data() + static_cast<size_t>(y) * width, width * sizeof(uint16_t));
+        }
+    }
+    else
+    {
+        // Every count has one of 256 colours, the index the backend's kernels would colour it with
+        const int pixelBytes = Fractal::PixelBytes(format);
+        const int sign = Fractal::GradientIndex(request.settings.language, 1) == 1 ? 1 : -1;
+        std::vector<uint8_t> colours(256 * pixelBytes);
+        for (int i = 0; i < 256; ++i)
+        {
+            Fractal::ColourPixel(colours.data() + i * pixelBytes, format, static_cast<uint8_t>(i), request.gradient);
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            const uint16_t* counts = job.counts.data() + static_cast<size_t>(y) * width;
+            uint8_t* pixel = pixels + y * stride;
+            for (int x = 0; x < width; ++x, pixel += pixelBytes)
+            {
+                memcpy(pixel, colours.data() + static_cast<uint8_t>(sign * counts[x]) * pixelBytes, pixelBytes);
+            }
+        }
+    }
+
+    const bool written = sink->EndBand();
+    return sink->Close() && written;
+}
+
+void Batch::Work()
+{
+    std::unique_lock<std::mutex> hold(m_lock);
+
+    for (;;)
+    {
+        // The oldest scene with tiles left to hand out
+        Job* job = nullptr;
+        for (const std::unique_ptr<Job>& started : m_jobs)
+        {
+            if (started->nextTile < started->tiles.size())
+            {
+                job = started.get();
+                break;
+            }
+        }
+
+        if (!job)
+        {
+            // Every tile is taken, the threads that have them finish the scenes
+            if (m_nextScene == m_scenes->size() || (m_cancel && m_cancel->load()))
+            {
+                return;
+            }
+
+            // The next scene once its counts fit beside those in flight
+            const size_t bytes = CountBytes((*m_scenes)[m_nextScene]);
+            if (m_bytes && m_bytes + bytes > m_memoryBudget)
+            {
+                m_changed.wait(hold);
+                continue;
+            }
+
+            const size_t scene = m_nextScene++;
+            std::unique_ptr<Job> started = StartJob(scene);
+            if (!started)
+            {
+                if (m_onScene)
+                {
+                    m_onScene(scene, false);
+                }
+                continue;
+            }
+
+            m_bytes += bytes;
+            m_jobs.push_back(std::move(started));
+            continue;
+        }
+
+        const Tile tile = job->tiles[job->nextTile++];
+        hold.unlock();
+
+        // The tile is a region of the scene, its pixels are the ones a single render would have
+        RenderRequest region = job->request;
+        region.region = tile;
+        uint8_t* origin = reinterpret_cast<uint8_t*>(job->counts.data()) + tile.yStart * region.stride + tile.xStart * sizeof(uint16_t);
+        const bool rendered = job->fractal->Render(region, job->reference, origin, m_cancel);
+
+        hold.lock();
+        job->failed = job->failed || !rendered;
+        if (++job->finishedTiles < job->tiles.size())
+        {
+            continue;
+        }
+
+        // The last tile, this thread writes the scene while the others go on with the next
+        auto found = std::find_if(m_jobs.begin(), m_jobs.end(), [job](const std::unique_ptr<Job>& started) { return started.get() == job; });
+        std::unique_ptr<Job> finished = std::move(*found);
+        m_jobs.erase(found);
+        hold.unlock();
+
+        const Scene& scene = (*m_scenes)[finished->scene];
+        const bool written = !finished->failed && WriteJob(*finished, scene);
+        const size_t bytes = CountBytes(scene);
+        const size_t index = finished->scene;
+        finished.reset();
+
+        hold.lock();
+        m_bytes -= bytes;
+        m_written += written ? 1 : 0;
+        if (m_onScene)
+        {
+            m_onScene(index, written);
+        }
+        m_changed.notify_all();
+    }
+}
+
+size_t Batch::Run(const std::vector<Scene>& scenes, const SceneCallback& onScene, const std::atomic<bool>* cancel)
+{
+    m_scenes = &scenes;
+    m_onScene = onScene;
+    m_cancel = cancel;
+    m_nextScene = 0;
+    m_written = 0;
+    m_bytes = 0;
+
+    // One pool for every scene, no thread waits for a scene to end before starting on the next
+    std::vector<std::thread> threads;
+    for (int i = 0; i < m_threads; ++i)
+    {
+        threads.emplace_back(&Batch::Work, this);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    m_scenes = nullptr;
+    m_onScene = nullptr;
+    return m_written;
+}
@@ -0,0 +1,94 @@
+/*********************************************************************************************
+**
+**	File Name:		batch.h
+**	Description:	This is the header file that contains the class definition for the batch
+**                  renderer, which renders a list of scenes on one pool of threads
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "Scene.h"
+
+// The threads take the tiles of the oldest scene that has any left and start the next scene
+// once none has, the thread that finishes the last tile of a scene colours and writes it
+// So the last tiles of one scene, its colouring and its encoding overlap the next scene's
+// compute, and small scenes keep every core busy across the boundaries between them
+class Batch
+{
+public:
+    // New fractal of a name, nullptr if there is none
+    // Each name is made once and shared by its scenes, the renders only read it
+    using FractalFactory = std::function<std::unique_ptr<Fractal>(const std::string&)>;
+
+    // Called once a scene is written or has failed, on the pool threads one at a time
+    using SceneCallback = std::function<void(size_t, bool)>;
+
+private:
+    // Scene being rendered, its counts are held until it is written
+    struct Job
+    {
+        size_t scene;
+        const Fractal* fractal;
+        // Counts of the whole image, each tile renders a region of it on one thread
+        RenderRequest request;
+        // Picked once for the scene, every tile renders against it
+        ReferenceOrbit reference;
+        std::vector<uint16_t> counts;
+        std::vector<Tile> tiles;
+        size_t nextTile;
+        size_t finishedTiles;
+        bool failed;
+    };
+
+    FractalFactory m_makeFractal;
+    int m_threads;
+    size_t m_memoryBudget;
+
+    std::map<std::string, std::unique_ptr<Fractal>> m_fractals;
+
+    // State of a run, under the lock
+    std::mutex m_lock;
+    std::condition_variable m_changed;
+    const std::vector<Scene>* m_scenes{};
+    SceneCallback m_onScene;
+    const std::atomic<bool>* m_cancel{};
+    size_t m_nextScene{};
+    size_t m_written{};
+    // Scenes that are started and not yet written, oldest first, and the bytes of their counts
+    std::deque<std::unique_ptr<Job>> m_jobs;
+    size_t m_bytes{};
+
+    static size_t CountBytes(const Scene& scene);
+
+    // Request and tiles of a scene, nullptr if its fractal can not be made
+    std::unique_ptr<Job> StartJob(size_t scene);
+
+    // Colour the counts of a finished scene and write its file
+    static bool WriteJob(const Job& job, const Scene& scene);
+
+    // Body of each thread of the pool
+    void Work();
+
+public:
+    // threads is 0 for one per processor, the memory budget bounds the counts of the scenes
+    // in flight (at least one is always started)
+    Batch(FractalFactory makeFractal, int threads = 0, size_t memoryBudget = static_cast<size_t>(256) << 20);
+
+    // Render every scene, setting cancel stops at the next tile
+    // Returns the number of scenes written
+    size_t Run(
+        const std::vector<Scene>& scenes,
+        const SceneCallback& onScene = nullptr,
+        const std::atomic<bool>* cancel = nullptr);
+};
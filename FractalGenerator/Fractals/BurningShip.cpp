@@ -9,16 +9,16 @@
 **
 **********************************************************************************************/
 
-#include "burningship.h"
+#include "BurningShip.h"
 
-int BurningShip::GetCPPIterF(float xval, float yval) const
+int BurningShip::GetCPPIterF(float xval, float yval, int maxIterations) const
 {
     float x = 0.0, y = 0.0;
     float r = 0.0;
     int n = 0;
 
     // TODO: ADD A DESCIPTION OF WHAT THE BURNING SHIP EQUATION IS
-    while (r < m_rMax && n < m_maxIterations) {
+    while (r < m_rMax && n < maxIterations) {
         float abs_x = x >= 0 ? x : -x;
         float abs_y = y >= 0 ? y : -y;
 
@@ -34,14 +34,14 @@ int BurningShip::GetCPPIterF(float xval, float yval) const
     return n;
 }
 
-int BurningShip::GetCPPIterD(double xval, double yval) const
+int BurningShip::GetCPPIterD(double xval, double yval, int maxIterations) const
 {
     double x = 0.0, y = 0.0;
     double r = 0.0;
     int n = 0;
 
     // TODO: ADD A DESCIPTION OF WHAT THE BURNING SHIP EQUATION IS
-    while (r < m_rMax && n < m_maxIterations) {
+    while (r < m_rMax && n < maxIterations) {
         double abs_x = x >= 0 ? x : -x;
         double abs_y = y >= 0 ? y : -y;
 
@@ -59,7 +59,8 @@ int BurningShip::GetCPPIterD(double xval, double yval) const
     return n;
 }
 
-__m128i BurningShip::GetSSEIterF(__m128 xval, __m128 yval) const
+template<bool Fma>
+__m128i BurningShip::SSEIterF(__m128 xval, __m128 yval, int maxIterations) const
 {
     const __m128 rMax = _mm_set1_ps(m_rMax);
     const __m128 r0 = _mm_setzero_ps();
@@ -71,7 +72,7 @@ __m128i BurningShip::GetSSEIterF(__m128 xval, __m128 yval) const
     __m128 abs_y = _mm_setzero_ps();
     __m128 r = _mm_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m128 cmp = _mm_cmp_ps(rMax, r, _CMP_GT_OQ); // if greater than the max r val, break
         if (!_mm_movemask_ps(cmp)) break;
@@ -80,12 +81,10 @@ __m128i BurningShip::GetSSEIterF(__m128 xval, __m128 yval) const
         abs_x = _mm_andnot_ps(_mm_set1_ps(-0.0f), x); // Clearing the sign bit at the end
         abs_y = _mm_andnot_ps(_mm_set1_ps(-0.0f), y);
 
-        __m128 xy = _mm_mul_ps(abs_x, abs_y);
-        __m128 x2 = _mm_mul_ps(abs_x, abs_x);
         __m128 y2 = _mm_mul_ps(abs_y, abs_y);
-        x = _mm_add_ps(_mm_sub_ps(x2, y2), xval); // Z real (zr*zr+zi*zi+cr)
-        y = _mm_add_ps(_mm_add_ps(xy, xy), yval); // Z imag (zr*zi*2+ci)
-        r = _mm_add_ps(x2, y2); // new R value (magnitude of Z) --> R <= m_rMax, zr^2+zi^2 <= m_rMax
+        x = _mm_add_ps(MulSub<Fma>(abs_x, abs_x, y2), xval); // Z real (zr*zr+zi*zi+cr)
+        y = MulAdd<Fma>(_mm_add_ps(abs_x, abs_x), abs_y, yval); // Z imag (zr*zi*2+ci)
+        r = MulAdd<Fma>(abs_x, abs_x, y2); // new R value (magnitude of Z) --> R <= m_rMax, zr^2+zi^2 <= m_rMax
 
         __m128i bn = _mm_castps_si128(cmp); // casting float cmp to an integer
         n = _mm_add_epi16(n, bn); // If cmp was previously true before hand, it will add 1 to N
@@ -94,7 +93,13 @@ __m128i BurningShip::GetSSEIterF(__m128 xval, __m128 yval) const
     return n;
 }
 
-__m128i BurningShip::GetSSEIterD(__m128d xval, __m128d yval) const {
+__m128i BurningShip::GetSSEIterF(__m128 xval, __m128 yval, int maxIterations, bool fma) const
+{
+    return fma ? SSEIterF<true>(xval, yval, maxIterations) : SSEIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m128i BurningShip::SSEIterD(__m128d xval, __m128d yval, int maxIterations) const {
     const __m128d rMax = _mm_set1_pd(m_rMax);
     __m128i n = _mm_setzero_si128();
     __m128d x = _mm_setzero_pd();
@@ -103,19 +108,17 @@ __m128i BurningShip::GetSSEIterD(__m128d xval, __m128d yval) const {
     __m128d abs_y = _mm_setzero_pd();
     __m128d r = _mm_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i) {
+    for (int i = 0; i < maxIterations; ++i) {
         __m128d cmp = _mm_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm_movemask_pd(cmp)) break;
 
         abs_x = _mm_andnot_pd(_mm_set1_pd(-0.0f), x);
         abs_y = _mm_andnot_pd(_mm_set1_pd(-0.0f), y);
 
-        __m128d xy = _mm_mul_pd(abs_x, abs_y);
-        __m128d x2 = _mm_mul_pd(abs_x, abs_x);
         __m128d y2 = _mm_mul_pd(abs_y, abs_y);
-        x = _mm_add_pd(_mm_sub_pd(x2, y2), xval);
-        y = _mm_add_pd(_mm_add_pd(xy, xy), yval);
-        r = _mm_add_pd(x2, y2);
+        x = _mm_add_pd(MulSub<Fma>(abs_x, abs_x, y2), xval);
+        y = MulAdd<Fma>(_mm_add_pd(abs_x, abs_x), abs_y, yval);
+        r = MulAdd<Fma>(abs_x, abs_x, y2);
 
         __m128i bn = _mm_castpd_si128(cmp);
         n = _mm_add_epi16(n, bn);
@@ -124,7 +127,12 @@ __m128i BurningShip::GetSSEIterD(__m128d xval, __m128d yval) const {
     return n;
 }
 
-__m256i BurningShip::GetAVXIterF(__m256 xval, __m256 yval) const {
+__m128i BurningShip::GetSSEIterD(__m128d xval, __m128d yval, int maxIterations, bool fma) const {
+    return fma ? SSEIterD<true>(xval, yval, maxIterations) : SSEIterD<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i BurningShip::AVXIterF(__m256 xval, __m256 yval, int maxIterations) const {
     const __m256 rMax = _mm256_set1_ps(m_rMax);
     __m256i n = _mm256_setzero_si256();
     __m256 x = _mm256_setzero_ps();
@@ -133,19 +141,17 @@ __m256i BurningShip::GetAVXIterF(__m256 xval, __m256 yval) const {
     __m256 abs_y = _mm256_setzero_ps();
     __m256 r = _mm256_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i) {
+    for (int i = 0; i < maxIterations; ++i) {
         __m256 cmp = _mm256_cmp_ps(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_ps(cmp)) break;
 
         abs_x = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
         abs_y = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), y);
 
-        __m256 xy = _mm256_mul_ps(abs_x, abs_y);
-        __m256 x2 = _mm256_mul_ps(abs_x, abs_x);
         __m256 y2 = _mm256_mul_ps(abs_y, abs_y);
-        x = _mm256_add_ps(_mm256_sub_ps(x2, y2), xval);
-        y = _mm256_add_ps(_mm256_add_ps(xy, xy), yval);
-        r = _mm256_add_ps(x2, y2);
+        x = _mm256_add_ps(MulSub<Fma>(abs_x, abs_x, y2), xval);
+        y = MulAdd<Fma>(_mm256_add_ps(abs_x, abs_x), abs_y, yval);
+        r = MulAdd<Fma>(abs_x, abs_x, y2);
 
         __m256i bn = _mm256_castps_si256(cmp);
         n = _mm256_add_epi16(n, bn);
@@ -154,7 +160,12 @@ __m256i BurningShip::GetAVXIterF(__m256 xval, __m256 yval) const {
     return n;
 }
 
-__m256i BurningShip::GetAVXIterD(__m256d xval, __m256d yval) const {
+__m256i BurningShip::GetAVXIterF(__m256 xval, __m256 yval, int maxIterations, bool fma) const {
+    return fma ? AVXIterF<true>(xval, yval, maxIterations) : AVXIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i BurningShip::AVXIterD(__m256d xval, __m256d yval, int maxIterations) const {
     const __m256d rMax = _mm256_set1_pd(m_rMax);
     __m256i n = _mm256_setzero_si256();
     __m256d x = _mm256_setzero_pd();
@@ -163,23 +174,153 @@ __m256i BurningShip::GetAVXIterD(__m256d xval, __m256d yval) const {
     __m256d abs_y = _mm256_setzero_pd();
     __m256d r = _mm256_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i) {
+    for (int i = 0; i < maxIterations; ++i) {
         __m256d cmp = _mm256_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_pd(cmp)) break;
 
         abs_x = _mm256_andnot_pd(_mm256_set1_pd(-0.0f), x);
         abs_y = _mm256_andnot_pd(_mm256_set1_pd(-0.0f), y);
 
-        __m256d xy = _mm256_mul_pd(abs_x, abs_y);
-        __m256d x2 = _mm256_mul_pd(abs_x, abs_x);
         __m256d y2 = _mm256_mul_pd(abs_y, abs_y);
-        x = _mm256_add_pd(_mm256_sub_pd(x2, y2), xval);
-        y = _mm256_add_pd(_mm256_add_pd(xy, xy), yval);
-        r = _mm256_add_pd(x2, y2);
+        x = _mm256_add_pd(MulSub<Fma>(abs_x, abs_x, y2), xval);
+        y = MulAdd<Fma>(_mm256_add_pd(abs_x, abs_x), abs_y, yval);
+        r = MulAdd<Fma>(abs_x, abs_x, y2);
 
         __m256i bn = _mm256_castpd_si256(cmp);
         n = _mm256_add_epi16(n, bn);
     }
 
     return n;
-}
\ No newline at end of file
+}
+
+__m256i BurningShip::GetAVXIterD(__m256d xval, __m256d yval, int maxIterations, bool fma) const {
+    return fma ? AVXIterD<true>(xval, yval, maxIterations) : AVXIterD<false>(xval, yval, maxIterations);
+}
+
+template<int N, bool Fma>
+void BurningShip::InterleaveAVXF(const __m256* xval, __m256 yval, __m256i* n, int maxIterations) const {
+    const __m256 rMax = _mm256_set1_ps(m_rMax);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 x[N], y[N], r[N];
+
+    for (int k = 0; k < N; ++k) {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_ps();
+        y[k] = _mm256_setzero_ps();
+        r[k] = _mm256_setzero_ps();
+    }
+
+    for (int i = 0; i < maxIterations; ++i) {
+        __m256 cmp[N];
+        __m256 active = _mm256_setzero_ps();
+
+        for (int k = 0; k < N; ++k) {
+            cmp[k] = _mm256_cmp_ps(rMax, r[k], _CMP_GT_OQ);
+            active = _mm256_or_ps(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_ps(active)) break;
+
+        for (int k = 0; k < N; ++k) {
+            __m256 abs_x = _mm256_andnot_ps(sign, x[k]);
+            __m256 abs_y = _mm256_andnot_ps(sign, y[k]);
+
+            __m256 y2 = _mm256_mul_ps(abs_y, abs_y);
+            x[k] = _mm256_add_ps(MulSub<Fma>(abs_x, abs_x, y2), xval[k]);
+            y[k] = MulAdd<Fma>(_mm256_add_ps(abs_x, abs_x), abs_y, yval);
+            r[k] = MulAdd<Fma>(abs_x, abs_x, y2);
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castps_si256(cmp[k]));
+        }
+    }
+}
+
+void BurningShip::GetAVXIterFN(const __m256* xval, __m256 yval, __m256i* n, int interleave, int maxIterations, bool fma) const {
+    switch (interleave) {
+    case 2:
+    {
+        fma ? InterleaveAVXF<2, true>(xval, yval, n, maxIterations) : InterleaveAVXF<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXF<3, true>(xval, yval, n, maxIterations) : InterleaveAVXF<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXF<4, true>(xval, yval, n, maxIterations) : InterleaveAVXF<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterFN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
+
+template<int N, bool Fma>
+void BurningShip::InterleaveAVXD(const __m256d* xval, __m256d yval, __m256i* n, int maxIterations) const {
+    const __m256d rMax = _mm256_set1_pd(m_rMax);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d x[N], y[N], r[N];
+
+    for (int k = 0; k < N; ++k) {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_pd();
+        y[k] = _mm256_setzero_pd();
+        r[k] = _mm256_setzero_pd();
+    }
+
+    for (int i = 0; i < maxIterations; ++i) {
+        __m256d cmp[N];
+        __m256d active = _mm256_setzero_pd();
+
+        for (int k = 0; k < N; ++k) {
+            cmp[k] = _mm256_cmp_pd(rMax, r[k], _CMP_GT_OQ);
+            active = _mm256_or_pd(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_pd(active)) break;
+
+        for (int k = 0; k < N; ++k) {
+            __m256d abs_x = _mm256_andnot_pd(sign, x[k]);
+            __m256d abs_y = _mm256_andnot_pd(sign, y[k]);
+
+            __m256d y2 = _mm256_mul_pd(abs_y, abs_y);
+            x[k] = _mm256_add_pd(MulSub<Fma>(abs_x, abs_x, y2), xval[k]);
+            y[k] = MulAdd<Fma>(_mm256_add_pd(abs_x, abs_x), abs_y, yval);
+            r[k] = MulAdd<Fma>(abs_x, abs_x, y2);
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castpd_si256(cmp[k]));
+        }
+    }
+}
+
+void BurningShip::GetAVXIterDN(const __m256d* xval, __m256d yval, __m256i* n, int interleave, int maxIterations, bool fma) const {
+    switch (interleave) {
+    case 2:
+    {
+        fma ? InterleaveAVXD<2, true>(xval, yval, n, maxIterations) : InterleaveAVXD<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXD<3, true>(xval, yval, n, maxIterations) : InterleaveAVXD<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXD<4, true>(xval, yval, n, maxIterations) : InterleaveAVXD<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterDN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
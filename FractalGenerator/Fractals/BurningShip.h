@@ -16,22 +16,55 @@
 class BurningShip : public Fractal
 {
 private:
-    int GetCPPIterF(float xval, float yval) const override;
+    int GetCPPIterF(float xval, float yval, int maxIterations) const override;
 
-    int GetCPPIterD(double xval, double yval) const override;
+    int GetCPPIterD(double xval, double yval, int maxIterations) const override;
 
-    __m128i GetSSEIterF(__m128 xval, __m128 yval) const override;
+    TARGET_AVX2 __m128i GetSSEIterF(__m128 xval, __m128 yval, int maxIterations, bool fma) const override;
 
-    __m128i GetSSEIterD(__m128d xval, __m128d yval) const override;
+    template<bool Fma>
+    TARGET_AVX2 __m128i SSEIterF(__m128 xval, __m128 yval, int maxIterations) const;
 
-    __m256i GetAVXIterF(__m256 xval, __m256 yval) const override;
+    TARGET_AVX2 __m128i GetSSEIterD(__m128d xval, __m128d yval, int maxIterations, bool fma) const override;
 
-    __m256i GetAVXIterD(__m256d xval, __m256d yval) const override;
+    template<bool Fma>
+    TARGET_AVX2 __m128i SSEIterD(__m128d xval, __m128d yval, int maxIterations) const;
+
+    TARGET_AVX2 __m256i GetAVXIterF(__m256 xval, __m256 yval, int maxIterations, bool fma) const override;
+
+    template<bool Fma>
+    TARGET_AVX2 __m256i AVXIterF(__m256 xval, __m256 yval, int maxIterations) const;
+
+    TARGET_AVX2 __m256i GetAVXIterD(__m256d xval, __m256d yval, int maxIterations, bool fma) const override;
+
+    template<bool Fma>
+    TARGET_AVX2 __m256i AVXIterD(__m256d xval, __m256d yval, int maxIterations) const;
+
+    // Interleaved AVX kernels, the interleave is chosen when rendering
+    TARGET_AVX2 void GetAVXIterFN(const __m256* xval, __m256 yval, __m256i* n, int interleave, int maxIterations, bool fma) const override;
+
+    TARGET_AVX2 void GetAVXIterDN(const __m256d* xval, __m256d yval, __m256i* n, int interleave, int maxIterations, bool fma) const override;
+
+    template<int N, bool Fma>
+    TARGET_AVX2 void InterleaveAVXF(const __m256* xval, __m256 yval, __m256i* n, int maxIterations) const;
+
+    template<int N, bool Fma>
+    TARGET_AVX2 void InterleaveAVXD(const __m256d* xval, __m256d yval, __m256i* n, int maxIterations) const;
 
 public:
-    BurningShip(std::shared_ptr<App> app) : Fractal(app, -2.2, 1.4, -2.1, 1.2)
+    BurningShip(std::shared_ptr<RenderHost> host) : Fractal(host, -2.2, 1.4, -2.1, 1.2)
     {
     }
 
     ~BurningShip() {}
+
+    std::unique_ptr<Fractal> Clone() const override
+    {
+        return std::make_unique<BurningShip>(*this);
+    }
+
+    const char* GetName() const override
+    {
+        return "BurningShip";
+    }
 };
\ No newline at end of file
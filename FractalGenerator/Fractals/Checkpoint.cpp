@@ -0,0 +1,162 @@
+/*********************************************************************************************
+**
+**	File Name:		checkpoint.cpp
+**	Description:	This is the file that contains the function definitions for the checkpoint
+**                  of a long render
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "Checkpoint.h"
+#include "TuningProfile.h"
+
+// First line of the file, a journal of another version is never resumed
+static const char* const s_format = "fractal-checkpoint 1\n";
+
+Checkpoint::Checkpoint(const std::filesystem::path& path, double intervalSeconds)
+    : m_path(path), m_interval(intervalSeconds)
+{
+}
+
+std::string Checkpoint::DescribeJob(const char* fractalName, const RenderRequest& request)
+{
+    const Viewport& view = request.view;
+    const RenderSettings& settings = request.settings;
+
+    // Doubles as hex floats, so the text is as exact as the view
+    char line[256];
+    std::string job = std::string("fractal ") + fractalName + "\n";
+    job += "centre " + view.cx.ToString() + " " + view.cy.ToString() + "\n";
+
+    snprintf(line, sizeof(line), "width %a %d %a\n", view.mantissa, view.exponent, view.aspect);
+    job += line;
+    snprintf(line, sizeof(line), "size %dx%d %d\n", request.width, request.height, static_cast<int>(request.format));
+    job += line;
+    snprintf(line, sizeof(line), "iterations %d %u\n", request.maxIterations, request.gradient);
+    job += line;
+
+    // Threads and pinning only decide where a tile is rendered, not its pixels
+    snprintf(line, sizeof(line), "backend %s %dx%d %d %d %d\n", TuningProfile::LanguageName(settings.language),
+        settings.tileWidth, settings.tileHeight, settings.fma, settings.perturbation, request.forceDouble);
+    job += line;
+
+    return job;
+}
+
+double Checkpoint::GetInterval() const
+{
+    return m_interval;
+}
+
+bool Checkpoint::Load(const std::string& job, size_t tileCount)
+{
+    m_job = job;
+    m_tileCount = tileCount;
+    m_tiles = std::make_unique<std::atomic<uint8_t>[]>(tileCount);
+    Clear();
+
+    std::ifstream file(m_path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const std::string header = s_format + job;
+    if (contents.compare(0, header.size(), header) != 0)
+    {
+        return false;
+    }
+
+    // The line of the tiles ends at its own newline, the bits after it may be anything
+    const size_t lineEnd = contents.find('\n', header.size());
+    size_t count = 0, finished = 0;
+    if (lineEnd == std::string::npos ||
+        sscanf(contents.substr(header.size(), lineEnd - header.size()).c_str(), "tiles %zu %zu", &count, &finished) != 2 ||
+        count != tileCount || contents.size() != lineEnd + 1 + (tileCount + 7) / 8)
+    {
+        return false;
+    }
+
+    const uint8_t* bits = reinterpret_cast<const uint8_t*>(contents.data() + lineEnd + 1);
+    for (size_t i = 0; i < tileCount; ++i)
+    {
+        m_tiles[i].store((bits[i / 8] >> (i % 8)) & 1, std::memory_order_relaxed);
+    }
+
+    return true;
+}
+
+void Checkpoint::Clear()
+{
+    for (size_t i = 0; i < m_tileCount; ++i)
+    {
+        m_tiles[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::atomic<uint8_t>* Checkpoint::GetTiles()
+{
+    return m_tiles.get();
+}
+
+size_t Checkpoint::CountFinished() const
+{
+    size_t finished = 0;
+    for (size_t i = 0; i < m_tileCount; ++i)
+    {
+        finished += m_tiles[i].load(std::memory_order_relaxed);
+    }
+
+    return finished;
+}
+
+bool Checkpoint::Save(const std::function<bool()>& flushOutput) const
+{
+    // Each flag is set after its tile's pixels are written, so these tiles are in the output
+    std::vector<uint8_t> bits((m_tileCount + 7) / 8);
+    size_t finished = 0;
+    for (size_t i = 0; i < m_tileCount; ++i)
+    {
+        if (m_tiles[i].load(std::memory_order_acquire))
+        {
+            bits[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+            ++finished;
+        }
+    }
+
+    if (!flushOutput())
+    {
+        return false;
+    }
+
+    std::filesystem::path temporary = m_path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file << s_format << m_job << "tiles " << m_tileCount << " " << finished << "\n";
+        file.write(reinterpret_cast<const char*>(bits.data()), bits.size());
+
+        if (!file.flush())
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, m_path, error);
+    return !error;
+}
+
+void Checkpoint::Remove() const
+{
+    std::error_code error;
+    std::filesystem::remove(m_path, error);
+}
@@ -0,0 +1,66 @@
+/*********************************************************************************************
+**
+**	File Name:		checkpoint.h
+**	Description:	This is the header file that contains the class definition for the
+**                  checkpoint of a long render, a journal of the job and of the tiles whose
+**                  pixels are already in its output, so a killed render carries on from it
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include "Fractal.h"
+
+// The file is a line naming the format, the job, a line with the number of tiles and the
+// number finished, then a bit for each tile in rows from the top left of the image
+class Checkpoint
+{
+private:
+    std::filesystem::path m_path;
+
+    // Seconds between two saves of the journal
+    double m_interval;
+
+    // Job of the tiles, a journal of any other job is never resumed
+    std::string m_job;
+
+    // One flag per tile, set by the render threads once the tile is in the output
+    std::unique_ptr<std::atomic<uint8_t>[]> m_tiles;
+    size_t m_tileCount{};
+
+public:
+    Checkpoint(const std::filesystem::path& path, double intervalSeconds = 30);
+
+    // Everything that decides the pixels of a render, the exact view to the last bit
+    static std::string DescribeJob(const char* fractalName, const RenderRequest& request);
+
+    double GetInterval() const;
+
+    // Start the journal of a job, with the tiles of the file if it holds the same job
+    // Returns false, with no tile finished, if there is no journal of this job
+    bool Load(const std::string& job, size_t tileCount);
+
+    // Forget the finished tiles, the output is started over
+    void Clear();
+
+    // Flags of the tiles, in rows from the top left of the image
+    std::atomic<uint8_t>* GetTiles();
+
+    size_t CountFinished() const;
+
+    // Write the journal, flushOutput makes the output hold every pixel written so far
+    // The flags are read first, so the file never marks a tile the output may not hold
+    // The file is replaced in one rename, a kill leaves the last journal or the new one
+    bool Save(const std::function<bool()>& flushOutput) const;
+
+    // The output is complete, the journal is no longer needed
+    void Remove() const;
+};
@@ -0,0 +1,500 @@
+/*********************************************************************************************
+**
+**	File Name:		deflate.cpp
+**	Description:	This is the file that contains the function definitions for the deflate
+**                  compressor
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <queue>
+#include "Deflate.h"
+
+// Shortest and longest matches, and the window they are found in
+static const int s_minMatch = 3;
+static const int s_maxMatch = 258;
+static const int s_window = 32768;
+
+// Bits of the hash of 3 bytes
+static const int s_hashBits = 15;
+
+// Earlier positions tried for each match, more compress better and slower
+static const int s_maxChain = 16;
+
+// Positions inside a match of up to this length are hashed, longer matches are skipped over
+static const int s_maxInsert = 32;
+
+// Symbols of one block, each block gets codes for its own part of the data
+static const size_t s_blockSymbols = 1 << 15;
+
+// Lengths and distances of each code and the extra bits after it
+static const uint16_t s_lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t s_lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t s_distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t s_distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Order the code lengths of the code length code are written in
+static const uint8_t s_lengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Code of each match length
+static const std::vector<uint8_t>& LengthCodes()
+{
+    static const std::vector<uint8_t> table = []
+        {
+            std::vector<uint8_t> codes(s_maxMatch + 1);
+            for (int code = 0; code < 29; ++code)
+            {
+                for (int length = s_lengthBase[code]; length < s_lengthBase[code] + (1 << s_lengthExtra[code]) && length <= s_maxMatch; ++length)
+                {
+                    codes[length] = static_cast<uint8_t>(code);
+                }
+            }
+            return codes;
+        }();
+
+    return table;
+}
+
+// Code of each distance, the first 256 distances one by one and the rest in steps of 128
+static int DistanceCode(int distance)
+{
+    static const std::vector<uint8_t> table = []
+        {
+            std::vector<uint8_t> codes(512);
+            for (int code = 0; code < 30; ++code)
+            {
+                for (int d = s_distanceBase[code]; d < s_distanceBase[code] + (1 << s_distanceExtra[code]); ++d)
+                {
+                    codes[d <= 256 ? d - 1 : 256 + ((d - 1) >> 7)] = static_cast<uint8_t>(code);
+                }
+            }
+            return codes;
+        }();
+
+    return table[distance <= 256 ? distance - 1 : 256 + ((distance - 1) >> 7)];
+}
+
+void Deflate::BitWriter::Put(uint32_t value, int length)
+{
+    bits |= static_cast<uint64_t>(value) << count;
+    count += length;
+
+    while (count >= 8)
+    {
+        out.push_back(static_cast<uint8_t>(bits));
+        bits >>= 8;
+        count -= 8;
+    }
+}
+
+void Deflate::BitWriter::Align()
+{
+    if (count > 0)
+    {
+        out.push_back(static_cast<uint8_t>(bits));
+    }
+
+    bits = 0;
+    count = 0;
+}
+
+void Deflate::Compress(const uint8_t* data, size_t size, bool last, std::vector<uint8_t>& out)
+{
+    FindMatches(data, size);
+
+    BitWriter writer{ out };
+    for (size_t start = 0; start < m_symbols.size(); start += s_blockSymbols)
+    {
+        size_t count = std::min(m_symbols.size() - start, s_blockSymbols);
+        WriteBlock(writer, &m_symbols[start], count, last && start + count == m_symbols.size());
+    }
+
+    if (last)
+    {
+        // Without data the stream still needs its final block, an empty one with the fixed codes
+        if (m_symbols.empty())
+        {
+            writer.Put(1, 1);
+            writer.Put(1, 2);
+            writer.Put(0, 7);
+        }
+
+        writer.Align();
+        return;
+    }
+
+    // Sync flush, an empty stored block brings the stream to a byte boundary
+    writer.Put(0, 3);
+    writer.Align();
+    static const uint8_t empty[4] = { 0x00, 0x00, 0xff, 0xff };
+    out.insert(out.end(), empty, empty + 4);
+}
+
+void Deflate::FindMatches(const uint8_t* data, size_t size)
+{
+    m_head.assign(static_cast<size_t>(1) << s_hashBits, -1);
+    m_chain.resize(s_window);
+    m_symbols.clear();
+
+    auto hash = [data](size_t pos)
+        {
+            uint32_t bytes = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+            return (bytes * 2654435761u) >> (32 - s_hashBits);
+        };
+
+    auto insert = [&](size_t pos)
+        {
+            uint32_t h = hash(pos);
+            m_chain[pos & (s_window - 1)] = m_head[h];
+            m_head[h] = static_cast<int32_t>(pos);
+        };
+
+    size_t pos = 0;
+    while (pos < size)
+    {
+        int bestLength = 0, bestDistance = 0;
+
+        if (pos + s_minMatch <= size)
+        {
+            const int maxLength = static_cast<int>(std::min(size - pos, static_cast<size_t>(s_maxMatch)));
+            int32_t candidate = m_head[hash(pos)];
+            insert(pos);
+
+            // Positions on the chain only go back, a newer one means the entry was reused
+            for (int tries = 0; candidate >= 0 && pos - candidate <= s_window && tries < s_maxChain; ++tries)
+            {
+                const uint8_t* a = data + pos;
+                const uint8_t* b = data + candidate;
+
+                // The byte that would make it longer than the best is checked first
+                if (a[bestLength] == b[bestLength] || bestLength == 0)
+                {
+                    int length = 0;
+                    while (length + 8 <= maxLength)
+                    {
+                        uint64_t x, y;
+                        memcpy(&x, a + length, 8);
+                        memcpy(&y, b + length, 8);
+                        if (x != y)
+                        {
+                            length += std::countr_zero(x ^ y) / 8;
+                            break;
+                        }
+                        length += 8;
+                    }
+                    if (length + 8 > maxLength)
+                    {
+                        while (length < maxLength && a[length] == b[length])
+                        {
+                            ++length;
+                        }
+                    }
+
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = static_cast<int>(pos - candidate);
+                        if (length >= maxLength)
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                int32_t next = m_chain[candidate & (s_window - 1)];
+                if (next >= candidate)
+                {
+                    break;
+                }
+                candidate = next;
+            }
+        }
+
+        if (bestLength >= s_minMatch)
+        {
+            m_symbols.push_back({ static_cast<uint16_t>(bestLength), static_cast<uint16_t>(bestDistance) });
+
+            if (bestLength <= s_maxInsert)
+            {
+                for (size_t i = pos + 1; i < pos + bestLength && i + s_minMatch <= size; ++i)
+                {
+                    insert(i);
+                }
+            }
+            pos += bestLength;
+        }
+        else
+        {
+            m_symbols.push_back({ data[pos], 0 });
+            ++pos;
+        }
+    }
+}
+
+void Deflate::WriteBlock(BitWriter& writer, const Symbol* symbols, size_t count, bool final)
+{
+    const std::vector<uint8_t>& lengthCodes = LengthCodes();
+
+    uint32_t literalFrequencies[286] = {};
+    uint32_t distanceFrequencies[30] = {};
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (symbols[i].distance)
+        {
+            ++literalFrequencies[257 + lengthCodes[symbols[i].value]];
+            ++distanceFrequencies[DistanceCode(symbols[i].distance)];
+        }
+        else
+        {
+            ++literalFrequencies[symbols[i].value];
+        }
+    }
+    literalFrequencies[256] = 1;
+
+    uint8_t literalLengths[286], distanceLengths[30];
+    BuildLengths(literalFrequencies, 286, 15, literalLengths);
+    BuildLengths(distanceFrequencies, 30, 15, distanceLengths);
+
+    int literalCount = 286, distanceCount = 30;
+    while (literalCount > 257 && !literalLengths[literalCount - 1])
+    {
+        --literalCount;
+    }
+    while (distanceCount > 1 && !distanceLengths[distanceCount - 1])
+    {
+        --distanceCount;
+    }
+
+    // Both sets of lengths as one sequence, runs coded with 16 (repeat the last), 17 and 18 (zeros)
+    std::vector<uint8_t> lengths(literalLengths, literalLengths + literalCount);
+    lengths.insert(lengths.end(), distanceLengths, distanceLengths + distanceCount);
+
+    struct LengthSymbol
+    {
+        uint8_t symbol;
+        uint8_t extra;
+    };
+    std::vector<LengthSymbol> runs;
+    uint32_t runFrequencies[19] = {};
+
+    for (size_t i = 0; i < lengths.size();)
+    {
+        const uint8_t length = lengths[i];
+        size_t run = 1;
+        while (i + run < lengths.size() && lengths[i + run] == length)
+        {
+            ++run;
+        }
+        i += run;
+
+        if (length == 0)
+        {
+            while (run >= 11)
+            {
+                size_t part = std::min(run, static_cast<size_t>(138));
+                runs.push_back({ 18, static_cast<uint8_t>(part - 11) });
+                run -= part;
+            }
+            if (run >= 3)
+            {
+                runs.push_back({ 17, static_cast<uint8_t>(run - 3) });
+                run = 0;
+            }
+        }
+        else
+        {
+            runs.push_back({ length, 0 });
+            --run;
+            while (run >= 3)
+            {
+                size_t part = std::min(run, static_cast<size_t>(6));
+                runs.push_back({ 16, static_cast<uint8_t>(part - 3) });
+                run -= part;
+            }
+        }
+
+        for (; run > 0; --run)
+        {
+            runs.push_back({ length, 0 });
+        }
+    }
+
+    for (const LengthSymbol& run : runs)
+    {
+        ++runFrequencies[run.symbol];
+    }
+
+    uint8_t runLengths[19];
+    BuildLengths(runFrequencies, 19, 7, runLengths);
+
+    int runLengthCount = 19;
+    while (runLengthCount > 4 && !runLengths[s_lengthOrder[runLengthCount - 1]])
+    {
+        --runLengthCount;
+    }
+
+    // Header of a block with dynamic codes
+    writer.Put(final ? 1 : 0, 1);
+    writer.Put(2, 2);
+    writer.Put(literalCount - 257, 5);
+    writer.Put(distanceCount - 1, 5);
+    writer.Put(runLengthCount - 4, 4);
+    for (int i = 0; i < runLengthCount; ++i)
+    {
+        writer.Put(runLengths[s_lengthOrder[i]], 3);
+    }
+
+    uint16_t runCodes[19];
+    BuildCodes(runLengths, 19, runCodes);
+    for (const LengthSymbol& run : runs)
+    {
+        writer.Put(runCodes[run.symbol], runLengths[run.symbol]);
+        switch (run.symbol)
+        {
+        case 16:
+            writer.Put(run.extra, 2);
+            break;
+        case 17:
+            writer.Put(run.extra, 3);
+            break;
+        case 18:
+            writer.Put(run.extra, 7);
+            break;
+        } // Switch
+    }
+
+    // The data, then the end of the block
+    uint16_t literalCodes[286], distanceCodes[30];
+    BuildCodes(literalLengths, 286, literalCodes);
+    BuildCodes(distanceLengths, 30, distanceCodes);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Symbol& symbol = symbols[i];
+        if (!symbol.distance)
+        {
+            writer.Put(literalCodes[symbol.value], literalLengths[symbol.value]);
+            continue;
+        }
+
+        const int lengthCode = lengthCodes[symbol.value];
+        writer.Put(literalCodes[257 + lengthCode], literalLengths[257 + lengthCode]);
+        writer.Put(symbol.value - s_lengthBase[lengthCode], s_lengthExtra[lengthCode]);
+
+        const int distanceCode = DistanceCode(symbol.distance);
+        writer.Put(distanceCodes[distanceCode], distanceLengths[distanceCode]);
+        writer.Put(symbol.distance - s_distanceBase[distanceCode], s_distanceExtra[distanceCode]);
+    }
+
+    writer.Put(literalCodes[256], literalLengths[256]);
+}
+
+void Deflate::BuildLengths(const uint32_t* frequencies, int count, int limit, uint8_t* lengths)
+{
+    // A code needs two symbols, unused ones fill in for a block that only has one
+    std::vector<uint32_t> weights(frequencies, frequencies + count);
+    for (int i = 0, used = static_cast<int>(count - std::count(weights.begin(), weights.end(), 0u)); used < 2 && i < count; ++i)
+    {
+        if (!weights[i])
+        {
+            weights[i] = 1;
+            ++used;
+        }
+    }
+
+    std::vector<int> parents(2 * count);
+    for (;;)
+    {
+        // Huffman's tree, the two lightest nodes are joined until one is left
+        using Node = std::pair<uint64_t, int>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> nodes;
+        for (int i = 0; i < count; ++i)
+        {
+            if (weights[i])
+            {
+                nodes.push({ weights[i], i });
+            }
+        }
+
+        int next = count;
+        while (nodes.size() > 1)
+        {
+            Node a = nodes.top();
+            nodes.pop();
+            Node b = nodes.top();
+            nodes.pop();
+
+            parents[a.second] = next;
+            parents[b.second] = next;
+            nodes.push({ a.first + b.first, next++ });
+        }
+        const int root = next - 1;
+
+        int longest = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            int depth = 0;
+            if (weights[i])
+            {
+                for (int node = i; node != root; node = parents[node])
+                {
+                    ++depth;
+                }
+            }
+            lengths[i] = static_cast<uint8_t>(depth);
+            longest = std::max(longest, depth);
+        }
+
+        if (longest <= limit)
+        {
+            return;
+        }
+
+        // Too deep, flatten the frequencies and build it again
+        for (uint32_t& weight : weights)
+        {
+            weight = weight ? (weight + 1) / 2 : 0;
+        }
+    }
+}
+
+void Deflate::BuildCodes(const uint8_t* lengths, int count, uint16_t* codes)
+{
+    int lengthCounts[16] = {};
+    for (int i = 0; i < count; ++i)
+    {
+        ++lengthCounts[lengths[i]];
+    }
+    lengthCounts[0] = 0;
+
+    // First code of each length, shorter codes come first
+    int nextCode[16] = {};
+    for (int length = 1, code = 0; length < 16; ++length)
+    {
+        code = (code + lengthCounts[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        const int length = lengths[i];
+        if (!length)
+        {
+            codes[i] = 0;
+            continue;
+        }
+
+        // Huffman codes are read from their most significant bit
+        uint32_t code = nextCode[length]++, reversed = 0;
+        for (int bit = 0; bit < length; ++bit)
+        {
+            reversed = (reversed << 1) | ((code >> bit) & 1);
+        }
+        codes[i] = static_cast<uint16_t>(reversed);
+    }
+}
@@ -0,0 +1,65 @@
+/*********************************************************************************************
+**
+**	File Name:		deflate.h
+**	Description:	This is the header file that contains the class definition for the deflate
+**                  compressor of the PNG writer, LZ77 matches coded with dynamic Huffman codes
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Compresses blocks of data on their own, each ends on a byte boundary so the blocks of
+// several compressors join into one deflate stream in order
+// One compressor per thread, it keeps its tables from one block to the next
+class Deflate
+{
+private:
+    // Literal byte or a match of 3 to 258 bytes, distance is 0 for a literal
+    struct Symbol
+    {
+        uint16_t value;
+        uint16_t distance;
+    };
+
+    // Bits are packed from the least significant bit of each byte, as deflate reads them
+    struct BitWriter
+    {
+        std::vector<uint8_t>& out;
+        uint64_t bits = 0;
+        int count = 0;
+
+        void Put(uint32_t value, int length);
+
+        // Pad the last byte with zeros
+        void Align();
+    };
+
+    // Most recent position of each hash of 3 bytes, and the position before it with the same hash
+    std::vector<int32_t> m_head;
+    std::vector<int32_t> m_chain;
+
+    std::vector<Symbol> m_symbols;
+
+    // Matches of the data, the same bytes found up to 32 KB back
+    void FindMatches(const uint8_t* data, size_t size);
+
+    // One block with its own codes for the symbols
+    void WriteBlock(BitWriter& writer, const Symbol* symbols, size_t count, bool final);
+
+    // Code lengths of a Huffman code for the frequencies, none longer than limit
+    static void BuildLengths(const uint32_t* frequencies, int count, int limit, uint8_t* lengths);
+
+    // Canonical codes of the lengths, bit reversed to be written from their first bit
+    static void BuildCodes(const uint8_t* lengths, int count, uint16_t* codes);
+
+public:
+    // Append the compressed data to out
+    // The last block of the stream is marked final, any other ends with a sync flush
+    void Compress(const uint8_t* data, size_t size, bool last, std::vector<uint8_t>& out);
+};
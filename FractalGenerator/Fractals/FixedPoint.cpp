@@ -0,0 +1,248 @@
+/*********************************************************************************************
+**
+**	File Name:		fixedpoint.cpp
+**	Description:	This is the file that contains the function definitions for the fixed
+**                  point numbers of the viewport
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "FixedPoint.h"
+
+FixedPoint::FixedPoint(double value)
+{
+    if (value == 0 || !std::isfinite(value))
+    {
+        return;
+    }
+
+    m_negative = value < 0;
+
+    // value = mantissa * 2^exponent with a 53 bit integer mantissa
+    int exponent;
+    double fraction = std::frexp(std::fabs(value), &exponent);
+    uint64_t mantissa = static_cast<uint64_t>(std::ldexp(fraction, 53));
+    exponent -= 53;
+
+    // Place each bit of the mantissa in its word, bit q of the value (worth 2^q) is in word
+    // 0 for q >= 0 and in word (-q - 1) / 32 + 1 below that
+    for (int bit = 0; bit < 53; ++bit)
+    {
+        if (!(mantissa >> bit & 1))
+        {
+            continue;
+        }
+
+        int q = bit + exponent;
+        int word = q >= 0 ? 0 : (-q - 1) / 32 + 1;
+        if (q >= 32)
+        {
+            continue;
+        }
+
+        if (word >= static_cast<int>(m_words.size()))
+        {
+            m_words.resize(word + 1);
+        }
+        m_words[word] |= 1u << (q + 32 * word);
+    }
+
+    Trim();
+}
+
+double FixedPoint::ToDouble() const
+{
+    // Skip the leading zero words, three words after them carry more bits than a double
+    size_t first = 0;
+    while (first + 1 < m_words.size() && m_words[first] == 0)
+    {
+        ++first;
+    }
+
+    double value = 0;
+    for (size_t i = first; i < m_words.size() && i < first + 3; ++i)
+    {
+        value += std::ldexp(static_cast<double>(m_words[i]), -32 * static_cast<int>(i));
+    }
+
+    return m_negative ? -value : value;
+}
+
+int FixedPoint::CompareMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+{
+    size_t words = std::max(a.size(), b.size());
+    for (size_t i = 0; i < words; ++i)
+    {
+        uint32_t wordA = i < a.size() ? a[i] : 0;
+        uint32_t wordB = i < b.size() ? b[i] : 0;
+        if (wordA != wordB)
+        {
+            return wordA < wordB ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+void FixedPoint::AddMagnitude(std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+{
+    if (a.size() < b.size())
+    {
+        a.resize(b.size());
+    }
+
+    // From the least significant word up, the integer part wraps
+    uint64_t carry = 0;
+    for (size_t i = a.size(); i-- > 0;)
+    {
+        uint64_t sum = static_cast<uint64_t>(a[i]) + (i < b.size() ? b[i] : 0) + carry;
+        a[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+void FixedPoint::SubMagnitude(std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+{
+    if (a.size() < b.size())
+    {
+        a.resize(b.size());
+    }
+
+    int64_t borrow = 0;
+    for (size_t i = a.size(); i-- > 0;)
+    {
+        int64_t difference = static_cast<int64_t>(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+        borrow = difference < 0;
+        a[i] = static_cast<uint32_t>(difference + (borrow << 32));
+    }
+}
+
+void FixedPoint::Trim()
+{
+    while (m_words.size() > 1 && m_words.back() == 0)
+    {
+        m_words.pop_back();
+    }
+
+    // Zero has one sign
+    if (m_words.size() == 1 && m_words[0] == 0)
+    {
+        m_negative = false;
+    }
+}
+
+FixedPoint& FixedPoint::operator+=(const FixedPoint& other)
+{
+    if (m_negative == other.m_negative)
+    {
+        AddMagnitude(m_words, other.m_words);
+    }
+    else if (CompareMagnitude(m_words, other.m_words) >= 0)
+    {
+        SubMagnitude(m_words, other.m_words);
+    }
+    else
+    {
+        // The other value is larger, its sign wins
+        std::vector<uint32_t> words = other.m_words;
+        SubMagnitude(words, m_words);
+        m_words.swap(words);
+        m_negative = other.m_negative;
+    }
+
+    Trim();
+    return *this;
+}
+
+FixedPoint& FixedPoint::operator-=(const FixedPoint& other)
+{
+    return *this += -other;
+}
+
+FixedPoint FixedPoint::operator+(const FixedPoint& other) const
+{
+    FixedPoint sum = *this;
+    sum += other;
+    return sum;
+}
+
+FixedPoint FixedPoint::operator-(const FixedPoint& other) const
+{
+    FixedPoint difference = *this;
+    difference -= other;
+    return difference;
+}
+
+FixedPoint FixedPoint::operator-() const
+{
+    FixedPoint negated = *this;
+    negated.m_negative = !m_negative;
+    negated.Trim();
+    return negated;
+}
+
+int FixedPoint::FractionBits() const
+{
+    return 32 * static_cast<int>(m_words.size() - 1);
+}
+
+std::string FixedPoint::ToString() const
+{
+    std::string text = m_negative ? "-" : "";
+
+    char word[9];
+    for (size_t i = 0; i < m_words.size(); ++i)
+    {
+        snprintf(word, sizeof(word), "%08x", m_words[i]);
+        text += i == 1 ? "." : "";
+        text += word;
+    }
+
+    return text;
+}
+
+bool FixedPoint::Parse(const std::string& text, FixedPoint& value)
+{
+    const bool negative = !text.empty() && text[0] == '-';
+    size_t at = negative ? 1 : 0;
+
+    // Words of 8 hex digits, the fraction words after a dot
+    std::vector<uint32_t> words;
+    while (at < text.size() || words.empty())
+    {
+        if (words.size() == 1 && text[at++] != '.')
+        {
+            return false;
+        }
+
+        if (text.size() < at + 8)
+        {
+            return false;
+        }
+
+        uint32_t word = 0;
+        for (size_t i = at; i < at + 8; ++i)
+        {
+            const char c = text[i];
+            const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digit < 0)
+            {
+                return false;
+            }
+            word = word << 4 | digit;
+        }
+
+        words.push_back(word);
+        at += 8;
+    }
+
+    value.m_negative = negative;
+    value.m_words = words;
+    value.Trim();
+    return true;
+}
@@ -0,0 +1,64 @@
+/*********************************************************************************************
+**
+**	File Name:		fixedpoint.h
+**	Description:	This is the header file that contains the class definition for the fixed
+**                  point numbers of the viewport, exact coordinates of any precision
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sign and magnitude, the magnitude is a 32 bit integer part followed by as many 32 bit words
+// of fraction as the value needs
+// Sums and differences are exact, the fraction grows to hold them
+class FixedPoint
+{
+private:
+    bool m_negative{};
+    // Most significant word first, m_words[0] is the integer part
+    // Trailing zero words are dropped so equal values have equal words
+    std::vector<uint32_t> m_words{ 0 };
+
+    // Compare the magnitudes, -1, 0 or 1
+    static int CompareMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+
+    // a += b and a -= b on the magnitudes, a -= b needs |a| >= |b|
+    static void AddMagnitude(std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+    static void SubMagnitude(std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+
+    void Trim();
+
+public:
+    FixedPoint() = default;
+
+    // Exact, |value| must be below 2^32
+    explicit FixedPoint(double value);
+
+    // Rounded to the nearest double
+    double ToDouble() const;
+
+    FixedPoint& operator+=(const FixedPoint& other);
+    FixedPoint& operator-=(const FixedPoint& other);
+
+    FixedPoint operator+(const FixedPoint& other) const;
+    FixedPoint operator-(const FixedPoint& other) const;
+    FixedPoint operator-() const;
+
+    bool operator==(const FixedPoint& other) const = default;
+
+    // Bits of fraction the value needs
+    int FractionBits() const;
+
+    // Exact text of the value, the words in hex with a dot after the integer part
+    std::string ToString() const;
+
+    // Read the text ToString writes, false if it is not in that form
+    static bool Parse(const std::string& text, FixedPoint& value);
+};
@@ -9,187 +9,571 @@
 **
 **********************************************************************************************/
 
-#include "../App.h"
-#include "fractal.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "Fractal.h"
+#include "Topology.h"
+#include "TuningProfile.h"
 
-void Fractal::UseCPP(Colour* pixelBuffer, int yStart, int yEnd, bool useFloat)
+TileStats Fractal::UseCPP(const Frame& frame, const Tile& tile, int step, bool refine, bool useFloat) const
 {
+    const RenderRequest& request = frame.request;
+    TileStats stats = { 0, 0, request.maxIterations, 0 };
+
     // Variables for updating the x and y values
     // Essentially mapping a complex plane point to a pixel
-    double dx = (m_xMax - m_xMin) / static_cast<double>(m_app->m_widthW);
-    double dy = (m_yMax - m_yMin) / static_cast<double>(m_app->m_heightW);
+    const double dx = frame.dx, dy = frame.dy;
+
+    // Only the rows on the grid of this pass
+    int yStart = (tile.yStart + step - 1) / step * step;
 
-    double yval = m_yMin + yStart * dy;
-    for (int y = yStart; y < yEnd; ++y)
+    for (int y = yStart; y < tile.yEnd; y += step)
     {
-        double xval = m_xMin;
-        for (int x = 0; x < m_app->m_widthW; ++x)
+        // Rows that were on the previous grid already have every other sample
+        int xStart = tile.xStart + (refine && y % (2 * step) == 0 ? step : 0);
+        int xStep = refine && y % (2 * step) == 0 ? 2 * step : step;
+
+        double yval = frame.yMin + y * dy;
+        for (int x = xStart; x < tile.xEnd; x += xStep)
         {
+            // From the pixel index, so the error does not grow along the row
+            double xval = frame.xMin + x * dx;
+
             int n;
             if (useFloat)
             {
-                n = GetCPPIterF(static_cast<float>(xval), static_cast<float>(yval));
+                n = GetCPPIterF(static_cast<float>(xval), static_cast<float>(yval), request.maxIterations);
             }
             else
             {
-                n = GetCPPIterD(xval, yval);
+                n = GetCPPIterD(xval, yval, request.maxIterations);
             }
 
-            MapColour(&pixelBuffer[y * m_app->m_widthW + x], static_cast<uint8_t>(n));
-            xval += dx;
+            StorePixel(frame, x, y, static_cast<uint8_t>(n), n);
+            stats.Add(n);
         }
-        yval += dy;
     }
+
+    return stats;
 }
 
-void Fractal::UseSSE(Colour* pixelBuffer, int yStart, int yEnd, bool useFloat)
+TileStats Fractal::UseSSE(const Frame& frame, const Tile& tile, int step, bool refine, bool useFloat) const
 {
-    if (useFloat)
+    const RenderRequest& request = frame.request;
+    const RenderSettings& settings = request.settings;
+    TileStats stats = { 0, 0, request.maxIterations, 0 };
+
+    const double dx = frame.dx, dy = frame.dy;
+
+    // Only the rows on the grid of this pass
+    int yStart = (tile.yStart + step - 1) / step * step;
+
+    for (int y = yStart; y < tile.yEnd; y += step)
     {
-        float dx = static_cast<float>((m_xMax - m_xMin) / m_app->m_widthW);
-        float dy = static_cast<float>((m_yMax - m_yMin) / m_app->m_heightW);
-        const __m128 xShift_coeffs = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
-        __m128 yval = _mm_add_ps(_mm_set1_ps(static_cast<float>(m_yMin)), _mm_mul_ps(_mm_set1_ps(static_cast<float>(yStart)), _mm_set1_ps(dy))); // Setting initial yval to startin range of y
-        __m128 xShift = _mm_mul_ps(_mm_set1_ps(dx), xShift_coeffs); // Amount to shift x for each number we will be processing
-        __m128 dxSSE = _mm_set1_ps(m_sseVectSizeF * dx); // Amount to change multiplied by the number of floats calculated in parallel
-        __m128 dySSE = _mm_set1_ps(dy); // The change for y each time will be the default
+        // Rows that were on the previous grid already have every other sample
+        int xStart = tile.xStart + (refine && y % (2 * step) == 0 ? step : 0);
+        int xStep = refine && y % (2 * step) == 0 ? 2 * step : step;
 
-        for (int y = yStart; y < yEnd; ++y)
+        // Last pixel of the row on this grid, the lanes after it repeat it
+        int xLast = tile.xEnd - 1 - (tile.xEnd - 1 - xStart) % xStep;
+
+        double yrow = frame.yMin + y * dy;
+
+        if (useFloat)
         {
-            __m128 xval = _mm_add_ps(_mm_set1_ps(static_cast<float>(m_xMin)), xShift); // Initial x values for first floats
+            __m128 yval = _mm_set1_ps(static_cast<float>(yrow)); // Setting the yval of this row
 
-            for (int x = 0; x < m_app->m_widthW; x += m_sseVectSizeF) // Increase by the amount of floats being processed each time
+            for (int x = xStart; x < tile.xEnd; x += m_sseVectSizeF * xStep) // Increase by the amount of floats being processed each time
             {
-                __m128i iter = GetSSEIterF(xval, yval); // Calculate amount of iterations for the floats
+                alignas(16) float xs[4];
+                LaneCoordinates(xs, m_sseVectSizeF, x, xStep, xLast, frame.xMin, dx);
 
-                int* n_int = (int*)(&iter); // Pointer to the number of iterations
-                int pixel_i = y * m_app->m_widthW + x; // Current pixel index
+                __m128i iter = GetSSEIterF(_mm_load_ps(xs), yval, request.maxIterations, settings.fma); // Calculate amount of iterations for the floats
 
-                // Colour the pixels that are loaded
-                for (int i = 0; i < m_sseVectSizeF; ++i, ++pixel_i)
+                int16_t lanes[4];
+                LaneValues(iter, lanes, m_sseVectSizeF);
+
+                // Colour the pixels that are inside the row
+                for (int i = 0, pixel_x = x; i < m_sseVectSizeF && pixel_x < tile.xEnd; ++i, pixel_x += xStep)
                 {
-                    uint8_t n = (uint8_t)(n_int[i]); // Changing the pointer to unsigned int
-                    MapColour(&pixelBuffer[pixel_i], n);
+                    int n = LaneIterations(lanes[i]);
+                    StorePixel(frame, pixel_x, y, static_cast<uint8_t>(lanes[i]), n);
+                    stats.Add(n);
                 }
-
-                xval = _mm_add_ps(xval, dxSSE); // Updating the x values
             }
+        }
+        else
+        {
+            __m128d yval = _mm_set1_pd(yrow); // Setting the yval of this row
+
+            for (int x = xStart; x < tile.xEnd; x += m_sseVectSizeD * xStep) // Increase by the number of doubles being processed per iteration
+            {
+                alignas(16) double xs[2];
+                LaneCoordinates(xs, m_sseVectSizeD, x, xStep, xLast, frame.xMin, dx);
+
+                __m128i iter = GetSSEIterD(_mm_load_pd(xs), yval, request.maxIterations, settings.fma); // Calculate iterations for the doubles
 
-            yval = _mm_add_ps(yval, dySSE); // Updating the y value
+                int16_t lanes[2];
+                LaneValues(iter, lanes, m_sseVectSizeD);
+
+                // Colour the pixels that are inside the row
+                for (int i = 0, pixel_x = x; i < m_sseVectSizeD && pixel_x < tile.xEnd; ++i, pixel_x += xStep)
+                {
+                    int n = LaneIterations(lanes[i]);
+                    StorePixel(frame, pixel_x, y, static_cast<uint8_t>(lanes[i]), n);
+                    stats.Add(n);
+                }
+            }
         }
     }
-    else
+
+    return stats;
+}
+
+TileStats Fractal::UseAVX(const Frame& frame, const Tile& tile, int step, bool refine, bool useFloat) const
+{
+    const RenderRequest& request = frame.request;
+    const RenderSettings& settings = request.settings;
+
+    // Deep tiles iterate their offsets to the reference orbit in float
+    if (!useFloat && settings.perturbation && frame.reference && !frame.reference->zx.empty())
+    {
+        return UsePerturbation(frame, tile, step, refine);
+    }
+
+    TileStats stats = { 0, 0, request.maxIterations, 0 };
+
+    const double dx = frame.dx, dy = frame.dy;
+
+    // Only the rows on the grid of this pass
+    int yStart = (tile.yStart + step - 1) / step * step;
+
+    const int vectSize = useFloat ? m_avxVectSizeF : m_avxVectSizeD;
+
+    for (int y = yStart; y < tile.yEnd; y += step)
     {
-        double dx = (m_xMax - m_xMin) / static_cast<double>(m_app->m_widthW);
-        double dy = (m_yMax - m_yMin) / static_cast<double>(m_app->m_heightW);
-        __m128d xShift_coeffs = _mm_set_pd(1.0, 0.0); // 2 doubles
-        __m128d yval = _mm_add_pd(_mm_set1_pd(m_yMin), _mm_mul_pd(_mm_set1_pd(yStart), _mm_set1_pd(dy))); // Setting initial yval
-        __m128d xShift = _mm_mul_pd(_mm_set1_pd(dx), xShift_coeffs); // Amount to shift x for each pair of numbers
-        __m128d dxSSE = _mm_set1_pd(m_sseVectSizeD * dx); // Amount to change for 2 doubles at a time
-        __m128d dySSE = _mm_set1_pd(dy); // The change in y is the default value
+        // Rows that were on the previous grid already have every other sample
+        int xStart = tile.xStart + (refine && y % (2 * step) == 0 ? step : 0);
+        int xStep = refine && y % (2 * step) == 0 ? 2 * step : step;
+
+        // Last pixel of the row on this grid, the lanes after it repeat it
+        int xLast = tile.xEnd - 1 - (tile.xEnd - 1 - xStart) % xStep;
+
+        double yrow = frame.yMin + y * dy;
+
+        // Consecutive vectors of the row are iterated together
+        for (int x = xStart; x < tile.xEnd; x += settings.interleave * vectSize * xStep)
+        {
+            // The end of the row may not need every vector
+            int vectors = (xLast - x) / (vectSize * xStep) + 1;
+            vectors = vectors < settings.interleave ? vectors : settings.interleave;
+
+            int16_t lanes[m_maxInterleave * 8];
 
-        for (int y = yStart; y < yEnd; ++y) {
-            __m128d xval = _mm_add_pd(_mm_set1_pd(m_xMin), xShift); // Initial x values for the first 2 doubles
+            if (useFloat)
+            {
+                __m256 yval = _mm256_set1_ps(static_cast<float>(yrow)); // Setting the yval of this row
+                __m256 xvals[m_maxInterleave];
+                __m256i N[m_maxInterleave];
+
+                for (int k = 0; k < vectors; ++k)
+                {
+                    alignas(32) float xs[8];
+                    LaneCoordinates(xs, m_avxVectSizeF, x + k * m_avxVectSizeF * xStep, xStep, xLast, frame.xMin, dx);
+                    xvals[k] = _mm256_load_ps(xs);
+                }
+
+                if (vectors == 1)
+                {
+                    N[0] = GetAVXIterF(xvals[0], yval, request.maxIterations, settings.fma); // Calculate amount of iterations for the floats
+                }
+                else
+                {
+                    GetAVXIterFN(xvals, yval, N, vectors, request.maxIterations, settings.fma);
+                }
 
-            for (int x = 0; x < m_app->m_widthW; x += m_sseVectSizeD) { // Increase by the number of doubles being processed per iteration
-                __m128i iter = GetSSEIterD(xval, yval); // Calculate iterations for the doubles
+                for (int k = 0; k < vectors; ++k)
+                {
+                    LaneValues(N[k], &lanes[k * m_avxVectSizeF], m_avxVectSizeF);
+                }
+            }
+            else
+            {
+                __m256d yval = _mm256_set1_pd(yrow); // Setting the yval of this row
+                __m256d xvals[m_maxInterleave];
+                __m256i N[m_maxInterleave];
 
-                int* n_int = (int*)(&iter); // Pointer to the number of iterations
-                int pixel_i = y * m_app->m_widthW + x; // Current pixel index
+                for (int k = 0; k < vectors; ++k)
+                {
+                    alignas(32) double xs[4];
+                    LaneCoordinates(xs, m_avxVectSizeD, x + k * m_avxVectSizeD * xStep, xStep, xLast, frame.xMin, dx);
+                    xvals[k] = _mm256_load_pd(xs);
+                }
 
-                // Colour the pixels for the doubles being calculated in parallel
-                for (int i = 0; i < m_sseVectSizeD; ++i, ++pixel_i) {
-                    uint8_t n = (uint8_t)(n_int[i]); // Changing the pointer to unsigned int
-                    MapColour(&pixelBuffer[pixel_i], n);
+                if (vectors == 1)
+                {
+                    N[0] = GetAVXIterD(xvals[0], yval, request.maxIterations, settings.fma); // Calculate amount of iterations for the doubles
+                }
+                else
+                {
+                    GetAVXIterDN(xvals, yval, N, vectors, request.maxIterations, settings.fma);
                 }
 
-                xval = _mm_add_pd(xval, dxSSE); // Update the x values
+                for (int k = 0; k < vectors; ++k)
+                {
+                    LaneValues(N[k], &lanes[k * m_avxVectSizeD], m_avxVectSizeD);
+                }
             }
 
-            yval = _mm_add_pd(yval, dySSE); // Update the y value
+            // Colour the pixels that are inside the row
+            for (int i = 0, pixel_x = x; i < vectors * vectSize && pixel_x < tile.xEnd; ++i, pixel_x += xStep)
+            {
+                int n = LaneIterations(lanes[i]);
+                StorePixel(frame, pixel_x, y, static_cast<uint8_t>(lanes[i]), n);
+                stats.Add(n);
+            }
         }
     }
+
+    return stats;
 }
 
-void Fractal::UseAVX(Colour* pixelBuffer, int yStart, int yEnd, bool useFloat)
+TileStats Fractal::UsePerturbation(const Frame& frame, const Tile& tile, int step, bool refine) const
 {
-    if (useFloat)
+    const RenderRequest& request = frame.request;
+    const RenderSettings& settings = request.settings;
+    const ReferenceOrbit& reference = *frame.reference;
+    TileStats stats = { 0, 0, request.maxIterations, 0 };
+
+    const double dx = frame.dx, dy = frame.dy;
+    const double scale = reference.scale;
+
+    // Only the rows on the grid of this pass
+    int yStart = (tile.yStart + step - 1) / step * step;
+
+    std::vector<std::pair<int, int>> glitchedPixels;
+
+    for (int y = yStart; y < tile.yEnd; y += step)
     {
-        float dx = static_cast<float>((m_xMax - m_xMin) / m_app->m_widthW);
-        float dy = static_cast<float>((m_yMax - m_yMin) / m_app->m_heightW);
-        const __m256 xShift_coeffs = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f); // Shifting coefficients values
-        __m256 yval = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(m_yMin)), _mm256_mul_ps(_mm256_set1_ps(static_cast<float>(yStart)), _mm256_set1_ps(dy))); // Setting initial yval to startin range of y
-        __m256 xShift = _mm256_mul_ps(_mm256_set1_ps(dx), xShift_coeffs); // Amount to shift x for each number we will be processing
-        __m256 dxSSE = _mm256_set1_ps(m_avxVectSizeF * dx); // Amount to change multiplied by the number of floats calculated in parallel
-        __m256 dySSE = _mm256_set1_ps(dy); // The change for y each time will be the default
+        // Rows that were on the previous grid already have every other sample
+        int xStart = tile.xStart + (refine && y % (2 * step) == 0 ? step : 0);
+        int xStep = refine && y % (2 * step) == 0 ? 2 * step : step;
+
+        // Last pixel of the row on this grid, the lanes after it repeat it
+        int xLast = tile.xEnd - 1 - (tile.xEnd - 1 - xStart) % xStep;
 
-        for (int y = yStart; y < yEnd; ++y)
+        // Offsets to the reference are taken from the centre of the view in double, then scaled
+        // and rounded to float
+        __m256 dcy[m_maxInterleave];
+        std::fill_n(dcy, m_maxInterleave, _mm256_set1_ps(static_cast<float>(((y - 0.5 * request.height) * dy - reference.oy) / scale)));
+
+        for (int x = xStart; x < tile.xEnd;)
         {
-            __m256 xval = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(m_xMin)), xShift); // Initial x values for first floats
+            // The chain of a step is longer than the plain kernels', every vector the rest of the
+            // row allows is iterated together whatever the interleave
+            int vectors = std::min(m_maxInterleave, (xLast - x) / (m_avxVectSizeF * xStep) + 1);
+
+            __m256 dcx[m_maxInterleave];
+            for (int k = 0; k < vectors; ++k)
+            {
+                alignas(32) float xs[8];
+                LaneCoordinates(xs, m_avxVectSizeF, x + k * m_avxVectSizeF * xStep, xStep, xLast,
+                    (-0.5 * request.width * dx - reference.ox) / scale, dx / scale);
+                dcx[k] = _mm256_load_ps(xs);
+            }
 
-            for (int x = 0; x < m_app->m_widthW; x += m_avxVectSizeF) // Increase by the amount of floats being processed each time
+            __m256i iter[m_maxInterleave];
+            __m256 glitched[m_maxInterleave];
+            GetAVXIterPerturb(reference, dcx, dcy, iter, glitched, vectors, request.maxIterations, settings.fma);
+
+            for (int k = 0; k < vectors; ++k, x += m_avxVectSizeF * xStep)
             {
-                __m256i N = GetAVXIterF(xval, yval); // Calculate amount of iterations for the floats
+                int glitches = _mm256_movemask_ps(glitched[k]);
 
-                int* N_int = (int*)(&N); // Pointer to the number of iterations
-                int pixel_i = y * m_app->m_widthW + x; // Current pixel index
+                int16_t lanes[8];
+                LaneValues(iter[k], lanes, m_avxVectSizeF);
 
-                // Colour the pixels that are loaded
-                for (int i = 0; i < m_avxVectSizeF; ++i, ++pixel_i)
+                // Colour the pixels that are inside the row
+                for (int i = 0, pixel_x = x; i < m_avxVectSizeF && pixel_x < tile.xEnd; ++i, pixel_x += xStep)
                 {
-                    uint8_t n = (uint8_t)(N_int[i]); // Changing the pointer to unsigned int
-                    MapColour(&pixelBuffer[pixel_i], n);
-                }
+                    if (glitches & (1 << i))
+                    {
+                        glitchedPixels.push_back({ pixel_x, y });
+                        continue;
+                    }
 
-                xval = _mm256_add_ps(xval, dxSSE); // Updating the x values
+                    int n = LaneIterations(lanes[i]);
+                    StorePixel(frame, pixel_x, y, static_cast<uint8_t>(lanes[i]), n);
+                    stats.Add(n);
+                }
             }
-
-            yval = _mm256_add_ps(yval, dySSE); // Updating the y value
         }
+
     }
-    else
+
+    RenderGlitches(frame, glitchedPixels, stats);
+    return stats;
+}
+
+void Fractal::RenderGlitches(const Frame& frame, std::vector<std::pair<int, int>>& pixels, TileStats& stats) const
+{
+    const RenderRequest& request = frame.request;
+    const RenderSettings& settings = request.settings;
+    const int batch = m_maxInterleave * m_avxVectSizeF;
+
+    while (!pixels.empty())
     {
-        double dx = (m_xMax - m_xMin) / static_cast<double>(m_app->m_widthW);
-        double dy = (m_yMax - m_yMin) / static_cast<double>(m_app->m_heightW);
-        const __m256d xShift_coeffs = _mm256_set_pd(3.0, 2.0, 1.0, 0.0); // Shifting coefficients values
-        __m256d yval = _mm256_add_pd(_mm256_set1_pd(m_yMin), _mm256_mul_pd(_mm256_set1_pd(yStart), _mm256_set1_pd(dy))); // Setting initial yval to startin range of y
-        __m256d xShift = _mm256_mul_pd(_mm256_set1_pd(dx), xShift_coeffs); // Amount to shift x for each number we will be processing
-        __m256d dxSSE = _mm256_set1_pd(m_avxVectSizeD * dx); // Amount to change multiplied by the number of floats calculated in parallel
-        __m256d dySSE = _mm256_set1_pd(dy); // The change for y each time will be the default
+        // The glitched pixel nearest the middle of the others, so the new reference is inside a
+        // glitch region and serves most of it
+        double xMean = 0.0, yMean = 0.0;
+        for (const auto& pixel : pixels)
+        {
+            xMean += pixel.first;
+            yMean += pixel.second;
+        }
+        xMean /= pixels.size();
+        yMean /= pixels.size();
+
+        size_t picked = 0;
+        double nearest = DBL_MAX;
+        for (size_t g = 0; g < pixels.size(); ++g)
+        {
+            double distance = (pixels[g].first - xMean) * (pixels[g].first - xMean) + (pixels[g].second - yMean) * (pixels[g].second - yMean);
+            if (distance < nearest)
+            {
+                nearest = distance;
+                picked = g;
+            }
+        }
 
-        for (int y = yStart; y < yEnd; ++y)
+        const std::pair<int, int> at = pixels[picked];
+        const ReferenceOrbit reference = MakeReference(request, (at.first - 0.5 * request.width) * frame.dx, (at.second - 0.5 * request.height) * frame.dy);
+        const double scale = reference.scale;
+
+        // Every pixel left is iterated against the new reference, 8 to a vector whatever their rows
+        // The lanes past the last one repeat it
+        size_t kept = 0;
+        for (size_t g = 0; g < pixels.size(); g += batch)
         {
-            __m256d xval = _mm256_add_pd(_mm256_set1_pd(m_xMin), xShift); // Initial x values for first floats
+            size_t count = std::min(pixels.size() - g, static_cast<size_t>(batch));
+            int vectors = static_cast<int>((count + m_avxVectSizeF - 1) / m_avxVectSizeF);
+
+            __m256 dcx[m_maxInterleave], dcy[m_maxInterleave];
+            for (int k = 0; k < vectors; ++k)
+            {
+                alignas(32) float xs[8], ys[8];
+                for (int i = 0; i < m_avxVectSizeF; ++i)
+                {
+                    const std::pair<int, int>& pixel = pixels[g + std::min(static_cast<size_t>(k * m_avxVectSizeF + i), count - 1)];
+                    xs[i] = static_cast<float>(((pixel.first - 0.5 * request.width) * frame.dx - reference.ox) / scale);
+                    ys[i] = static_cast<float>(((pixel.second - 0.5 * request.height) * frame.dy - reference.oy) / scale);
+                }
+                dcx[k] = _mm256_load_ps(xs);
+                dcy[k] = _mm256_load_ps(ys);
+            }
 
-            for (int x = 0; x < m_app->m_widthW; x += m_avxVectSizeD) // Increase by the amount of floats being processed each time
+            __m256i iter[m_maxInterleave];
+            __m256 glitched[m_maxInterleave];
+            GetAVXIterPerturb(reference, dcx, dcy, iter, glitched, vectors, request.maxIterations, settings.fma);
+
+            int16_t lanes[m_maxInterleave * 8];
+            uint32_t glitches = 0;
+            for (int k = 0; k < vectors; ++k)
             {
-                __m256i N = GetAVXIterD(xval, yval); // Calculate amount of iterations for the floats
+                LaneValues(iter[k], &lanes[k * m_avxVectSizeF], m_avxVectSizeF);
+                glitches |= static_cast<uint32_t>(_mm256_movemask_ps(glitched[k])) << (k * m_avxVectSizeF);
+            }
 
-                int* N_int = (int*)(&N); // Pointer to the number of iterations
-                int pixel_i = y * m_app->m_widthW + x; // Current pixel index
+            for (size_t i = 0; i < count; ++i)
+            {
+                const std::pair<int, int> pixel = pixels[g + i];
 
-                // Colour the pixels that are loaded
-                for (int i = 0; i < m_avxVectSizeD; ++i, ++pixel_i)
+                // Still glitched, kept for a reference of its own region
+                // The pixel the reference was picked at is always taken, its offset to the reference
+                // is under an ulp, so its count is the reference's own
+                if (glitches & (1u << i))
                 {
-                    uint8_t n = (uint8_t)(N_int[i]); // Changing the pointer to unsigned int
-                    MapColour(&pixelBuffer[pixel_i], n);
+                    if (g + i != picked)
+                    {
+                        pixels[kept++] = pixel;
+                        continue;
+                    }
+                    lanes[i] = static_cast<int16_t>(-static_cast<int>(reference.zx.size()));
                 }
 
-                xval = _mm256_add_pd(xval, dxSSE); // Updating the x values
+                int n = LaneIterations(lanes[i]);
+                StorePixel(frame, pixel.first, pixel.second, static_cast<uint8_t>(lanes[i]), n);
+                stats.Add(n);
             }
+        }
+        pixels.resize(kept);
+    }
+}
+
+bool Fractal::GetReferenceOrbit(double /*cx*/, double /*cy*/, int /*maxIterations*/, std::vector<float>& /*zx*/, std::vector<float>& /*zy*/) const
+{
+    return false;
+}
+
+void Fractal::GetAVXIterPerturb(const ReferenceOrbit& /*orbit*/, const __m256* /*dcx*/, const __m256* /*dcy*/, __m256i* n, __m256* glitched, int vectors, int /*maxIterations*/, bool /*fma*/) const
+{
+    // Every pixel is rendered again in double
+    for (int k = 0; k < vectors; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        glitched[k] = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    }
+}
+
+bool Fractal::UsesReference(const RenderRequest& request) const
+{
+    // Views double can still resolve, the mid depths of about 1e-6 to 1e-13 wide, are left to the
+    // plain kernels on purpose
+    // Measured, a perturbed step in float costs per lane what a plain step in double does, and the
+    // glitches cost more on top, so perturbation only pays where double runs out of precision
+    bool avx = request.settings.language == ID_LANGUAGE_AVX || request.settings.language == ID_LANGUAGE_AVX_MT;
+    return request.settings.perturbation && avx &&
+        !TileResolves(MakeFrame(request, nullptr, nullptr), { 0, 0, request.width, request.height }, 52);
+}
+
+ReferenceOrbit Fractal::MakeReference(const RenderRequest& request, double offsetX, double offsetY) const
+{
+    const Viewport& view = request.view;
+    ReferenceOrbit reference{};
+
+    // The orbit is of the nearest double to the point, its offset is taken exactly
+    reference.cx = (view.cx + FixedPoint(offsetX)).ToDouble();
+    reference.cy = (view.cy + FixedPoint(offsetY)).ToDouble();
+
+    if (!GetReferenceOrbit(reference.cx, reference.cy, request.maxIterations, reference.zx, reference.zy))
+    {
+        return {};
+    }
+
+    reference.ox = (FixedPoint(reference.cx) - view.cx).ToDouble();
+    reference.oy = (FixedPoint(reference.cy) - view.cy).ToDouble();
+
+    // Offsets are at most the size of the view
+    reference.scale = std::ldexp(1.0, std::ilogb(std::max(view.Width(), view.Height())));
+
+    // Worked out once here rather than on every step of every pixel
+    reference.glitchR.resize(reference.zx.size());
+    for (size_t i = 0; i < reference.zx.size(); ++i)
+    {
+        reference.glitchR[i] = m_glitchTolerance * (reference.zx[i] * reference.zx[i] + reference.zy[i] * reference.zy[i]);
+    }
+
+    return reference;
+}
 
-            yval = _mm256_add_pd(yval, dySSE); // Updating the y value
+ReferenceOrbit Fractal::PickReference(const RenderRequest& request) const
+{
+    const Viewport& view = request.view;
+
+    // Offsets from the centre of the view, the centre first then a grid over the view
+    const double width = view.Width(), height = view.Height();
+    std::vector<std::pair<double, double>> candidates = { { 0.0, 0.0 } };
+    for (int j = 0; j < m_referenceGrid; ++j)
+    {
+        for (int i = 0; i < m_referenceGrid; ++i)
+        {
+            candidates.push_back({ width * ((i + 0.5) / m_referenceGrid - 0.5), height * ((j + 0.5) / m_referenceGrid - 0.5) });
+        }
+    }
+
+    ReferenceOrbit best{};
+    for (const auto& candidate : candidates)
+    {
+        ReferenceOrbit reference = MakeReference(request, candidate.first, candidate.second);
+        if (reference.zx.empty())
+        {
+            // No perturbation kernel, double tiles render as they always have
+            return {};
+        }
+
+        if (reference.zx.size() > best.zx.size())
+        {
+            best = std::move(reference);
         }
+
+        // An orbit that never escapes serves every pixel
+        if (static_cast<int>(best.zx.size()) >= request.maxIterations)
+        {
+            break;
+        }
+    }
+
+    return best;
+}
+
+void Fractal::UpdateReference(const RenderRequest& request)
+{
+    if (!UsesReference(request))
+    {
+        m_reference = {};
+        return;
+    }
+
+    // The reference of this view is already picked
+    if (!m_reference.zx.empty() && request.view == m_referenceView)
+    {
+        return;
+    }
+
+    m_reference = PickReference(request);
+    m_referenceView = request.view;
+}
+
+void Fractal::LaneValues(__m128i n, int16_t* lanes, int count)
+{
+    alignas(16) int16_t words[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(words), n);
+
+    // First word of each lane
+    for (int i = 0; i < count; ++i)
+    {
+        lanes[i] = words[i * 8 / count];
+    }
+}
+
+void Fractal::LaneValues(__m256i n, int16_t* lanes, int count)
+{
+    alignas(32) int16_t words[16];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(words), n);
+
+    // First word of each lane
+    for (int i = 0; i < count; ++i)
+    {
+        lanes[i] = words[i * 16 / count];
+    }
+}
+
+void Fractal::GetAVXIterFN(const __m256* xval, __m256 yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    for (int k = 0; k < interleave; ++k)
+    {
+        n[k] = GetAVXIterF(xval[k], yval, maxIterations, fma);
+    }
+}
+
+void Fractal::GetAVXIterDN(const __m256d* xval, __m256d yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    for (int k = 0; k < interleave; ++k)
+    {
+        n[k] = GetAVXIterD(xval[k], yval, maxIterations, fma);
     }
 }
 
-void Fractal::MapColour(Colour* pixelBuffer, uint8_t n)
+void Fractal::MapColour(Colour* pixelBuffer, uint8_t n, UINT gradient)
 {
     // Color mapping for points outside of the set
     // The gradient depends on the menu option
 
-    UINT gradient = m_app->GetGradient();
-
     switch (gradient)
     {
     case ID_GRADIENT_1:
@@ -269,256 +653,1193 @@ void Fractal::MapColour(Colour* pixelBuffer, uint8_t n)
     } // Switch
 }
 
-void Fractal::Render(Colour* pixelBuffer)
+void Fractal::StorePixel(const Frame& frame, int x, int y, uint8_t index, int iterations)
 {
-    // Dynamically changing from float to double when resolution gets low
-    bool useDouble = m_yMax - m_yMin < m_floatToDouble;
+    uint8_t* pixel = frame.origin + static_cast<size_t>(y - frame.region.yStart) * frame.request.stride +
+        static_cast<size_t>(x - frame.region.xStart) * frame.pixelBytes;
 
-    UINT language = m_app->GetLanguage();
+    if (frame.request.format == PixelFormat::Iterations)
+    {
+        uint16_t n = static_cast<uint16_t>(iterations);
+        memcpy(pixel, &n, sizeof(n));
+    }
+    else
+    {
+        ColourPixel(pixel, frame.request.format, index, frame.request.gradient);
+    }
+}
+
+void Fractal::ColourPixel(uint8_t* pixel, PixelFormat format, uint8_t index, UINT gradient)
+{
+    switch (format)
+    {
+    case PixelFormat::BGRA:
+    {
+        MapColour(reinterpret_cast<Colour*>(pixel), index, gradient);
+        break;
+    }
+    case PixelFormat::RGBA:
+    {
+        Colour colour{};
+        MapColour(&colour, index, gradient);
+        pixel[0] = colour.b;
+        pixel[1] = colour.g;
+        pixel[2] = colour.r;
+        pixel[3] = colour.a;
+        break;
+    }
+    case PixelFormat::RGB:
+    {
+        Colour colour{};
+        MapColour(&colour, index, gradient);
+        pixel[0] = colour.b;
+        pixel[1] = colour.g;
+        pixel[2] = colour.r;
+        break;
+    }
+    case PixelFormat::Index:
+    {
+        *pixel = index;
+        break;
+    }
+    default:
+    {
+        break;
+    }
+    } // Switch
+}
 
+uint8_t Fractal::GradientIndex(UINT language, int iterations)
+{
+    // The same split as SelectLanguage
     switch (language)
     {
-    // Use multithreading
-    case ID_LANGUAGE_CPP_MT:
+    case ID_LANGUAGE_SSE:
     case ID_LANGUAGE_SSE_MT:
+    case ID_LANGUAGE_AVX:
     case ID_LANGUAGE_AVX_MT:
     {
-        int numThreads;
-        int cores = std::thread::hardware_concurrency(); // Number of available CPU cores
-        if (ID_LANGUAGE_AVX_MT == language)
-        {
-            // Hard coded value that actually speeds up AVX Multithreaded
-            // Using to many cores is uncessary and slows it down, 8 is perfect
-            numThreads = cores < 8 ? cores : 8;
-        }
-        else
+        return static_cast<uint8_t>(-iterations);
+    }
+    default:
+    {
+        return static_cast<uint8_t>(iterations);
+    }
+    } // Switch
+}
+
+int Fractal::PixelBytes(PixelFormat format)
+{
+    switch (format)
+    {
+    case PixelFormat::Index:
+    {
+        return 1;
+    }
+    case PixelFormat::Iterations:
+    {
+        return 2;
+    }
+    case PixelFormat::RGB:
+    {
+        return 3;
+    }
+    default:
+    {
+        return 4;
+    }
+    } // Switch
+}
+
+std::vector<Tile> Fractal::MakeTiles(const RenderRequest& request)
+{
+    const int tileWidth = request.settings.tileWidth, tileHeight = request.settings.tileHeight;
+    const Tile region = RequestRegion(request);
+
+    std::vector<Tile> tiles;
+    for (int y = region.yStart; y < region.yEnd; y += tileHeight)
+    {
+        for (int x = region.xStart; x < region.xEnd; x += tileWidth)
         {
-            numThreads = cores;
+            tiles.push_back({
+                x,
+                y,
+                x + tileWidth < region.xEnd ? x + tileWidth : region.xEnd,
+                y + tileHeight < region.yEnd ? y + tileHeight : region.yEnd });
         }
+    }
 
-        int stripHeight = m_app->m_heightW / numThreads;
-        std::vector<std::thread> threads;
+    return tiles;
+}
 
-        // Assign a thread to each strip
-        for (int i = 0; i < numThreads; ++i) {
-            int yStart = i * stripHeight;
+Tile Fractal::RequestRegion(const RenderRequest& request)
+{
+    const Tile& region = request.region;
+    if (region.xEnd <= region.xStart || region.yEnd <= region.yStart)
+    {
+        return { 0, 0, request.width, request.height };
+    }
 
-            if (useDouble)
-            {
-                switch (language)
-                {
-                case ID_LANGUAGE_CPP_MT:
-                {
-                    threads.emplace_back(std::bind(
-                        &Fractal::UseCPP,
-                        this,
-                        pixelBuffer,
-                        yStart,
-                        yStart + stripHeight,
-                        false));
-                    break;
-                }
-                case ID_LANGUAGE_SSE_MT:
-                {
-                    threads.emplace_back(std::bind(
-                        &Fractal::UseSSE,
-                        this,
-                        pixelBuffer,
-                        yStart,
-                        yStart + stripHeight,
-                        false));
-                    break;
-                }
-                case ID_LANGUAGE_AVX_MT:
-                {
-                    threads.emplace_back(std::bind(
-                        &Fractal::UseAVX,
-                        this,
-                        pixelBuffer,
-                        yStart,
-                        yStart + stripHeight,
-                        false));
-                    break;
-                }
-                } // Switch
-            }
-            else
-            {
-                switch (language)
-                {
-                case ID_LANGUAGE_CPP_MT:
-                {
-                    threads.emplace_back(std::bind(
-                        &Fractal::UseCPP,
-                        this,
-                        pixelBuffer,
-                        yStart,
-                        yStart + stripHeight,
-                        true));
-                    break;
-                }
-                case ID_LANGUAGE_SSE_MT:
-                {
-                    threads.emplace_back(std::bind(
-                        &Fractal::UseSSE,
-                        this,
-                        pixelBuffer,
-                        yStart,
-                        yStart + stripHeight,
-                        true));
-                    break;
-                }
-                case ID_LANGUAGE_AVX_MT:
+    return region;
+}
+
+RenderRequest Fractal::MakeRequest(const RenderSettings& settings) const
+{
+    // The window's buffer, tightly packed
+    const int width = m_host->m_widthW, height = m_host->m_heightW;
+    return {
+        m_view,
+        width,
+        height,
+        0,
+        0,
+        width * sizeof(Colour),
+        PixelFormat::BGRA,
+        m_maxIterations,
+        m_host->GetGradient(),
+        settings,
+        m_forceDouble,
+        {} };
+}
+
+Fractal::Frame Fractal::MakeFrame(const RenderRequest& request, void* buffer, const ReferenceOrbit* reference)
+{
+    const Tile region = RequestRegion(request);
+    const int pixelBytes = PixelBytes(request.format);
+    uint8_t* origin = buffer ?
+        static_cast<uint8_t*>(buffer) + request.top * request.stride + static_cast<size_t>(request.left) * pixelBytes : nullptr;
+
+    // Bounds of the kernels, from the exact view every time so they never drift
+    const double cx = request.view.cx.ToDouble(), cy = request.view.cy.ToDouble();
+    const double width = request.view.Width(), height = request.view.Height();
+    const double xMin = cx - width / 2, xMax = cx + width / 2;
+    const double yMin = cy - height / 2, yMax = cy + height / 2;
+
+    return {
+        request,
+        region,
+        origin,
+        pixelBytes,
+        xMin,
+        yMin,
+        (xMax - xMin) / static_cast<double>(request.width),
+        (yMax - yMin) / static_cast<double>(request.height),
+        reference };
+}
+
+bool Fractal::HasFMA()
+{
+    // Checked once, leaf 1 of CPUID has the FMA3 flag in bit 12 of ECX
+    static const bool hasFMA = []
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 12)) != 0;
+#else
+        return __builtin_cpu_supports("fma") != 0;
+#endif
+    }();
+
+    return hasFMA;
+}
+
+bool Fractal::HasAVX2()
+{
+    // Checked once, leaf 7 of CPUID has the AVX2 flag in bit 5 of EBX
+    static const bool hasAVX2 = []
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }();
+
+    return hasAVX2;
+}
+
+bool Fractal::UsesFloat() const
+{
+    // Only the view, size and precision of the request matter
+    const RenderRequest request = MakeRequest({});
+    return TileUsesFloat(MakeFrame(request, nullptr, nullptr), { 0, 0, request.width, request.height });
+}
+
+bool Fractal::TileUsesFloat(const Frame& frame, const Tile& tile) const
+{
+    return !frame.request.forceDouble && TileResolves(frame, tile, 23);
+}
+
+bool Fractal::TileResolves(const Frame& frame, const Tile& tile, int mantissaBits) const
+{
+    const double dx = frame.dx, dy = frame.dy;
+
+    // Largest coordinate on the tile, the ulp grows with it
+    double xFar = std::max(std::abs(frame.xMin + tile.xStart * dx), std::abs(frame.xMin + tile.xEnd * dx));
+    double yFar = std::max(std::abs(frame.yMin + tile.yStart * dy), std::abs(frame.yMin + tile.yEnd * dy));
+    double magnitude = std::max({ xFar, yFar, static_cast<double>(FLT_MIN) });
+
+    // Spacing between two numbers of the type at that magnitude
+    double ulp = std::ldexp(1.0, std::ilogb(magnitude) - mantissaBits);
+
+    return std::min(dx, dy) >= m_floatSpacingUlps * ulp;
+}
+
+RenderSettings Fractal::GetSettings() const
+{
+    RenderSettings settings = { m_host->GetLanguage(), 0, m_tileSize, m_tileSize, false, 0, true, true, false };
+
+    if (m_forcedSettings)
+    {
+        settings = *m_forcedSettings;
+    }
+    else if (const TuningProfile::Entry* entry = m_host->GetTuningProfile().Find(GetName(), UsesFloat()))
+    {
+        // The tuned threads and tiles only apply to the backend they were tuned for
+        if (settings.language == ID_LANGUAGE_AUTO || settings.language == entry->settings.language)
+        {
+            settings = entry->settings;
+        }
+    }
+
+    // Pinning and perturbation are choices of the user, not something that is tuned
+    if (!m_forcedSettings)
+    {
+        settings.pinThreads = m_host->GetPinThreads();
+        settings.perturbation = m_host->GetPerturbation();
+    }
+
+    return ResolveSettings(settings);
+}
+
+RenderSettings Fractal::ResolveSettings(RenderSettings settings) const
+{
+    // Untuned machines fall back on the fastest backend
+    if (settings.language == ID_LANGUAGE_AUTO)
+    {
+        settings.language = ID_LANGUAGE_AVX_MT;
+    }
+
+    // The SIMD kernels of some fractals are not written yet, they would draw one flat colour
+    // Profiles and requests may also come from a machine with AVX2 when this one has none
+    if (!HasSIMDKernels() || !HasAVX2())
+    {
+        switch (settings.language)
+        {
+        case ID_LANGUAGE_SSE:
+        case ID_LANGUAGE_AVX:
+        {
+            settings.language = ID_LANGUAGE_CPP;
+            break;
+        }
+        case ID_LANGUAGE_SSE_MT:
+        case ID_LANGUAGE_AVX_MT:
+        {
+            settings.language = ID_LANGUAGE_CPP_MT;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+        } // Switch
+    }
+
+    if (settings.threads <= 0)
+    {
+        settings.threads = DefaultThreads(settings.language);
+    }
+
+    if (settings.interleave <= 0 || settings.interleave > m_maxInterleave)
+    {
+        settings.interleave = m_defaultInterleave;
+    }
+
+    // Profiles, forced settings and requests may come from a machine without FMA3
+    settings.fma = settings.fma && HasFMA();
+
+    // Square tiles unless a shape was given
+    if (settings.tileWidth <= 0 || settings.tileHeight <= 0)
+    {
+        settings.tileWidth = m_tileSize;
+        settings.tileHeight = m_tileSize;
+    }
+
+    return settings;
+}
+
+Fractal::UseFunction Fractal::SelectLanguage(UINT language)
+{
+    switch (language)
+    {
+    case ID_LANGUAGE_SSE:
+    case ID_LANGUAGE_SSE_MT:
+    {
+        return &Fractal::UseSSE;
+    }
+    case ID_LANGUAGE_AVX:
+    case ID_LANGUAGE_AVX_MT:
+    {
+        return &Fractal::UseAVX;
+    }
+    default:
+    {
+        return &Fractal::UseCPP;
+    }
+    } // Switch
+}
+
+int Fractal::DefaultThreads(UINT language)
+{
+    switch (language)
+    {
+    // Use multithreading
+    case ID_LANGUAGE_CPP_MT:
+    case ID_LANGUAGE_SSE_MT:
+    case ID_LANGUAGE_AVX_MT:
+    {
+        int numThreads;
+        int cores = std::thread::hardware_concurrency(); // Number of available CPU cores
+        if (ID_LANGUAGE_AVX_MT == language)
+        {
+            // Hard coded value that actually speeds up AVX Multithreaded on the author's machine
+            // Only used until Autotune has found the best count for this machine
+            numThreads = cores < 8 ? cores : 8;
+        }
+        else
+        {
+            numThreads = cores;
+        }
+
+        return numThreads > 1 ? numThreads : 1;
+    }
+    default:
+    {
+        return 1;
+    }
+    } // Switch
+}
+
+void Fractal::RunWorkers(const std::function<void(int)>& worker, int numThreads, bool pinThreads, bool background)
+{
+    if (numThreads > 1)
+    {
+        std::vector<Topology::Processor> processors;
+        if (pinThreads)
+        {
+            processors = Topology::Get().WorkerProcessors(numThreads);
+        }
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&worker, &processors, background, i]()
                 {
-                    threads.emplace_back(std::bind(
-                        &Fractal::UseAVX,
-                        this,
-                        pixelBuffer,
-                        yStart,
-                        yStart + stripHeight,
-                        true));
-                    break;
-                }
-                } // Switch
-            }
+                    if (!processors.empty())
+                    {
+                        Topology::Pin(processors[i]);
+                    }
+
+                    if (background)
+                    {
+                        Topology::LowerPriority();
+                    }
+
+                    worker(i);
+                });
         }
 
         // Wait for all threads to complete
         for (auto& t : threads) {
             t.join();
         }
+    }
+    else
+    {
+        worker(0);
+    }
+}
 
-        break;
+std::vector<int> Fractal::WorkerNodes(const RenderSettings& settings)
+{
+    std::vector<int> nodes(settings.threads > 0 ? settings.threads : 1, 0);
+    if (!settings.pinThreads || settings.threads <= 1)
+    {
+        return nodes;
     }
-    case ID_LANGUAGE_CPP:
-    case ID_LANGUAGE_SSE:
-    case ID_LANGUAGE_AVX:
+
+    // The processors RunWorkers pins to, grouped by node
+    const std::vector<Topology::Processor> processors = Topology::Get().WorkerProcessors(settings.threads);
+    for (int i = 1; i < settings.threads; ++i)
+    {
+        nodes[i] = nodes[i - 1] + (processors[i].node != processors[i - 1].node ? 1 : 0);
+    }
+
+    return nodes;
+}
+
+std::vector<int> Fractal::WorkerTileRows(int tileRows, int workers)
+{
+    std::vector<int> bands(workers + 1);
+    for (int i = 0; i <= workers; ++i)
+    {
+        bands[i] = static_cast<int>(static_cast<long long>(tileRows) * i / workers);
+    }
+
+    return bands;
+}
+
+void Fractal::FinishFrame(const RenderRequest& request)
+{
+    m_lastFrameStats = m_tileStats;
+    m_lastFrameView = request.view;
+    m_lastFrameSettings = request.settings;
+    m_lastFrameWidth = request.width;
+    m_lastFrameHeight = request.height;
+    m_lastFrameColumns = (m_lastFrameWidth + request.settings.tileWidth - 1) / request.settings.tileWidth;
+}
+
+bool Fractal::LastFrameMatches(const std::vector<Tile>& tiles) const
+{
+    if (tiles.empty() || tiles.size() != m_lastFrameStats.size() ||
+        m_host->m_widthW != m_lastFrameWidth || m_host->m_heightW != m_lastFrameHeight)
+    {
+        return false;
+    }
+
+    // Tiles are in rows, the first row is the columns of the grid
+    int columns = 0;
+    while (columns < static_cast<int>(tiles.size()) && tiles[columns].yStart == tiles[0].yStart)
     {
-        if (useDouble)
+        ++columns;
+    }
+
+    return columns == m_lastFrameColumns;
+}
+
+std::vector<double> Fractal::PredictTileCosts(const std::vector<Tile>& tiles, bool refine) const
+{
+    const std::vector<TileStats>& source = refine ? m_tileStats : m_lastFrameStats;
+    if (source.empty() || (refine && source.size() != tiles.size()) || (!refine && !LastFrameMatches(tiles)))
+    {
+        return {};
+    }
+
+    // Tiles without samples (or off the old frame) are assumed to cost the mean of the frame
+    long long iterations = 0, samples = 0;
+    for (const auto& stats : source)
+    {
+        iterations += stats.iterations;
+        samples += stats.samples;
+    }
+
+    if (!samples)
+    {
+        return {};
+    }
+
+    const double mean = static_cast<double>(iterations) / samples;
+    auto density = [&source, mean](int i)
         {
-            switch (language)
-            {
-            case ID_LANGUAGE_CPP:
+            return source[i].samples ? source[i].iterations / static_cast<double>(source[i].samples) : mean;
+        };
+
+    std::vector<double> costs(tiles.size());
+
+    // The coarser passes of this frame cover the same view
+    if (refine)
+    {
+        for (int i = 0; i < static_cast<int>(tiles.size()); ++i)
+        {
+            costs[i] = density(i);
+        }
+
+        return costs;
+    }
+
+    // Map points of each tile through the change of view onto the tiles of the last frame
+    const int width = m_host->m_widthW, height = m_host->m_heightW;
+    const int tileWidth = m_lastFrameSettings.tileWidth, tileHeight = m_lastFrameSettings.tileHeight;
+    const int columns = (width + tileWidth - 1) / tileWidth;
+    const double dx = m_view.Width() / width, dy = m_view.Height() / height;
+    const double oldDx = m_lastFrameView.Width() / width, oldDy = m_lastFrameView.Height() / height;
+    const int points = 4;
+
+    // Move of the centre, exact before it is rounded
+    const double moveX = (m_view.cx - m_lastFrameView.cx).ToDouble();
+    const double moveY = (m_view.cy - m_lastFrameView.cy).ToDouble();
+
+    for (int i = 0; i < static_cast<int>(tiles.size()); ++i)
+    {
+        const Tile& tile = tiles[i];
+        double sum = 0;
+
+        for (int py = 0; py < points; ++py)
+        {
+            for (int px = 0; px < points; ++px)
             {
-                UseCPP(pixelBuffer, 0, m_app->m_heightW, false);
-                break;
+                double x = tile.xStart + (px + 0.5) * (tile.xEnd - tile.xStart) / points;
+                double y = tile.yStart + (py + 0.5) * (tile.yEnd - tile.yStart) / points;
+
+                // Pixel of the last frame at the same point of the complex plane
+                double oldX = ((x - width / 2.0) * dx + moveX) / oldDx + width / 2.0;
+                double oldY = ((y - height / 2.0) * dy + moveY) / oldDy + height / 2.0;
+
+                if (oldX >= 0 && oldX < width && oldY >= 0 && oldY < height)
+                {
+                    sum += density(static_cast<int>(oldY) / tileHeight * columns + static_cast<int>(oldX) / tileWidth);
+                }
+                else
+                {
+                    sum += mean;
+                }
             }
-            case ID_LANGUAGE_SSE:
+        }
+
+        costs[i] = sum / (points * points);
+    }
+
+    return costs;
+}
+
+double Fractal::TileSamples(const Tile& tile, int step, bool refine)
+{
+    auto samplesOnGrid = [&tile](int s)
+        {
+            return static_cast<double>((tile.xEnd - tile.xStart + s - 1) / s) * ((tile.yEnd - tile.yStart + s - 1) / s);
+        };
+
+    return samplesOnGrid(step) - (refine ? samplesOnGrid(2 * step) : 0.0);
+}
+
+bool Fractal::RenderPass(const RenderRequest& request, Colour* pixelBuffer, int step, bool refine, const std::atomic<bool>* cancel)
+{
+    // The backend, threads and tiles of the request are used for every tile
+    const RenderSettings& settings = request.settings;
+    UseFunction useLanguage = SelectLanguage(settings.language);
+
+    // Deep tiles iterate offsets to a reference orbit of this view
+    UpdateReference(request);
+    const Frame frame = MakeFrame(request, pixelBuffer, &m_reference);
+
+    std::vector<Tile> tiles = MakeTiles(request);
+
+    // A new frame starts counting iterations from scratch, refining adds to them
+    if (!refine || m_tileStats.size() != tiles.size())
+    {
+        m_tileStats.assign(tiles.size(), { 0, 0, m_maxIterations, 0 });
+    }
+
+    // Split the tiles (in rows, so neighbours stay together) into one chunk of equal predicted cost per thread
+    const int tileCount = static_cast<int>(tiles.size());
+    const int workers = settings.threads;
+    std::vector<double> predicted = workers > 1 ? PredictTileCosts(tiles, refine) : std::vector<double>();
+
+    double predictedTotal = 0;
+    for (int i = 0; i < static_cast<int>(predicted.size()); ++i)
+    {
+        predicted[i] *= TileSamples(tiles[i], step, refine);
+        predictedTotal += predicted[i];
+    }
+
+    // Without a prediction every sample is taken to cost the same
+    const bool hasPrediction = predictedTotal > 0;
+    std::vector<double> cost(tileCount);
+    for (int i = 0; i < tileCount; ++i)
+    {
+        cost[i] = hasPrediction ? predicted[i] : TileSamples(tiles[i], step, refine);
+    }
+
+    // Each chunk is handed out from its own counter, so threads only share one when stealing
+    struct alignas(64) Chunk
+    {
+        int begin;
+        int end;
+        std::atomic<int> next;
+    };
+
+    // Each node owns the tile rows its workers first wrote in PlaceBuffer, its workers split
+    // them into chunks of equal cost, chunk c is worker c's
+    const int columns = static_cast<int>(std::count_if(tiles.begin(), tiles.end(), [&tiles](const Tile& tile) { return tile.yStart == tiles[0].yStart; }));
+    const int tileRows = columns ? (tileCount + columns - 1) / columns : 0;
+    const std::vector<int> nodes = WorkerNodes(settings);
+    const std::vector<int> bands = WorkerTileRows(tileRows, workers);
+
+    const int chunkCount = workers;
+    std::vector<Chunk> chunks(chunkCount);
+
+    // Workers of one node are next to each other, nodeStart[c] is the first of chunk c's node
+    std::vector<int> nodeStart(chunkCount), nodeEnd(chunkCount);
+    for (int c = 0; c < chunkCount; ++c)
+    {
+        nodeStart[c] = c > 0 && nodes[c] == nodes[c - 1] ? nodeStart[c - 1] : c;
+    }
+    for (int c = chunkCount - 1; c >= 0; --c)
+    {
+        nodeEnd[c] = c < chunkCount - 1 && nodes[c] == nodes[c + 1] ? nodeEnd[c + 1] : c + 1;
+    }
+
+    for (int first = 0; first < chunkCount; first = nodeEnd[first])
+    {
+        const int last = nodeEnd[first];
+        const int nodeBegin = std::min(bands[first] * columns, tileCount), nodeFinish = std::min(bands[last] * columns, tileCount);
+
+        double nodeTotal = 0;
+        for (int i = nodeBegin; i < nodeFinish; ++i)
+        {
+            nodeTotal += cost[i];
+        }
+
+        double prefix = 0;
+        int begin = nodeBegin;
+        for (int c = first; c < last; ++c)
+        {
+            // The last chunk of the node takes whatever is left of its rows
+            int end = c == last - 1 ? nodeFinish : begin;
+            double target = nodeTotal * (c - first + 1) / (last - first);
+            while (end < nodeFinish && prefix + cost[end] / 2 < target)
             {
-                UseSSE(pixelBuffer, 0, m_app->m_heightW, false);
-                break;
+                prefix += cost[end++];
             }
-            case ID_LANGUAGE_AVX:
+
+            chunks[c].begin = begin;
+            chunks[c].end = end;
+            chunks[c].next = begin;
+            begin = end;
+        }
+    }
+
+    // Iterations of every tile in this pass, to check the prediction
+    std::vector<long long> passIterations(tileCount);
+
+    // Every thread works through its own chunk, then takes tiles from the other chunks of its
+    // node, and only then from the chunks of the other nodes, whose rows are remote memory
+    // Cancellation is checked before each tile so a stale render stops within one tile
+    RunWorkers([&](int worker)
+        {
+            const int first = nodeStart[worker], last = nodeEnd[worker];
+
+            for (int c = 0; c < chunkCount; ++c)
             {
-                UseAVX(pixelBuffer, 0, m_app->m_heightW, false);
-                break;
+                // Own node in turn from the worker's chunk, then the rest from the next node
+                const int local = last - first;
+                const int index = c < local ? first + (worker - first + c) % local : (last + c - local) % chunkCount;
+                Chunk& chunk = chunks[index];
+
+                for (;;)
+                {
+                    if (cancel && cancel->load(std::memory_order_relaxed))
+                    {
+                        return;
+                    }
+
+                    int i = chunk.next.fetch_add(1);
+                    if (i >= chunk.end)
+                    {
+                        break;
+                    }
+
+                    // Each tile is only touched by one thread
+                    TileStats stats = (this->*useLanguage)(frame, tiles[i], step, refine, TileUsesFloat(frame, tiles[i]));
+                    passIterations[i] = stats.iterations;
+                    m_tileStats[i].Merge(stats);
+                }
             }
-            } // Switch
+        }, settings.threads, settings.pinThreads, settings.background);
+
+    if (cancel && cancel->load())
+    {
+        return false;
+    }
+
+    // Compare the shares of the work each tile and each chunk was predicted to take with what they took
+    m_costMapReport = { 0, 0.0, 1.0 };
+    if (hasPrediction && chunkCount > 1)
+    {
+        double actualTotal = 0;
+        for (long long iterations : passIterations)
+        {
+            actualTotal += static_cast<double>(iterations);
         }
-        else
+
+        if (actualTotal > 0)
         {
-            switch (language)
+            double error = 0, largest = 0;
+            for (const auto& chunk : chunks)
             {
-            case ID_LANGUAGE_CPP:
+                double actual = 0;
+                for (int i = chunk.begin; i < chunk.end; ++i)
+                {
+                    error += fabs(predicted[i] / predictedTotal - passIterations[i] / actualTotal);
+                    actual += static_cast<double>(passIterations[i]);
+                }
+
+                largest = actual > largest ? actual : largest;
+            }
+
+            m_costMapReport = { chunkCount, error / 2, largest * chunkCount / actualTotal };
+        }
+    }
+
+    return true;
+}
+
+void Fractal::FillPass(Colour* pixelBuffer, int step)
+{
+    FillTile(pixelBuffer, { 0, 0, m_host->m_widthW, m_host->m_heightW }, step);
+}
+
+void Fractal::FillTile(Colour* pixelBuffer, const Tile& tile, int step)
+{
+    const int width = m_host->m_widthW;
+
+    for (int y = tile.yStart; y < tile.yEnd; ++y)
+    {
+        // Nearest sample is the top left corner of the block the pixel is in
+        const Colour* sampleRow = &pixelBuffer[(y - y % step) * width];
+        Colour* row = &pixelBuffer[y * width];
+
+        for (int x = tile.xStart; x < tile.xEnd; ++x)
+        {
+            // Samples on the grid are left alone, everything else is overwritten by later passes
+            if (y % step || x % step)
             {
-                UseCPP(pixelBuffer, 0, m_app->m_heightW, true);
-                break;
+                row[x] = sampleRow[x - x % step];
             }
-            case ID_LANGUAGE_SSE:
+        }
+    }
+}
+
+bool Fractal::Render(const RenderRequest& request, Colour* pixelBuffer, const std::atomic<bool>* cancel, int previewScale)
+{
+    if (!RenderPass(request, pixelBuffer, previewScale, false, cancel))
+    {
+        return false;
+    }
+
+    // Upscale the decimated grid to the full buffer
+    if (previewScale > 1)
+    {
+        FillPass(pixelBuffer, previewScale);
+    }
+
+    FinishFrame(request);
+
+    return true;
+}
+
+bool Fractal::RenderProgressive(const RenderRequest& request, Colour* pixelBuffer, const std::function<void(int)>& onPass, const std::atomic<bool>* cancel, int previewScale)
+{
+    // Coarse to fine, each pass only computes the pixels the previous passes have not
+    // So the total amount of work is the same as a single full render
+    for (int step = m_progressiveStep; step >= previewScale; step /= 2)
+    {
+        if (!RenderPass(request, pixelBuffer, step, step != m_progressiveStep, cancel))
+        {
+            return false;
+        }
+
+        if (step > 1)
+        {
+            FillPass(pixelBuffer, step);
+        }
+
+        if (step == previewScale)
+        {
+            FinishFrame(request);
+        }
+
+        if (onPass)
+        {
+            onPass(step);
+        }
+    }
+
+    return true;
+}
+
+bool Fractal::Render(const RenderRequest& request, void* buffer, const std::atomic<bool>* cancel, std::atomic<uint8_t>* tilesDone) const
+{
+    return Render(request, RequestReference(request), buffer, cancel, tilesDone);
+}
+
+ReferenceOrbit Fractal::RequestReference(const RenderRequest& request) const
+{
+    RenderRequest resolved = request;
+    resolved.settings = ResolveSettings(request.settings);
+
+    // Deep views iterate offsets to a reference orbit of the whole image
+    return UsesReference(resolved) ? PickReference(resolved) : ReferenceOrbit{};
+}
+
+bool Fractal::Render(const RenderRequest& request, const ReferenceOrbit& reference, void* buffer, const std::atomic<bool>* cancel, std::atomic<uint8_t>* tilesDone) const
+{
+    // The reference and the settings are the render's own, nothing of the fractal is written
+    RenderRequest resolved = request;
+    resolved.settings = ResolveSettings(request.settings);
+    const RenderSettings& settings = resolved.settings;
+    UseFunction useLanguage = SelectLanguage(settings.language);
+
+    const Frame frame = MakeFrame(resolved, buffer, &reference);
+
+    // Threads take the tiles in rows from the top left
+    std::vector<Tile> tiles = MakeTiles(resolved);
+    std::atomic<size_t> nextTile = 0;
+
+    RunWorkers([&](int)
+        {
+            for (;;)
             {
-                UseSSE(pixelBuffer, 0, m_app->m_heightW, true);
-                break;
+                if (cancel && cancel->load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                size_t i = nextTile.fetch_add(1);
+                if (i >= tiles.size())
+                {
+                    break;
+                }
+
+                if (tilesDone && tilesDone[i].load(std::memory_order_acquire))
+                {
+                    continue;
+                }
+
+                (this->*useLanguage)(frame, tiles[i], 1, false, TileUsesFloat(frame, tiles[i]));
+
+                if (tilesDone)
+                {
+                    tilesDone[i].store(1, std::memory_order_release);
+                }
             }
-            case ID_LANGUAGE_AVX:
+        }, settings.threads, settings.pinThreads, settings.background);
+
+    return !(cancel && cancel->load());
+}
+
+double Fractal::TileImportance(const Tile& tile, const TileStats& stats) const
+{
+    // Distance of the tile from the centre of the frame, 0 at the centre and 1 in a corner
+    double cx = (tile.xStart + tile.xEnd) / 2.0 - m_host->m_widthW / 2.0;
+    double cy = (tile.yStart + tile.yEnd) / 2.0 - m_host->m_heightW / 2.0;
+    double distance = sqrt((cx * cx + cy * cy) /
+        (m_host->m_widthW * m_host->m_widthW / 4.0 + m_host->m_heightW * m_host->m_heightW / 4.0));
+
+    double importance = 2.0 - distance;
+
+    // A spread of iterations means the tile is on the boundary of the set, where all the detail is
+    // Tiles that are entirely inside or entirely far outside hardly change when refined
+    if (stats.samples)
+    {
+        importance *= 1.0 + 4.0 * (stats.maxIterations - stats.minIterations) / static_cast<double>(m_maxIterations);
+    }
+
+    return importance;
+}
+
+double Fractal::EstimateTileIterations(const Tile& tile, const TileStats& stats, int step, bool refine) const
+{
+    // Samples on the grid of the step, less the ones the coarser level already has
+    double samples = TileSamples(tile, step, refine);
+
+    // Without any iterations seen yet assume the worst
+    double perSample = stats.samples ? stats.iterations / static_cast<double>(stats.samples) : m_maxIterations;
+
+    return perSample * samples;
+}
+
+void Fractal::BeginBudgeted(const RenderRequest& request, int previewScale)
+{
+    // Settings changed during the frame wait for the next one, the stats below are of these tiles
+    m_budgetRequest = request;
+    std::vector<Tile> tiles = MakeTiles(m_budgetRequest);
+
+    m_budgetStep = m_progressiveStep;
+    m_budgetFinalStep = previewScale;
+    m_budgetDone.assign(tiles.size(), 0);
+    m_tileStats.assign(tiles.size(), { 0, 0, m_maxIterations, 0 });
+
+    OrderBudgetLevel();
+}
+
+void Fractal::OrderBudgetLevel()
+{
+    std::vector<Tile> tiles = MakeTiles(m_budgetRequest);
+
+    // Before a tile has been sampled this frame the previous frame's iterations stand in for it
+    const bool lastFrameMatches = LastFrameMatches(tiles);
+    auto statsOf = [this, lastFrameMatches](int i) -> const TileStats&
+        {
+            if (m_tileStats[i].samples || !lastFrameMatches)
             {
-                UseAVX(pixelBuffer, 0, m_app->m_heightW, true);
-                break;
+                return m_tileStats[i];
             }
-            } // Switch
-        }
 
-        break;
+            return m_lastFrameStats[i];
+        };
+
+    std::vector<double> importance(tiles.size());
+    m_budgetOrder.clear();
+    for (int i = 0; i < static_cast<int>(tiles.size()); ++i)
+    {
+        importance[i] = TileImportance(tiles[i], statsOf(i));
+
+        if (!m_budgetDone[i])
+        {
+            m_budgetOrder.push_back(i);
+        }
     }
-    } // Switch
+
+    std::stable_sort(m_budgetOrder.begin(), m_budgetOrder.end(), [&importance](int a, int b)
+        {
+            return importance[a] > importance[b];
+        });
 }
 
-void Fractal::Draw(HDC hdc, Colour* pixelBuffer, GifWriter* gif, bool recording)
+bool Fractal::RenderBudgeted(Colour* pixelBuffer, double budgetMs, const std::atomic<bool>* cancel)
 {
-    // Define the bitmap
-    BITMAPINFO bmpInfo;
-    bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmpInfo.bmiHeader.biWidth = m_app->m_widthW;
-    bmpInfo.bmiHeader.biHeight = -m_app->m_heightW; // Negative to indicate top-down bitmap
-    bmpInfo.bmiHeader.biPlanes = 1;
-    bmpInfo.bmiHeader.biBitCount = 32; // 32 bits per pixel (COLORREF format)
-    bmpInfo.bmiHeader.biCompression = BI_RGB;
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(static_cast<long long>(budgetMs * 1000));
 
-    // Transfer the pixelBuffer to the screen
-    SetDIBitsToDevice(
-        hdc,
-        0, 0, m_app->m_widthW, m_app->m_heightW,         // Destination rectangle on the screen
-        0, 0, 0, m_app->m_heightW,             // Source rectangle in the buffer
-        pixelBuffer,                 // Pixel buffer source
-        &bmpInfo,                    // Bitmap information
-        DIB_RGB_COLORS               // Color format (RGB)
-    );
+    const RenderRequest& request = m_budgetRequest;
+    const RenderSettings& settings = request.settings;
+    UseFunction useLanguage = SelectLanguage(settings.language);
+    std::vector<Tile> tiles = MakeTiles(request);
+    const bool lastFrameMatches = LastFrameMatches(tiles);
+    UpdateReference(request);
+    const Frame frame = MakeFrame(request, pixelBuffer, &m_reference);
 
-    if (recording)
+    while (m_budgetStep >= m_budgetFinalStep)
     {
-        GifWriteFrame(gif, (uint8_t*)pixelBuffer, m_app->m_widthW, m_app->m_heightW, m_app->m_gifDelay);
+        const int step = m_budgetStep;
+        const bool refine = step != m_progressiveStep;
+
+        // Workers take the most important tile left in this level
+        // A tile is only started if its estimated cost still fits before the deadline,
+        // but the first tile of every call always runs so each frame makes progress
+        std::atomic<size_t> nextTile = 0;
+        std::atomic<bool> started = false;
+        std::atomic<bool> outOfTime = false;
+        std::atomic<long long> spentIterations = 0;
+        std::atomic<long long> spentNs = 0;
+
+        RunWorkers([&](int)
+            {
+                for (;;)
+                {
+                    if ((cancel && cancel->load(std::memory_order_relaxed)) || outOfTime)
+                    {
+                        break;
+                    }
+
+                    size_t k = nextTile.fetch_add(1);
+                    if (k >= m_budgetOrder.size())
+                    {
+                        break;
+                    }
+
+                    int i = m_budgetOrder[k];
+                    const TileStats& estimateStats = m_tileStats[i].samples || !lastFrameMatches ?
+                        m_tileStats[i] : m_lastFrameStats[i];
+                    double estimateNs = EstimateTileIterations(tiles[i], estimateStats, step, refine) * m_nsPerIteration;
+
+                    Clock::time_point start = Clock::now();
+                    if (start + std::chrono::nanoseconds(static_cast<long long>(estimateNs)) > deadline && started.exchange(true))
+                    {
+                        outOfTime = true;
+                        break;
+                    }
+                    started = true;
+
+                    TileStats stats = (this->*useLanguage)(frame, tiles[i], step, refine, TileUsesFloat(frame, tiles[i]));
+                    if (step > 1)
+                    {
+                        FillTile(pixelBuffer, tiles[i], step);
+                    }
+
+                    m_tileStats[i].Merge(stats);
+                    m_budgetDone[i] = 1;
+
+                    spentIterations += stats.iterations;
+                    spentNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                }
+            }, settings.threads, settings.pinThreads, settings.background);
+
+        // Calibrate the cost of an iteration on this machine for the next estimates
+        if (spentIterations > 0)
+        {
+            double measured = static_cast<double>(spentNs) / spentIterations;
+            m_nsPerIteration = 0.5 * m_nsPerIteration + 0.5 * measured;
+        }
+
+        if (cancel && cancel->load())
+        {
+            return false;
+        }
+
+        // Tiles left in this level wait for the next frame
+        if (std::find(m_budgetDone.begin(), m_budgetDone.end(), 0) != m_budgetDone.end())
+        {
+            OrderBudgetLevel();
+            return false;
+        }
+
+        // Every tile reached this level, move on to the next finer one
+        m_budgetStep /= 2;
+        std::fill(m_budgetDone.begin(), m_budgetDone.end(), 0);
+        OrderBudgetLevel();
+
+        if (Clock::now() >= deadline)
+        {
+            break;
+        }
     }
+
+    if (m_budgetStep < m_budgetFinalStep)
+    {
+        FinishFrame(request);
+        return true;
+    }
+
+    return false;
 }
 
-void Fractal::ZoomScreen(ZoomType zoomType)
+int Fractal::GetBudgetStep() const
 {
-    const double xRange = m_xMax - m_xMin, yRange = m_yMax - m_yMin;
-    const double midPx = (m_xMax + m_xMin) / 2, midPy = (m_yMax + m_yMin) / 2;
-    double dx = 0, dy = 0;
+    // Once every level is done the buffer is at the final step
+    if (m_budgetStep < m_budgetFinalStep)
+        return m_budgetFinalStep;
+
+    // The level being worked on is not finished yet
+    return m_budgetStep * 2;
+}
+
+CostMapReport Fractal::GetCostMapReport() const
+{
+    return m_costMapReport;
+}
+
+const std::vector<TileStats>& Fractal::GetFrameStats() const
+{
+    return m_lastFrameStats;
+}
+
+Viewport Fractal::GetViewport() const
+{
+    return m_view;
+}
+
+void Fractal::SetViewport(const Viewport& view)
+{
+    m_view = view;
+}
+
+void Fractal::ForceSettings(const std::optional<RenderSettings>& settings)
+{
+    m_forcedSettings = settings;
+}
+
+void Fractal::ForceDouble(bool forceDouble)
+{
+    m_forceDouble = forceDouble;
+}
+
+RenderRequest Fractal::GetRequest() const
+{
+    return MakeRequest(GetSettings());
+}
+
+void Fractal::PlaceBuffer(Colour* pixelBuffer)
+{
+    const RenderSettings settings = GetSettings();
+    const int width = m_host->m_widthW, height = m_host->m_heightW;
+    const int tileRows = (height + settings.tileHeight - 1) / settings.tileHeight;
+    const std::vector<int> bands = WorkerTileRows(tileRows, settings.threads);
+
+    // Worker i writes the tile rows RenderPass gives to its node first
+    RunWorkers([&](int worker)
+        {
+            int yStart = std::min(bands[worker] * settings.tileHeight, height);
+            int yEnd = std::min(bands[worker + 1] * settings.tileHeight, height);
+            memset(&pixelBuffer[yStart * width], 0, sizeof(Colour) * width * (yEnd - yStart));
+        }, settings.threads, settings.pinThreads, settings.background);
+}
+
+Viewport Fractal::ZoomedViewport(ZoomType zoomType) const
+{
+    Viewport view = m_view;
 
     // Zoom in/out according to the zoom factor
     switch (zoomType)
     {
     case ZoomType::ZOOM_IN:
     {
-        // Calculating the change in x and y
-        // Based on the zoom factor
-        dx = xRange / m_zoomFactor / 2;
-        dy = yRange / m_zoomFactor / 2;
-
+        view.Zoom(1.0 / m_zoomFactor);
         break;
     }
     case ZoomType::ZOOM_OUT:
     {
-        // Update the boundaries of the complex plane
-        // Based on the zoom factor
-        dx = xRange * m_zoomFactor / 2;
-        dy = yRange * m_zoomFactor / 2;
-
+        view.Zoom(m_zoomFactor);
         break;
     }
     } // Switch
 
-    // Updating x/y values with changes
-    m_xMin = midPx - dx;
-    m_xMax = midPx + dx;
-    m_yMin = midPy - dy;
-    m_yMax = midPy + dy;
+    return view;
 }
 
-void Fractal::MoveScreen(POINT* clickPoint)
+Viewport Fractal::MovedViewport(const POINT& clickPoint) const
 {
-    // Finding the current ranges of the window
-    const double xRange = m_xMax - m_xMin, yRange = m_yMax - m_yMin;
+    Viewport view = m_view;
 
-    // Mapping the window pos to a complex plane pos
+    // Mapping the window pos to an offset from the centre of the view
     // This will be the new center of the screen
-    double xMouse = m_xMin + (clickPoint->x / static_cast<double>(m_app->m_widthW)) * (xRange);
-    double yMouse = m_yMin + (clickPoint->y / static_cast<double>(m_app->m_heightW)) * (yRange);
-
-    // Update the boundaries of the complex plane
-    // Based on the pos of the mouse click
-    m_xMin = xMouse - xRange / 2.0;
-    m_xMax = xMouse + xRange / 2.0;
-    m_yMin = yMouse - yRange / 2.0;
-    m_yMax = yMouse + yRange / 2.0;
-}
\ No newline at end of file
+    double xOffset = (clickPoint.x / static_cast<double>(m_host->m_widthW) - 0.5) * view.Width();
+    double yOffset = (clickPoint.y / static_cast<double>(m_host->m_heightW) - 0.5) * view.Height();
+
+    view.Pan(xOffset, yOffset);
+    return view;
+}
+
+void Fractal::ZoomScreen(ZoomType zoomType)
+{
+    SetViewport(ZoomedViewport(zoomType));
+}
+
+void Fractal::MoveScreen(POINT* clickPoint)
+{
+    SetViewport(MovedViewport(*clickPoint));
+}
+
+Viewport Viewport::FromBounds(double xMin, double xMax, double yMin, double yMax)
+{
+    Viewport view{ FixedPoint((xMin + xMax) / 2), FixedPoint((yMin + yMax) / 2), 1.0, 0, (yMax - yMin) / (xMax - xMin) };
+    view.Zoom(xMax - xMin);
+    return view;
+}
+
+double Viewport::Width() const
+{
+    return std::ldexp(mantissa, exponent);
+}
+
+double Viewport::Height() const
+{
+    return Width() * aspect;
+}
+
+void Viewport::Zoom(double factor)
+{
+    // Only the mantissa is rounded, the exponent keeps the depth exact
+    int shift = std::ilogb(mantissa * factor);
+    mantissa = std::scalbn(mantissa * factor, -shift);
+    exponent += shift;
+}
+
+void Viewport::Pan(double xOffset, double yOffset)
+{
+    cx += FixedPoint(xOffset);
+    cy += FixedPoint(yOffset);
+}
@@ -12,24 +12,188 @@
 #pragma once
 
 #include <thread>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
-#include <Windows.h>
+#include <chrono>
 #include <functional>
+#include <optional>
 #include <immintrin.h>
 #include <emmintrin.h>
 #include "../Colour.h"
-#include "../Gif.h"
 #include "../Resource.h"
+#include "Platform.h"
+#include "RenderHost.h"
+#include "FixedPoint.h"
 
 class App;
 
+// How a frame is split up and rendered
+struct RenderSettings
+{
+    // ID_LANGUAGE_* of the backend
+    UINT language;
+    // Threads of a multithreaded backend, 0 for the default of the backend
+    int threads;
+    // Size of the tiles, multiples of twice the progressive step
+    int tileWidth;
+    int tileHeight;
+    // Pin each thread to its own processor, physical cores first
+    bool pinThreads;
+    // Vectors the AVX kernels iterate side by side (1 to 4), 0 for the default
+    int interleave;
+    // Fused multiply-add SIMD kernels, only used when the CPU has FMA3
+    bool fma;
+    // Double tiles of the AVX backends iterate float offsets to a reference orbit instead
+    // (fractals that have a perturbation kernel)
+    bool perturbation;
+    // Run the threads below normal priority, for renders nobody is waiting on yet
+    bool background;
+};
+
+// Rectangle of pixels [xStart, xEnd) x [yStart, yEnd) rendered as one unit of work
+struct Tile
+{
+    int xStart;
+    int yStart;
+    int xEnd;
+    int yEnd;
+};
+
+// Region of the complex plane shown on the window
+// An exact centre and a width of mantissa * 2^exponent, pans and zooms change them without
+// rounding the position, so a view is the same at any depth
+struct Viewport
+{
+    FixedPoint cx;
+    FixedPoint cy;
+    // Width of the view, the mantissa is in [1, 2)
+    double mantissa;
+    int exponent;
+    // Height of the view over its width
+    double aspect;
+
+    static Viewport FromBounds(double xMin, double xMax, double yMin, double yMax);
+
+    double Width() const;
+    double Height() const;
+
+    // Scale the width by a factor, the centre stays where it is
+    void Zoom(double factor);
+
+    // Move the centre by an offset
+    void Pan(double xOffset, double yOffset);
+
+    bool operator==(const Viewport& other) const = default;
+};
+
+// Iterations spent on the samples of a tile
+// Used to estimate the cost and the importance of the tile in the next frame
+struct TileStats
+{
+    long long iterations;
+    int samples;
+    int minIterations;
+    int maxIterations;
+
+    void Add(int n)
+    {
+        iterations += n;
+        ++samples;
+        minIterations = n < minIterations ? n : minIterations;
+        maxIterations = n > maxIterations ? n : maxIterations;
+    }
+
+    void Merge(const TileStats& other)
+    {
+        iterations += other.iterations;
+        samples += other.samples;
+        minIterations = other.minIterations < minIterations ? other.minIterations : minIterations;
+        maxIterations = other.maxIterations > maxIterations ? other.maxIterations : maxIterations;
+    }
+};
+
+// Orbit of one point of the view in double
+// The pixels of a perturbation render iterate their offset to it in float
+struct ReferenceOrbit
+{
+    double cx;
+    double cy;
+    // Offset of the reference to the centre of the view, the pixels take their offsets from it
+    double ox;
+    double oy;
+    // Offsets are kept divided by the scale, so they stay far above the smallest floats
+    double scale;
+    // Z of every iteration until the reference escaped, rounded to float
+    std::vector<float> zx;
+    std::vector<float> zy;
+    // |Z|^2 of every iteration times the glitch tolerance, a pixel whose |z|^2 is under it has
+    // lost the precision of its offset
+    std::vector<float> glitchR;
+};
+
+// How well the cost map of the previous frame predicted the work of the last pass
+struct CostMapReport
+{
+    // Number of chunks the tiles were split into, 0 if there was nothing to predict from
+    int chunks;
+    // Share of the iterations that were predicted on the wrong tiles, 0 is perfect and 1 is worst
+    double predictionError;
+    // Iterations of the most expensive chunk over the mean of the chunks, 1 is perfect balance
+    double chunkImbalance;
+};
+
+// Layout of the pixels a render writes
+enum class PixelFormat
+{
+    // Colour as the window's bitmap holds it, blue green red and alpha bytes
+    BGRA,
+    // The same colours as red green blue and alpha bytes, the order of most image files
+    RGBA,
+    // Red green and blue bytes without alpha (PPM and PNG rows)
+    RGB,
+    // One byte per pixel, the iterations the gradient colours
+    Index,
+    // Iterations of each pixel as 16 bits, to colour later
+    Iterations
+};
+
+// Everything one render reads, copied before it starts
+// A request does not change while it renders, so any number of them can render at once
+struct RenderRequest
+{
+    Viewport view;
+    // Size of the image
+    int width;
+    int height;
+    // The image is written to the rectangle of the caller's buffer with its top left at (left, top)
+    // Stride is the bytes from the start of one row of the buffer to the next
+    int left;
+    int top;
+    size_t stride;
+    PixelFormat format;
+    // Iterations before a point counts as inside the set
+    int maxIterations;
+    // ID_GRADIENT_* the iterations are coloured with
+    UINT gradient;
+    // Backend, threads and tiles
+    RenderSettings settings;
+    // Render in double precision whatever the zoom
+    bool forceDouble;
+    // Part of the image that is rendered, the whole image if it is empty
+    // Its pixels are those of the whole image, the buffer rectangle only holds this part
+    Tile region;
+};
+
 class Fractal
 {
 private:
-    std::shared_ptr<App> m_app;
+    // Owner of the fractal, the size of the image and the choices of the user come from it
+    std::shared_ptr<RenderHost> m_host;
 
-    double m_xMin, m_xMax, m_yMin, m_yMax;
+    // Exact view
+    Viewport m_view{};
 
 protected:
     // Fractal iterations
@@ -43,16 +207,187 @@ protected:
     // AVX uses 256 bit reg's --> fits 4 64 bit doubles, and 8 32 bit floats
     const short int m_sseVectSizeD = 2;
     const short int m_sseVectSizeF = 4;
-    const short int m_avxVectSizeD = 6;
+    const short int m_avxVectSizeD = 4;
     const short int m_avxVectSizeF = 8;
 
-    // Switching condition float --> double
-    // When resolution gets low
-    const float m_floatToDouble = 0.0001f;
+    // Interleaved AVX kernels
+    // Each vector is its own chain of dependent multiplies and adds, iterating a few of them
+    // side by side keeps the floating point units busy while each chain waits on its last result
+    static constexpr int m_maxInterleave = 4;
+    const int m_defaultInterleave = 2;
+
+    // Perturbation
+    // A pixel whose orbit comes this close to 0 relative to the reference (squared) has lost the
+    // precision of its float offset and is rendered again in double
+    const float m_glitchTolerance = 1e-3f;
+    // Grid of points (per side) tried as the reference after the centre of the view
+    const int m_referenceGrid = 4;
+
+    // Switching condition float --> double, for each tile
+    // Float is used while the pixel spacing is at least this many float ulps of the largest
+    // coordinate on the tile, so views far from the origin switch earlier than views near it
+    // Perturbation takes over from double at the same margin
+    const double m_floatSpacingUlps = 4.0;
 
     // Zoom factor
     const float m_zoomFactor = 1.5f;
 
+    // Progressive rendering
+    // First pass samples every 8th pixel, each pass after halves the spacing
+    const int m_progressiveStep = 8;
+
+    // Size of the square tiles the frame is split into, unless the tuning profile has a better shape
+    // Must be a multiple of twice the progressive step
+    const int m_tileSize = 64;
+
+private:
+    // Iterations of every tile in the frame being rendered and in the last finished frame
+    std::vector<TileStats> m_tileStats;
+    std::vector<TileStats> m_lastFrameStats;
+    // View and tiles of the last finished frame, to map its tiles onto the next view
+    Viewport m_lastFrameView{};
+    RenderSettings m_lastFrameSettings{};
+    // Size and tile columns of the last finished frame, its stats index tiles of that grid only
+    int m_lastFrameWidth{};
+    int m_lastFrameHeight{};
+    int m_lastFrameColumns{};
+
+    // Cost map partitioning of the last pass
+    CostMapReport m_costMapReport{};
+
+    // Deadline rendering
+    // Tiles are refined one level (step) at a time, most important tiles first
+    int m_budgetStep{};
+    int m_budgetFinalStep = 1;
+    std::vector<int> m_budgetOrder;
+    std::vector<char> m_budgetDone;
+    // Request of the frame, taken once so every call renders the same tiles with the same backend
+    RenderRequest m_budgetRequest{};
+    // Measured time one thread takes for one iteration, calibrated while rendering
+    double m_nsPerIteration = 1.0;
+
+    // Reference orbit of perturbation renders and the view it was picked for
+    ReferenceOrbit m_reference{};
+    Viewport m_referenceView{};
+
+    // Settings used instead of the menu and the tuning profile (by the autotuner)
+    std::optional<RenderSettings> m_forcedSettings;
+    // Render in double precision whatever the zoom
+    bool m_forceDouble{};
+
+protected:
+    // Fused multiply-add helpers of the SIMD kernels
+    // Without FMA they are the multiply and the add the kernels have always done, rounded twice
+    // a * b + c
+    template<bool Fma>
+    TARGET_AVX2 static __m128 MulAdd(__m128 a, __m128 b, __m128 c)
+    {
+        if constexpr (Fma) return _mm_fmadd_ps(a, b, c);
+        else return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m128d MulAdd(__m128d a, __m128d b, __m128d c)
+    {
+        if constexpr (Fma) return _mm_fmadd_pd(a, b, c);
+        else return _mm_add_pd(_mm_mul_pd(a, b), c);
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m256 MulAdd(__m256 a, __m256 b, __m256 c)
+    {
+        if constexpr (Fma) return _mm256_fmadd_ps(a, b, c);
+        else return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m256d MulAdd(__m256d a, __m256d b, __m256d c)
+    {
+        if constexpr (Fma) return _mm256_fmadd_pd(a, b, c);
+        else return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+    }
+
+    // a * b - c
+    template<bool Fma>
+    TARGET_AVX2 static __m128 MulSub(__m128 a, __m128 b, __m128 c)
+    {
+        if constexpr (Fma) return _mm_fmsub_ps(a, b, c);
+        else return _mm_sub_ps(_mm_mul_ps(a, b), c);
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m128d MulSub(__m128d a, __m128d b, __m128d c)
+    {
+        if constexpr (Fma) return _mm_fmsub_pd(a, b, c);
+        else return _mm_sub_pd(_mm_mul_pd(a, b), c);
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m256 MulSub(__m256 a, __m256 b, __m256 c)
+    {
+        if constexpr (Fma) return _mm256_fmsub_ps(a, b, c);
+        else return _mm256_sub_ps(_mm256_mul_ps(a, b), c);
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m256d MulSub(__m256d a, __m256d b, __m256d c)
+    {
+        if constexpr (Fma) return _mm256_fmsub_pd(a, b, c);
+        else return _mm256_sub_pd(_mm256_mul_pd(a, b), c);
+    }
+
+    // c - a * b
+    template<bool Fma>
+    TARGET_AVX2 static __m128 NegMulAdd(__m128 a, __m128 b, __m128 c)
+    {
+        if constexpr (Fma) return _mm_fnmadd_ps(a, b, c);
+        else return _mm_sub_ps(c, _mm_mul_ps(a, b));
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m128d NegMulAdd(__m128d a, __m128d b, __m128d c)
+    {
+        if constexpr (Fma) return _mm_fnmadd_pd(a, b, c);
+        else return _mm_sub_pd(c, _mm_mul_pd(a, b));
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m256 NegMulAdd(__m256 a, __m256 b, __m256 c)
+    {
+        if constexpr (Fma) return _mm256_fnmadd_ps(a, b, c);
+        else return _mm256_sub_ps(c, _mm256_mul_ps(a, b));
+    }
+
+    template<bool Fma>
+    TARGET_AVX2 static __m256d NegMulAdd(__m256d a, __m256d b, __m256d c)
+    {
+        if constexpr (Fma) return _mm256_fnmadd_pd(a, b, c);
+        else return _mm256_sub_pd(c, _mm256_mul_pd(a, b));
+    }
+
+    // Determining iterations of several vectors of floats on one row at once
+    // Fractals without an interleaved kernel iterate the vectors one after the other
+    TARGET_AVX2 virtual void GetAVXIterFN(const __m256* xval, __m256 yval, __m256i* n, int interleave, int maxIterations, bool fma) const;
+
+    // Determining iterations of several vectors of doubles on one row at once
+    TARGET_AVX2 virtual void GetAVXIterDN(const __m256d* xval, __m256d yval, __m256i* n, int interleave, int maxIterations, bool fma) const;
+
+    // Orbit of a point in double, returns false if the fractal has no perturbation kernel
+    virtual bool GetReferenceOrbit(double cx, double cy, int maxIterations, std::vector<float>& zx, std::vector<float>& zy) const;
+
+    // Determining iterations of vectors of 8 pixels from their (scaled) offsets to the reference with AVX
+    // with floats, interleaved like GetAVXIterFN
+    // glitched gets the lanes whose offsets lost their precision or outlived the reference orbit
+    TARGET_AVX2 virtual void GetAVXIterPerturb(
+        const ReferenceOrbit& orbit,
+        const __m256* dcx,
+        const __m256* dcy,
+        __m256i* n,
+        __m256* glitched,
+        int vectors,
+        int maxIterations,
+        bool fma) const;
+
 public:
     enum class ZoomType
     {
@@ -61,80 +396,377 @@ public:
     };
 
 private:
+    // A request and what the tiles of its render derive from it
+    struct Frame
+    {
+        const RenderRequest& request;
+        // Part of the image that is rendered
+        Tile region;
+        // First byte of the region in the buffer and the bytes of one pixel
+        uint8_t* origin;
+        int pixelBytes;
+        // Top left of the view rounded to double and the size of a pixel
+        double xMin;
+        double yMin;
+        double dx;
+        double dy;
+        // Reference orbit of perturbation renders, nullptr without one
+        const ReferenceOrbit* reference;
+    };
+
     // FOR RENDERING WITH CPP //
 
     // Determining iterations with CPP with floats
-    virtual int GetCPPIterF(float, float) const = 0;
+    virtual int GetCPPIterF(float, float, int maxIterations) const = 0;
 
     // Determining iterations with CPP with doubles
-    virtual int GetCPPIterD(double, double) const = 0;
+    virtual int GetCPPIterD(double, double, int maxIterations) const = 0;
 
     // Determining if a point is apart of the fractal in C++
-    void UseCPP(
-        Colour* pixelBuffer,
-        int yStart,
-        int yEnd,
-        bool useFloat);
+    TileStats UseCPP(
+        const Frame& frame,
+        const Tile& tile,
+        int step,
+        bool refine,
+        bool useFloat) const;
 
 
     // FOR RENDERING WITH SSE //
 
     // Determining iterations with SSE with floats
-    virtual __m128i GetSSEIterF(__m128, __m128) const = 0;
+    TARGET_AVX2 virtual __m128i GetSSEIterF(__m128, __m128, int maxIterations, bool fma) const = 0;
 
     // Determining iterations with SSE with doubles
-    virtual __m128i GetSSEIterD(__m128d, __m128d) const = 0;
+    TARGET_AVX2 virtual __m128i GetSSEIterD(__m128d, __m128d, int maxIterations, bool fma) const = 0;
 
     // Determining if a point is apart of the fractal in SSE
-    void UseSSE(
-        Colour* pixelBuffer,
-        int yStart,
-        int yEnd,
-        bool useFloat);
+    TARGET_AVX2 TileStats UseSSE(
+        const Frame& frame,
+        const Tile& tile,
+        int step,
+        bool refine,
+        bool useFloat) const;
 
 
     // FOR RENDERING WITH AVX //
 
     // Determining iterations with AVX with floats
-    virtual __m256i GetAVXIterF(__m256, __m256) const = 0;
+    TARGET_AVX2 virtual __m256i GetAVXIterF(__m256, __m256, int maxIterations, bool fma) const = 0;
 
     // Determining iterations with AVX with doubles
-    virtual __m256i GetAVXIterD(__m256d, __m256d) const = 0;
+    TARGET_AVX2 virtual __m256i GetAVXIterD(__m256d, __m256d, int maxIterations, bool fma) const = 0;
 
     // Determining if a point is apart of the fractal in AVX
-    void UseAVX(
-        Colour* pixelBuffer,
-        int yStart,
-        int yEnd,
-        bool useFloat);
+    TARGET_AVX2 TileStats UseAVX(
+        const Frame& frame,
+        const Tile& tile,
+        int step,
+        bool refine,
+        bool useFloat) const;
+
+
+    // FOR RENDERING WITH PERTURBATION //
+
+    // Determining if a point is apart of the fractal from its offset to the reference orbit
+    // Glitched pixels are rendered again against references of their own
+    TARGET_AVX2 TileStats UsePerturbation(
+        const Frame& frame,
+        const Tile& tile,
+        int step,
+        bool refine) const;
+
+    // Glitched pixels of a tile, each round picks a new reference inside what is left and iterates
+    // every pixel against it until none is glitched
+    // Plain double can not tell the pixels of these views apart, so it is never the fallback
+    TARGET_AVX2 void RenderGlitches(const Frame& frame, std::vector<std::pair<int, int>>& pixels, TileStats& stats) const;
+
+    // Whether the request renders with perturbation, only once double runs out of precision
+    bool UsesReference(const RenderRequest& request) const;
+
+    // Reference orbit of the nearest double to an offset from the centre of the view
+    // Empty if the fractal has no perturbation kernel
+    ReferenceOrbit MakeReference(const RenderRequest& request, double offsetX, double offsetY) const;
+
+    // Reference orbit of the view of a request
+    // The longest orbit of the centre and a grid of points over the view is kept
+    // Empty if the fractal has no perturbation kernel
+    ReferenceOrbit PickReference(const RenderRequest& request) const;
+
+    // Pick the reference orbit of the current view if the request uses one, kept while the view stays
+    void UpdateReference(const RenderRequest& request);
 
 
     // HELPER FUNCTIONS //
 
+    // SIMD kernels count down in 16 bit lanes, recover the number of iterations
+    static int LaneIterations(int lane)
+    {
+        return -static_cast<int16_t>(lane);
+    }
+
+    // Lanes of the counts a SIMD kernel returned, read with a store rather than a cast pointer
+    // The kernels count in 16 bit steps, so every 16 bit word of a lane holds its count
+    TARGET_AVX2 static void LaneValues(__m128i n, int16_t* lanes, int count);
+    TARGET_AVX2 static void LaneValues(__m256i n, int16_t* lanes, int count);
+
+    // x values (x0 + pixel * dx) of the lanes of a vector that starts at pixel x
+    // Each comes from its pixel index, so nothing builds up along the row, and the lanes past
+    // the last pixel repeat it so they never keep a vector iterating longer than the drawn pixels
+    template<typename T>
+    static void LaneCoordinates(T* xval, int lanes, int x, int xStep, int xLast, double x0, double dx)
+    {
+        for (int i = 0; i < lanes; ++i)
+        {
+            int pixel_x = x + i * xStep < xLast ? x + i * xStep : xLast;
+            xval[i] = static_cast<T>(x0 + pixel_x * dx);
+        }
+    }
+
+    // Split the region of a request into tiles, in rows from its top left
+    static std::vector<Tile> MakeTiles(const RenderRequest& request);
+
+    // Region of a request, the whole image if it has none
+    static Tile RequestRegion(const RenderRequest& request);
+
+    // Request of the current view, size and choices of the user rendered with the given settings
+    RenderRequest MakeRequest(const RenderSettings& settings) const;
+
+    // Bounds and pixel size of a request, rounded to double from the exact view every time so they never drift
+    static Frame MakeFrame(const RenderRequest& request, void* buffer, const ReferenceOrbit* reference);
+
+    // Dynamically changing from float to double when resolution gets low
+    // True if float has the precision for every tile of the view
+    bool UsesFloat() const;
+
+    // Whether float has the precision for the pixels of a tile
+    bool TileUsesFloat(const Frame& frame, const Tile& tile) const;
+
+    // Whether the pixel spacing of a tile is at least m_floatSpacingUlps ulps of a type with this
+    // many bits of mantissa
+    bool TileResolves(const Frame& frame, const Tile& tile, int mantissaBits) const;
+
+    // Backend used to render a tile for a language
+    using UseFunction = TileStats(Fractal::*)(const Frame&, const Tile&, int, bool, bool) const;
+    static UseFunction SelectLanguage(UINT language);
+
+    // Number of threads a language renders with when the machine has not been tuned
+    static int DefaultThreads(UINT language);
+
+    // Run the worker on the given number of threads, the worker gets the index of its thread
+    // Pinned threads are placed by the topology, threads next to each other share a NUMA node
+    // Background threads run below normal priority
+    static void RunWorkers(const std::function<void(int)>& worker, int numThreads, bool pinThreads, bool background);
+
+    // NUMA node of each worker RunWorkers starts, numbered from 0 in the order of the workers
+    // Unpinned threads may run anywhere, they are all taken as one node
+    static std::vector<int> WorkerNodes(const RenderSettings& settings);
+
+    // First tile row of the band of each worker and the count of tile rows after the last
+    // PlaceBuffer writes each band from its worker, so a node's rows are the bands of its workers
+    static std::vector<int> WorkerTileRows(int tileRows, int workers);
+
+    // The frame in m_tileStats is finished, it becomes the cost map of the next frame
+    void FinishFrame(const RenderRequest& request);
+
+    // The last frame was rendered at the window's size on the grid of these tiles
+    // Otherwise its stats describe other tiles (or fewer of them) and are not used
+    bool LastFrameMatches(const std::vector<Tile>& tiles) const;
+
+    // Expected iterations per sample of every tile
+    // Refining uses the coarser passes of this frame, otherwise the last frame is mapped onto the current view
+    // Empty if there is nothing to predict from
+    std::vector<double> PredictTileCosts(const std::vector<Tile>& tiles, bool refine) const;
+
+    // Samples of a tile on the grid of the step, less the ones the coarser pass already has when refining
+    static double TileSamples(const Tile& tile, int step, bool refine);
+
+    // Expected visual importance of a tile, boundary tiles and the centre are the highest
+    double TileImportance(const Tile& tile, const TileStats& stats) const;
+
+    // Expected iterations to render the samples of a tile at the given step
+    double EstimateTileIterations(const Tile& tile, const TileStats& stats, int step, bool refine) const;
+
     // Map iterations to a gradient
-    void MapColour(
+    static void MapColour(
+        Colour* pixelBuffer,
+        uint8_t n,
+        UINT gradient);
+
+    // Write the sample at (x, y) of the image in the pixel format of the request
+    // index is the byte the gradient colours, iterations the count of the sample
+    static void StorePixel(
+        const Frame& frame,
+        int x,
+        int y,
+        uint8_t index,
+        int iterations);
+
+    // Render every pixel on the grid of the given step
+    // When refining, the samples of the previous (twice as coarse) pass are reused
+    // Returns false if the pass was cancelled before every tile was rendered
+    bool RenderPass(
+        const RenderRequest& request,
+        Colour* pixelBuffer,
+        int step,
+        bool refine,
+        const std::atomic<bool>* cancel);
+
+    // Nearest-neighbour fill of the pixels that are off the grid of the given step
+    void FillPass(
+        Colour* pixelBuffer,
+        int step);
+
+    // Nearest-neighbour fill of a single tile
+    void FillTile(
         Colour* pixelBuffer,
-        uint8_t n);
+        const Tile& tile,
+        int step);
+
+    // Sort the tiles that are left in the current deadline level by importance
+    void OrderBudgetLevel();
 
 public:
-    Fractal(std::shared_ptr<App> app, double xMin, double xMax, double yMin, double yMax)
-        : m_app(std::move(app)), m_xMin(xMin), m_xMax(xMax), m_yMin(yMin), m_yMax(yMax)
+    Fractal(std::shared_ptr<RenderHost> host, double xMin, double xMax, double yMin, double yMax)
+        : m_host(std::move(host))
     {
+        SetViewport(Viewport::FromBounds(xMin, xMax, yMin, yMax));
     }
 
     ~Fractal()
     {
     }
 
-    // Function to render the fractal (May use multithreading depending on user selection)
-    void Render(Colour* pixelBuffer);
+    // Copy of the fractal and its view, to render other views without touching this one
+    virtual std::unique_ptr<Fractal> Clone() const = 0;
+
+    // Name of the fractal in tuning profiles
+    virtual const char* GetName() const = 0;
+
+    // Whether the SSE and AVX kernels are implemented, the SIMD backends render with C++ if not
+    virtual bool HasSIMDKernels() const
+    {
+        return true;
+    }
 
-    // Transferring the pixelBuffer bitmap to the main screen and writing to the gif
-    void Draw(
-        HDC hdc,
+    // Whether this CPU has the FMA3 instructions the fused kernels need
+    static bool HasFMA();
+
+    // Whether this CPU has the AVX2 instructions every SIMD kernel is compiled for
+    static bool HasAVX2();
+
+    // Backend, threads and tiles the current view renders with
+    // The menu language, refined by the tuning profile of this fractal and precision
+    RenderSettings GetSettings() const;
+
+    // Render with these settings instead of the menu and the tuning profile, nullopt to go back
+    void ForceSettings(const std::optional<RenderSettings>& settings);
+
+    // Render in double precision whatever the zoom
+    void ForceDouble(bool forceDouble);
+
+    // Snapshot of the current view, size and settings, to render on its own
+    RenderRequest GetRequest() const;
+
+    // Fill in the defaults of the backend, threads, interleave and tiles, and drop FMA without FMA3
+    // Fractals without SIMD kernels are moved to the C++ backend with the same threading
+    RenderSettings ResolveSettings(RenderSettings settings) const;
+
+    // Write a freshly allocated buffer once from the render threads, each thread its own rows
+    // With pinned threads the OS puts each node's part of the buffer on that node's memory,
+    // the rows the threads of that node render first
+    void PlaceBuffer(Colour* pixelBuffer);
+
+    Viewport GetViewport() const;
+
+    void SetViewport(const Viewport& view);
+
+    // Function to render the fractal (May use multithreading depending on user selection)
+    // The request is taken from GetRequest when the frame starts, the menu may change while it renders
+    // Its stats become the cost map of the next frame, unlike the const Render of any request below
+    // Setting cancel stops the render at the next tile, returns false if that happened
+    // A preview scale of 2 or 4 renders every 2nd or 4th pixel and upscales the result
+    bool Render(
+        const RenderRequest& request,
+        Colour* pixelBuffer,
+        const std::atomic<bool>* cancel,
+        int previewScale);
+
+    // Render a request straight into the rectangle of a caller owned buffer it describes
+    // Only reads the request and the kernels, so any number of threads may render requests
+    // on one fractal at once, while it renders other views of its own
+    // Setting cancel stops the render at the next tile, returns false if that happened
+    // tilesDone has a flag for each tile of the region in rows from its top left, flagged tiles
+    // are skipped and the rest are flagged once their pixels are in the buffer
+    bool Render(
+        const RenderRequest& request,
+        void* buffer,
+        const std::atomic<bool>* cancel = nullptr,
+        std::atomic<uint8_t>* tilesDone = nullptr) const;
+
+    // Render a request against a reference orbit from RequestReference of the whole request
+    // Regions of one image render against the same orbit, picked once rather than for each of them
+    bool Render(
+        const RenderRequest& request,
+        const ReferenceOrbit& reference,
+        void* buffer,
+        const std::atomic<bool>* cancel = nullptr,
+        std::atomic<uint8_t>* tilesDone = nullptr) const;
+
+    // Reference orbit Render picks for a request, empty if the request renders without one
+    ReferenceOrbit RequestReference(const RenderRequest& request) const;
+
+    // Bytes of one pixel of a format
+    static int PixelBytes(PixelFormat format);
+
+    // Write the colour of a gradient index in a pixel format, any but Iterations
+    static void ColourPixel(
+        uint8_t* pixel,
+        PixelFormat format,
+        uint8_t index,
+        UINT gradient);
+
+    // Byte of the gradient the backend of a language colours a count with
+    // The SIMD kernels count down, so theirs is the count negated
+    static uint8_t GradientIndex(UINT language, int iterations);
+
+    // Function to render the fractal coarse-to-fine
+    // After each pass the pixelBuffer holds a complete (filled) image and onPass is called
+    // with the step of that pass, the pass with a step of previewScale is the final image
+    // Every pass renders the one request, so a frame never mixes backends or gradients
+    bool RenderProgressive(
+        const RenderRequest& request,
         Colour* pixelBuffer,
-        GifWriter* gif,
-        bool recording);
+        const std::function<void(int)>& onPass,
+        const std::atomic<bool>* cancel = nullptr,
+        int previewScale = 1);
+
+    // Start a deadline render of a request taken from GetRequest
+    // The frame is refined down to the given preview scale over the calls to RenderBudgeted
+    void BeginBudgeted(
+        const RenderRequest& request,
+        int previewScale = 1);
+
+    // Spend up to budgetMs refining the frame started by BeginBudgeted, the most important tiles first
+    // The pixelBuffer always holds the best image so far, returns true once the frame is finished
+    bool RenderBudgeted(
+        Colour* pixelBuffer,
+        double budgetMs,
+        const std::atomic<bool>* cancel = nullptr);
+
+    // Finest step every tile of the deadline render has reached
+    int GetBudgetStep() const;
+
+    // How well the work of the last pass was predicted and split between the threads
+    CostMapReport GetCostMapReport() const;
+
+    // Iterations of every tile of the last finished frame
+    const std::vector<TileStats>& GetFrameStats() const;
+
+    // View that ZoomScreen would move to
+    Viewport ZoomedViewport(ZoomType zoom) const;
+
+    // View that MoveScreen would move to
+    Viewport MovedViewport(const POINT& clickPoint) const;
 
     // Zooming in on the current fractal
     void ZoomScreen(ZoomType zoom);
@@ -16,5 +16,19 @@
 #include "Multibrot.h"
 #include "Nova.h"
 #include "Pheonix.h"
+#include "RenderJob.h"
+#include "RenderQueue.h"
+#include "Prefetcher.h"
+#include "TuningProfile.h"
+#include "Autotuner.h"
+#include "Topology.h"
+#include "PngWriter.h"
+#include "Checkpoint.h"
+#include "Poster.h"
+#include "FrameStream.h"
+#include "FrameRing.h"
+#include "IterationArchive.h"
+#include "Scene.h"
+#include "Batch.h"
 
 
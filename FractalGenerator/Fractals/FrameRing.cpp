@@ -0,0 +1,304 @@
+/*********************************************************************************************
+**
+**	File Name:		framering.cpp
+**	Description:	This is the file that contains the function definitions for the frame ring
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <chrono>
+#include <new>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "FrameRing.h"
+
+// "FRACRING" in memory order, x86 is little endian
+static const uint64_t s_magic = 0x474e495243415246ull;
+static const uint32_t s_version = 1;
+
+// The pixels of each slot start on a page, so readers can map or upload them as they are
+static const size_t s_page = 4096;
+
+static size_t RoundToPage(size_t bytes)
+{
+    return (bytes + s_page - 1) / s_page * s_page;
+}
+
+FrameRing::~FrameRing()
+{
+    Close();
+}
+
+FrameRingHeader* FrameRing::Header() const
+{
+    return reinterpret_cast<FrameRingHeader*>(m_memory);
+}
+
+FrameRingSlot* FrameRing::Slot(uint64_t sequence) const
+{
+    FrameRingSlot* slots = reinterpret_cast<FrameRingSlot*>(m_memory + sizeof(FrameRingHeader));
+    return slots + (sequence - 1) % Header()->slotCount;
+}
+
+uint8_t* FrameRing::Pixels(uint64_t sequence) const
+{
+    const FrameRingHeader* header = Header();
+    return m_memory + header->pixelOffset + (sequence - 1) % header->slotCount * header->slotBytes;
+}
+
+bool FrameRing::Map(const std::string& name, size_t bytes)
+{
+    const bool create = bytes != 0;
+    m_name = name;
+    m_creator = create;
+
+#ifdef _WIN32
+    // Shared memory of the session, backed by the paging file
+    const std::string path = "Local\\" + name;
+    if (create)
+    {
+        const unsigned long long size = bytes;
+        m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), path.c_str());
+    }
+    else
+    {
+        m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+    }
+
+    if (!m_mapping)
+    {
+        return false;
+    }
+
+    // A view of 0 bytes maps all of it
+    void* view = MapViewOfFile(m_mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        return false;
+    }
+
+    // A reader has no size of its own, the view is as large as the section rounded to pages
+    if (!create)
+    {
+        MEMORY_BASIC_INFORMATION info;
+        if (VirtualQuery(view, &info, sizeof(info)) == 0 || info.RegionSize < sizeof(FrameRingHeader))
+        {
+            UnmapViewOfFile(view);
+            return false;
+        }
+        bytes = info.RegionSize;
+    }
+#else
+    // Names of POSIX shared memory start with a slash
+    const std::string path = "/" + name;
+    if (create)
+    {
+        // A ring left by a producer that was killed is replaced
+        shm_unlink(path.c_str());
+        m_file = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (m_file < 0 || ftruncate(m_file, static_cast<off_t>(bytes)) != 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        struct stat info;
+        m_file = shm_open(path.c_str(), O_RDONLY, 0);
+        if (m_file < 0 || fstat(m_file, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FrameRingHeader))
+        {
+            return false;
+        }
+        bytes = static_cast<size_t>(info.st_size);
+    }
+
+    void* view = mmap(nullptr, bytes, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_file, 0);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+#endif
+
+    m_memory = static_cast<uint8_t*>(view);
+    m_bytes = bytes;
+    return true;
+}
+
+bool FrameRing::Create(const std::string& name, int width, int height, PixelFormat format, int slotCount)
+{
+    Close();
+
+    const size_t stride = static_cast<size_t>(width) * Fractal::PixelBytes(format);
+    const size_t slotBytes = RoundToPage(stride * height);
+    const size_t pixelOffset = RoundToPage(sizeof(FrameRingHeader) + slotCount * sizeof(FrameRingSlot));
+
+    // With one slot the producer is always writing over the latest frame, readers would never
+    // find it whole
+    if (width <= 0 || height <= 0 || slotCount < 2 || !Map(name, pixelOffset + slotCount * slotBytes))
+    {
+        Close();
+        return false;
+    }
+
+    // New memory is zeros, the atomics are constructed on it before anyone uses them
+    FrameRingHeader* header = new (m_memory) FrameRingHeader{};
+    header->version = s_version;
+    header->slotCount = static_cast<uint32_t>(slotCount);
+    header->width = width;
+    header->height = height;
+    header->format = static_cast<uint32_t>(format);
+    header->stride = stride;
+    header->slotBytes = slotBytes;
+    header->pixelOffset = pixelOffset;
+
+    for (int i = 0; i < slotCount; ++i)
+    {
+        new (m_memory + sizeof(FrameRingHeader) + i * sizeof(FrameRingSlot)) FrameRingSlot{};
+    }
+
+    // The magic goes in last, a reader that sees it sees the rest of the header
+    header->magic.store(s_magic, std::memory_order_release);
+
+    m_published = 0;
+    return true;
+}
+
+bool FrameRing::Attach(const std::string& name)
+{
+    Close();
+
+    if (!Map(name, 0))
+    {
+        Close();
+        return false;
+    }
+
+    // The magic first, the fence after it orders the reads of the rest of the header
+    const FrameRingHeader* header = Header();
+    const uint64_t magic = header->magic.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (magic != s_magic || header->version != s_version || header->slotCount < 2 ||
+        header->pixelOffset + header->slotCount * header->slotBytes > m_bytes)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void FrameRing::Close()
+{
+    if (m_memory)
+    {
+        if (m_creator)
+        {
+            Header()->closed.store(1, std::memory_order_release);
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(m_memory);
+#else
+        munmap(m_memory, m_bytes);
+#endif
+        m_memory = nullptr;
+    }
+
+#ifdef _WIN32
+    // The memory goes once the last process closes its handle
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+#else
+    if (m_file >= 0)
+    {
+        close(m_file);
+        m_file = -1;
+    }
+
+    // Readers that have it mapped keep it, the name is free for the next ring
+    if (m_creator)
+    {
+        shm_unlink(("/" + m_name).c_str());
+    }
+#endif
+
+    m_creator = false;
+    m_bytes = 0;
+}
+
+const FrameRingHeader* FrameRing::GetHeader() const
+{
+    return Header();
+}
+
+uint8_t* FrameRing::BeginFrame(size_t& stride)
+{
+    const uint64_t sequence = m_published + 1;
+
+    // Odd, the slot is being written, before any of its pixels change
+    Slot(sequence)->sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    stride = Header()->stride;
+    return Pixels(sequence);
+}
+
+void FrameRing::Publish(const RenderRequest& request)
+{
+    const uint64_t sequence = m_published + 1;
+    FrameRingSlot* slot = Slot(sequence);
+
+    slot->centreX = request.view.cx.ToDouble();
+    slot->centreY = request.view.cy.ToDouble();
+    slot->mantissa = request.view.mantissa;
+    slot->exponent = request.view.exponent;
+    slot->aspect = request.view.aspect;
+    slot->maxIterations = request.maxIterations;
+    slot->gradient = request.gradient;
+    slot->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Even, the frame and its description are ready, then it is the newest
+    slot->sequence.store(2 * sequence + 2, std::memory_order_release);
+    Header()->latest.store(sequence, std::memory_order_release);
+
+    m_published = sequence;
+}
+
+bool FrameRing::Latest(FrameRingFrame& frame) const
+{
+    const FrameRingHeader* header = Header();
+
+    // The producer may already be writing over the newest frame's slot if it lapped the ring,
+    // then a newer frame is the latest
+    for (;;)
+    {
+        const uint64_t sequence = header->latest.load(std::memory_order_acquire);
+        if (!sequence)
+        {
+            return false;
+        }
+
+        const FrameRingSlot* slot = Slot(sequence);
+        if (slot->sequence.load(std::memory_order_acquire) == 2 * sequence + 2)
+        {
+            frame = { sequence, slot, Pixels(sequence) };
+            return true;
+        }
+    }
+}
+
+bool FrameRing::Intact(const FrameRingFrame& frame) const
+{
+    // Everything read from the frame is ordered before the check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return frame.slot->sequence.load(std::memory_order_relaxed) == 2 * frame.sequence + 2;
+}
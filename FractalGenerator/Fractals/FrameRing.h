@@ -0,0 +1,144 @@
+/*********************************************************************************************
+**
+**	File Name:		framering.h
+**	Description:	This is the header file that contains the class definition for the frame
+**                  ring, a ring of frames in named shared memory that the renderer publishes
+**                  into and viewers and encoders in other processes read in place
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "Fractal.h"
+
+// The memory is laid out the same for every process that maps it, so the layout is fixed
+// to plain fields and lock-free atomics, the header first, then the slots, then the pixels
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring needs lock-free 64 bit atomics");
+
+// First bytes of the shared memory
+struct FrameRingHeader
+{
+    // The bytes "FRACRING" as one word, stored last by the producer, and the version of the layout
+    // A reader loads it before it reads anything else of the header
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+
+    // Number of slots, each holds one frame
+    uint32_t slotCount;
+
+    // Size and PixelFormat of every frame, and the bytes from one row to the next
+    int32_t width;
+    int32_t height;
+    uint32_t format;
+    uint32_t reserved;
+    uint64_t stride;
+
+    // Bytes of the pixels of one slot and where the pixels of slot 0 start, both page aligned
+    uint64_t slotBytes;
+    uint64_t pixelOffset;
+
+    // Sequence of the newest frame that is ready, 0 before the first
+    // Frame n is in slot (n - 1) % slotCount
+    std::atomic<uint64_t> latest;
+
+    // Set once the producer is done, no frame follows the latest
+    std::atomic<uint32_t> closed;
+};
+
+// Description of the frame in a slot, after the header in slot order
+struct FrameRingSlot
+{
+    // 2n + 1 while frame n is written and 2n + 2 once it is ready, 0 before the first
+    // Readers load it before and after using the frame, a change means it was overwritten
+    std::atomic<uint64_t> sequence;
+
+    // View of the frame, the centre rounded to double and the width as mantissa * 2^exponent
+    double centreX;
+    double centreY;
+    double mantissa;
+    int32_t exponent;
+    int32_t maxIterations;
+    double aspect;
+    uint32_t gradient;
+    uint32_t reserved;
+
+    // Steady clock time the frame was published, in nanoseconds
+    int64_t timestamp;
+};
+
+// Frame a reader found, its pixels are in the shared memory and are read in place
+struct FrameRingFrame
+{
+    uint64_t sequence;
+    const FrameRingSlot* slot;
+    const uint8_t* pixels;
+};
+
+// One process creates the ring and publishes frames, any number of others attach and read
+// The producer never waits for readers, a reader that falls a whole ring behind finds its frame
+// was overwritten and takes the newest again
+class FrameRing
+{
+private:
+    std::string m_name;
+    bool m_creator{};
+
+#ifdef _WIN32
+    HANDLE m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+
+    uint8_t* m_memory{};
+    size_t m_bytes{};
+
+    // Frames published so far
+    uint64_t m_published{};
+
+    FrameRingHeader* Header() const;
+    FrameRingSlot* Slot(uint64_t sequence) const;
+    uint8_t* Pixels(uint64_t sequence) const;
+
+    // Map the memory of the name, creating it with the given size when bytes is not 0
+    bool Map(const std::string& name, size_t bytes);
+
+public:
+    FrameRing() = default;
+
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // Create a ring of frames of a size and format, replacing a ring of the same name
+    // A ring needs at least 2 slots, one being written and one holding the latest frame
+    bool Create(const std::string& name, int width, int height, PixelFormat format, int slotCount);
+
+    // Map the ring another process created
+    bool Attach(const std::string& name);
+
+    // Unmap the ring, the creator marks it closed and removes the name, readers keep their mapping
+    void Close();
+
+    const FrameRingHeader* GetHeader() const;
+
+    // Memory the next frame is rendered into, the slot of the oldest frame
+    // Readers of that frame see it change from here on
+    uint8_t* BeginFrame(size_t& stride);
+
+    // The frame is rendered, describe it with the view of its request and make it the latest
+    void Publish(const RenderRequest& request);
+
+    // Newest ready frame, false if there is none yet
+    bool Latest(FrameRingFrame& frame) const;
+
+    // Whether a frame is still the one Latest found, true once the reader is done means
+    // everything it read was of that frame
+    bool Intact(const FrameRingFrame& frame) const;
+};
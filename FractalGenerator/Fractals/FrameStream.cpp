@@ -0,0 +1,319 @@
+/*********************************************************************************************
+**
+**	File Name:		framestream.cpp
+**	Description:	This is the file that contains the function definitions for the frame
+**                  stream
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <string>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+#include "FrameStream.h"
+
+FrameStream::FrameStream(Format format, int fps)
+    : m_format(format), m_fps(fps)
+{
+}
+
+FrameStream::~FrameStream()
+{
+    Close();
+}
+
+PixelFormat FrameStream::GetFormat() const
+{
+    return m_format == Format::RGB ? PixelFormat::RGB : PixelFormat::RGBA;
+}
+
+int FrameStream::PixelBytes() const
+{
+    return Fractal::PixelBytes(GetFormat());
+}
+
+size_t FrameStream::Stride() const
+{
+    return static_cast<size_t>(m_width) * PixelBytes();
+}
+
+bool FrameStream::Open(const std::filesystem::path& path, int width, int height)
+{
+    if (path == "-")
+    {
+#ifdef _WIN32
+        // The frames are binary, stdout must not turn their newlines into CR LF
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        m_file = stdout;
+        m_ownsFile = false;
+    }
+    else
+    {
+        // A named pipe opens like a file, blocking until the encoder reads it
+        m_file = fopen(path.string().c_str(), "wb");
+        m_ownsFile = true;
+    }
+
+    if (!m_file)
+    {
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_failed = false;
+    m_closing = false;
+    m_renderFrame = 0;
+    m_writeFrame = 0;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        m_frames[i].resize(Stride() * height);
+        m_written[i] = true;
+    }
+
+    if (m_format == Format::Y4M)
+    {
+        const size_t chroma = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+        m_planes.resize(static_cast<size_t>(width) * height + 2 * chroma);
+
+        // Progressive frames of square pixels, the chroma is full range and centred between the pixels
+        const std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) +
+            " F" + std::to_string(m_fps) + ":1 Ip A1:1 C420jpeg\n";
+        if (fwrite(header.data(), 1, header.size(), m_file) != header.size())
+        {
+            return false;
+        }
+    }
+
+    m_writer = std::thread(&FrameStream::WriteFrames, this);
+    return true;
+}
+
+uint8_t* FrameStream::BeginFrame(size_t& stride)
+{
+    std::unique_lock<std::mutex> hold(m_lock);
+    m_changed.wait(hold, [this] { return m_written[m_renderFrame] || m_failed; });
+
+    if (m_failed)
+    {
+        return nullptr;
+    }
+
+    stride = Stride();
+    return m_frames[m_renderFrame].data();
+}
+
+bool FrameStream::EndFrame()
+{
+    bool failed;
+    {
+        std::lock_guard<std::mutex> hold(m_lock);
+        m_written[m_renderFrame] = false;
+        m_renderFrame ^= 1;
+        failed = m_failed;
+    }
+
+    m_changed.notify_all();
+    return !failed;
+}
+
+bool FrameStream::Close()
+{
+    if (m_writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> hold(m_lock);
+            m_closing = true;
+        }
+        m_changed.notify_all();
+        m_writer.join();
+    }
+
+    if (!m_file)
+    {
+        return false;
+    }
+
+    bool written = fflush(m_file) == 0 && !m_failed;
+    if (m_ownsFile)
+    {
+        written = fclose(m_file) == 0 && written;
+    }
+    m_file = nullptr;
+
+    return written;
+}
+
+void FrameStream::WriteFrames()
+{
+    std::unique_lock<std::mutex> hold(m_lock);
+
+    for (;;)
+    {
+        m_changed.wait(hold, [this] { return !m_written[m_writeFrame] || m_closing; });
+        if (m_written[m_writeFrame])
+        {
+            // Closing, and every frame is written
+            return;
+        }
+
+        // The frame is the writer's until it is marked written, the render uses the other
+        hold.unlock();
+        bool written = !m_failed && WriteFrame(m_frames[m_writeFrame].data());
+        hold.lock();
+
+        m_failed = m_failed || !written;
+        m_written[m_writeFrame] = true;
+        m_writeFrame ^= 1;
+        m_changed.notify_all();
+    }
+}
+
+bool FrameStream::WriteFrame(const uint8_t* pixels)
+{
+    if (m_format == Format::RGB)
+    {
+        return fwrite(pixels, 1, Stride() * m_height, m_file) == Stride() * m_height;
+    }
+
+    const size_t lumaBytes = static_cast<size_t>(m_width) * m_height;
+    const size_t chromaBytes = (m_planes.size() - lumaBytes) / 2;
+    uint8_t* y = m_planes.data();
+    ToYuv420(pixels, Stride(), m_width, m_height, y, y + lumaBytes, y + lumaBytes + chromaBytes);
+
+    static const char frame[] = "FRAME\n";
+    return fwrite(frame, 1, sizeof(frame) - 1, m_file) == sizeof(frame) - 1 &&
+        fwrite(m_planes.data(), 1, m_planes.size(), m_file) == m_planes.size();
+}
+
+void FrameStream::ToYuv420(const uint8_t* rgba, size_t stride, int width, int height, uint8_t* y, uint8_t* u, uint8_t* v)
+{
+    const int chromaWidth = (width + 1) / 2;
+    const bool avx2 = Fractal::HasAVX2();
+
+    for (int row = 0; row < height; row += 2)
+    {
+        // The last row of an odd height is its own pair
+        const bool pair = row + 1 < height;
+        const uint8_t* row0 = rgba + row * stride;
+        const uint8_t* row1 = pair ? row0 + stride : row0;
+        uint8_t* y0 = y + static_cast<size_t>(row) * width;
+        uint8_t* y1 = pair ? y0 + width : y0;
+        uint8_t* uRow = u + static_cast<size_t>(row / 2) * chromaWidth;
+        uint8_t* vRow = v + static_cast<size_t>(row / 2) * chromaWidth;
+
+        int x = avx2 ? ToYuv420AVX(row0, row1, width, y0, y1, uRow, vRow) : 0;
+
+        // The rest, and the last column of an odd width paired with itself
+        for (; x < width; x += 2)
+        {
+            const int x1 = x + 1 < width ? x + 1 : x;
+            const uint8_t* p[4] = { row0 + x * 4, row0 + x1 * 4, row1 + x * 4, row1 + x1 * 4 };
+
+            int r = 0, g = 0, b = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                r += p[i][0];
+                g += p[i][1];
+                b += p[i][2];
+            }
+
+            y0[x] = static_cast<uint8_t>((77 * p[0][0] + 150 * p[0][1] + 29 * p[0][2] + 128) >> 8);
+            y0[x1] = static_cast<uint8_t>((77 * p[1][0] + 150 * p[1][1] + 29 * p[1][2] + 128) >> 8);
+            y1[x] = static_cast<uint8_t>((77 * p[2][0] + 150 * p[2][1] + 29 * p[2][2] + 128) >> 8);
+            y1[x1] = static_cast<uint8_t>((77 * p[3][0] + 150 * p[3][1] + 29 * p[3][2] + 128) >> 8);
+
+            // The sums are of 4 pixels, the shift takes their mean as well
+            uRow[x / 2] = static_cast<uint8_t>(std::clamp(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128, 0, 255));
+            vRow[x / 2] = static_cast<uint8_t>(std::clamp(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128, 0, 255));
+        }
+    }
+}
+
+// Weighted sum of the channels in 32 bit lanes
+// A function rather than a lambda, the function pointer a lambda converts to would not have the target
+TARGET_AVX2 static __m256i Weigh(__m256i r, __m256i g, __m256i b, int wr, int wg, int wb)
+{
+    return _mm256_add_epi32(
+        _mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(wr)), _mm256_mullo_epi32(g, _mm256_set1_epi32(wg))),
+        _mm256_mullo_epi32(b, _mm256_set1_epi32(wb)));
+}
+
+int FrameStream::ToYuv420AVX(const uint8_t* row0, const uint8_t* row1, int width, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v)
+{
+    const __m256i byteMask = _mm256_set1_epi32(0xff);
+
+    // The lambdas are functions of their own, each needs the target of the conversion
+    // Red, green and blue of 8 RGBA pixels as 32 bit lanes
+    auto channels = [byteMask](__m256i pixels, __m256i& r, __m256i& g, __m256i& b) TARGET_AVX2
+        {
+            r = _mm256_and_si256(pixels, byteMask);
+            g = _mm256_and_si256(_mm256_srli_epi32(pixels, 8), byteMask);
+            b = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), byteMask);
+        };
+
+    // 16 lanes of 0 to 255 in two vectors as 16 bytes in order
+    auto packLuma = [](__m256i low, __m256i high) TARGET_AVX2
+        {
+            __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xd8);
+            __m256i bytes = _mm256_packus_epi16(words, words);
+            return _mm_unpacklo_epi64(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1));
+        };
+
+    // 8 lanes as 8 bytes in order, clamped to 0 to 255
+    auto packChroma = [](__m256i lanes) TARGET_AVX2
+        {
+            __m256i words = _mm256_packus_epi32(lanes, lanes);
+            __m256i bytes = _mm256_packus_epi16(words, words);
+            return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4)));
+        };
+
+    // hadd sums neighbours within each 128 bit half, this puts the sums back in order
+    const __m256i pairOrder = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    const __m256i lumaRound = _mm256_set1_epi32(128);
+    const __m256i chromaRound = _mm256_set1_epi32(512);
+    const __m256i chromaCentre = _mm256_set1_epi32(128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i pixels[4] = {
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 4)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 4 + 32)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 4)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 4 + 32)) };
+
+        __m256i r[4], g[4], b[4], luma[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            channels(pixels[i], r[i], g[i], b[i]);
+            luma[i] = _mm256_srli_epi32(_mm256_add_epi32(Weigh(r[i], g[i], b[i], 77, 150, 29), lumaRound), 8);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y0 + x), packLuma(luma[0], luma[1]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y1 + x), packLuma(luma[2], luma[3]));
+
+        // Sums of each 2x2 block, the rows added and then the neighbours
+        auto blocks = [pairOrder](const __m256i* channel) TARGET_AVX2
+            {
+                __m256i sum = _mm256_hadd_epi32(_mm256_add_epi32(channel[0], channel[2]), _mm256_add_epi32(channel[1], channel[3]));
+                return _mm256_permutevar8x32_epi32(sum, pairOrder);
+            };
+        __m256i rSum = blocks(r), gSum = blocks(g), bSum = blocks(b);
+
+        __m256i cb = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(Weigh(rSum, gSum, bSum, -43, -85, 128), chromaRound), 10), chromaCentre);
+        __m256i cr = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(Weigh(rSum, gSum, bSum, 128, -107, -21), chromaRound), 10), chromaCentre);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), packChroma(cb));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), packChroma(cr));
+    }
+
+    return x;
+}
@@ -0,0 +1,102 @@
+/*********************************************************************************************
+**
+**	File Name:		framestream.h
+**	Description:	This is the header file that contains the class definition for the frame
+**                  stream, which writes the frames of an animation as Y4M or raw RGB to a
+**                  file, a named pipe or stdout for a video encoder to read
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Fractal.h"
+
+// Frames are rendered into one buffer while a writer thread converts and writes the other,
+// so the render only waits when the reader falls a whole frame behind
+class FrameStream
+{
+public:
+    enum class Format
+    {
+        // Rows of RGB bytes, frame after frame, as rendered
+        RGB,
+        // YUV4MPEG2 with full range 4:2:0 frames, converted from RGBA
+        Y4M
+    };
+
+private:
+    Format m_format;
+    int m_fps;
+
+    FILE* m_file{};
+    bool m_ownsFile{};
+
+    int m_width{};
+    int m_height{};
+
+    // The frame being rendered and the frame being written
+    std::vector<uint8_t> m_frames[2];
+    bool m_written[2]{ true, true };
+
+    // Frame the next render goes into and the next the writer takes
+    int m_renderFrame{};
+    int m_writeFrame{};
+
+    // Y, U and V planes of the frame being written
+    std::vector<uint8_t> m_planes;
+
+    std::mutex m_lock;
+    std::condition_variable m_changed;
+    bool m_closing{};
+    bool m_failed{};
+    std::thread m_writer;
+
+    // Bytes of a rendered pixel and of one rendered row
+    int PixelBytes() const;
+    size_t Stride() const;
+
+    // Runs on the writer thread until the stream closes
+    void WriteFrames();
+
+    bool WriteFrame(const uint8_t* pixels);
+
+    // Full range BT.601 4:2:0 planes of RGBA rows, each chroma sample is the mean of 2x2 pixels
+    // Odd sizes repeat the last column and row
+    static void ToYuv420(const uint8_t* rgba, size_t stride, int width, int height, uint8_t* y, uint8_t* u, uint8_t* v);
+
+    // Two rows of pixels 16 at a time with AVX2, the pixels converted
+    TARGET_AVX2 static int ToYuv420AVX(const uint8_t* row0, const uint8_t* row1, int width, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v);
+
+public:
+    FrameStream(Format format, int fps = 30);
+
+    ~FrameStream();
+
+    FrameStream(const FrameStream&) = delete;
+    FrameStream& operator=(const FrameStream&) = delete;
+
+    // Layout the frames are rendered in
+    PixelFormat GetFormat() const;
+
+    // Start the stream, "-" writes to stdout, writes the header of a Y4M stream
+    bool Open(const std::filesystem::path& path, int width, int height);
+
+    // Memory the next frame is rendered into and the bytes from one row to the next
+    // Waits while the writer still has both frames
+    uint8_t* BeginFrame(size_t& stride);
+
+    // The frame is rendered, the writer takes it, false once a write has failed
+    bool EndFrame();
+
+    // Write the frames that are left and close the file, false if any write failed
+    bool Close();
+};
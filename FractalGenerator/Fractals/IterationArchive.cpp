@@ -0,0 +1,501 @@
+/*********************************************************************************************
+**
+**	File Name:		iterationarchive.cpp
+**	Description:	This is the file that contains the function definitions for the iteration
+**                  archive and the sink that writes it
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "IterationArchive.h"
+
+static const char s_magic[8] = { 'F', 'R', 'A', 'C', 'I', 'T', 'E', 'R' };
+static const uint32_t s_version = 1;
+
+// The index and every block start on this, so the values of a mapped tile are aligned
+static const uint64_t s_alignment = 16;
+
+static uint64_t Align(uint64_t offset)
+{
+    return (offset + s_alignment - 1) / s_alignment * s_alignment;
+}
+
+// Tiles of an image in rows from the top left, the last column and row cut at the edge
+static Tile TileOf(const IterationArchiveHeader& header, size_t tile)
+{
+    const size_t columns = (header.width + header.tileWidth - 1) / header.tileWidth;
+    const int x = static_cast<int>(tile % columns) * header.tileWidth;
+    const int y = static_cast<int>(tile / columns) * header.tileHeight;
+    return { x, y, std::min(x + header.tileWidth, header.width), std::min(y + header.tileHeight, header.height) };
+}
+
+ArchiveSink::ArchiveSink(const std::filesystem::path& path, const Fractal& fractal, const RenderRequest& request, bool compress)
+    : m_path(path), m_compress(compress)
+{
+    const RenderSettings settings = fractal.ResolveSettings(request.settings);
+
+    memcpy(m_header.magic, s_magic, sizeof(s_magic));
+    m_header.version = s_version;
+    m_header.values = static_cast<uint32_t>(IterationValues::Counts);
+    m_header.tileWidth = settings.tileWidth;
+    m_header.tileHeight = settings.tileHeight;
+    m_header.maxIterations = request.maxIterations;
+    m_header.indexSign = Fractal::GradientIndex(settings.language, 1) == 1 ? 1 : -1;
+    m_header.gradient = request.gradient;
+    m_header.language = settings.language;
+    m_header.precision = (request.forceDouble ? static_cast<uint32_t>(ARCHIVE_FORCE_DOUBLE) : 0u) |
+        (settings.perturbation ? static_cast<uint32_t>(ARCHIVE_PERTURBATION) : 0u) | (settings.fma ? static_cast<uint32_t>(ARCHIVE_FMA) : 0u);
+    strncpy(m_header.fractal, fractal.GetName(), sizeof(m_header.fractal) - 1);
+    m_header.mantissa = request.view.mantissa;
+    m_header.exponent = request.view.exponent;
+    m_header.aspect = request.view.aspect;
+
+    m_centre = request.view.cx.ToString() + " " + request.view.cy.ToString() + "\n";
+    m_header.centreBytes = static_cast<uint32_t>(m_centre.size());
+}
+
+PixelFormat ArchiveSink::GetFormat() const
+{
+    return PixelFormat::Iterations;
+}
+
+bool ArchiveSink::Open(int width, int height)
+{
+    const size_t columns = (width + m_header.tileWidth - 1) / m_header.tileWidth;
+    const size_t rows = (height + m_header.tileHeight - 1) / m_header.tileHeight;
+
+    m_header.width = width;
+    m_header.height = height;
+    m_header.tileCount = columns * rows;
+    m_header.indexOffset = 0;
+    m_index.clear();
+    m_index.reserve(m_header.tileCount);
+
+    m_file.open(m_path, std::ios::binary | std::ios::trunc);
+    if (!m_file)
+    {
+        return false;
+    }
+
+    // The index is left as zeros until every tile is written
+    const uint64_t indexOffset = Align(sizeof(m_header) + m_centre.size());
+    m_offset = Align(indexOffset + m_header.tileCount * sizeof(IterationArchiveTile));
+
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    m_file.write(m_centre.data(), m_centre.size());
+    const std::vector<char> zeros(static_cast<size_t>(m_offset - sizeof(m_header) - m_centre.size()));
+    m_file.write(zeros.data(), zeros.size());
+    return static_cast<bool>(m_file);
+}
+
+uint8_t* ArchiveSink::BeginBand(int y, int count, size_t& stride)
+{
+    m_stride = static_cast<size_t>(m_header.width) * sizeof(uint16_t);
+    m_bandY = y;
+    m_bandRows = count;
+    m_band.resize(m_stride * count);
+
+    stride = m_stride;
+    return m_band.data();
+}
+
+bool ArchiveSink::WriteTile(const Tile& tile)
+{
+    const int width = tile.xEnd - tile.xStart;
+    const size_t count = static_cast<size_t>(width) * (tile.yEnd - tile.yStart);
+
+    m_values.resize(count);
+    for (int y = tile.yStart; y < tile.yEnd; ++y)
+    {
+        memcpy(m_values.data() + static_cast<size_t>(y - tile.yStart) * width,
+            m_band.data() + (y - m_bandY) * m_stride + tile.xStart * sizeof(uint16_t), width * sizeof(uint16_t));
+    }
+
+    // Runs where they are smaller, the inside of the set and the outer bands are long runs
+    const uint16_t* block = m_values.data();
+    IterationArchiveTile entry = { m_offset, static_cast<uint32_t>(count * sizeof(uint16_t)), static_cast<uint32_t>(TileEncoding::Raw) };
+
+    if (m_compress)
+    {
+        m_runs.clear();
+        for (size_t i = 0; i < count && m_runs.size() < count;)
+        {
+            size_t run = 1;
+            while (i + run < count && run < UINT16_MAX && m_values[i + run] == m_values[i])
+            {
+                ++run;
+            }
+
+            m_runs.push_back(static_cast<uint16_t>(run));
+            m_runs.push_back(m_values[i]);
+            i += run;
+        }
+
+        if (m_runs.size() < count)
+        {
+            block = m_runs.data();
+            entry.bytes = static_cast<uint32_t>(m_runs.size() * sizeof(uint16_t));
+            entry.encoding = static_cast<uint32_t>(TileEncoding::Runs);
+        }
+    }
+
+    const uint64_t next = Align(m_offset + entry.bytes);
+    static const char zeros[s_alignment] = {};
+    m_file.write(reinterpret_cast<const char*>(block), entry.bytes);
+    m_file.write(zeros, next - m_offset - entry.bytes);
+
+    m_index.push_back(entry);
+    m_offset = next;
+    return static_cast<bool>(m_file);
+}
+
+bool ArchiveSink::EndBand()
+{
+    // The bands are whole rows of tiles, the last band ends at the bottom of the image
+    const size_t firstTile = m_index.size();
+    const size_t columns = (m_header.width + m_header.tileWidth - 1) / m_header.tileWidth;
+    const size_t bandTiles = (m_bandRows + m_header.tileHeight - 1) / m_header.tileHeight * columns;
+
+    if (m_bandY != static_cast<int>(firstTile / columns) * m_header.tileHeight)
+    {
+        return false;
+    }
+
+    for (size_t i = firstTile; i < firstTile + bandTiles; ++i)
+    {
+        if (!WriteTile(TileOf(m_header, i)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ArchiveSink::Close()
+{
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+
+    // Only a finished archive gets its index, the header points to it last
+    const bool finished = m_file && m_index.size() == m_header.tileCount;
+    if (finished)
+    {
+        m_header.indexOffset = Align(sizeof(m_header) + m_centre.size());
+        m_file.seekp(static_cast<std::streamoff>(m_header.indexOffset));
+        m_file.write(reinterpret_cast<const char*>(m_index.data()), m_index.size() * sizeof(IterationArchiveTile));
+        m_file.seekp(0);
+        m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    }
+
+    m_file.close();
+    m_band = std::vector<uint8_t>();
+    return finished && !m_file.fail();
+}
+
+IterationArchive::~IterationArchive()
+{
+    Close();
+}
+
+const IterationArchiveTile* IterationArchive::Index() const
+{
+    return reinterpret_cast<const IterationArchiveTile*>(m_data + m_header->indexOffset);
+}
+
+bool IterationArchive::Open(const std::filesystem::path& path)
+{
+    Close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(path.string().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || static_cast<unsigned long long>(size.QuadPart) < sizeof(IterationArchiveHeader))
+    {
+        Close();
+        return false;
+    }
+    m_bytes = static_cast<size_t>(size.QuadPart);
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        Close();
+        return false;
+    }
+#else
+    struct stat info;
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0 || fstat(m_file, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(IterationArchiveHeader))
+    {
+        Close();
+        return false;
+    }
+    m_bytes = static_cast<size_t>(info.st_size);
+
+    void* view = mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, m_file, 0);
+    if (view == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+#endif
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_header = reinterpret_cast<const IterationArchiveHeader*>(m_data);
+
+    // Everything the tiles are found with is checked here, the blocks as they are read
+    const IterationArchiveHeader& header = *m_header;
+    const bool valid = memcmp(header.magic, s_magic, sizeof(s_magic)) == 0 && header.version == s_version &&
+        header.values == static_cast<uint32_t>(IterationValues::Counts) &&
+        header.width > 0 && header.height > 0 && header.tileWidth > 0 && header.tileHeight > 0 &&
+        header.tileCount == static_cast<uint64_t>((header.width + header.tileWidth - 1) / header.tileWidth) *
+            ((header.height + header.tileHeight - 1) / header.tileHeight) &&
+        sizeof(header) + header.centreBytes <= m_bytes && header.indexOffset != 0 && header.indexOffset % s_alignment == 0 &&
+        header.indexOffset <= m_bytes && header.tileCount <= (m_bytes - header.indexOffset) / sizeof(IterationArchiveTile);
+
+    if (!valid)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void IterationArchive::Close()
+{
+#ifdef _WIN32
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_data)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_bytes);
+    }
+    if (m_file >= 0)
+    {
+        close(m_file);
+        m_file = -1;
+    }
+#endif
+
+    m_data = nullptr;
+    m_header = nullptr;
+    m_bytes = 0;
+}
+
+const IterationArchiveHeader& IterationArchive::GetHeader() const
+{
+    return *m_header;
+}
+
+std::string IterationArchive::GetFractal() const
+{
+    return std::string(m_header->fractal, strnlen(m_header->fractal, sizeof(m_header->fractal)));
+}
+
+std::string IterationArchive::GetCentre() const
+{
+    std::string centre(reinterpret_cast<const char*>(m_data + sizeof(IterationArchiveHeader)), m_header->centreBytes);
+    while (!centre.empty() && centre.back() == '\n')
+    {
+        centre.pop_back();
+    }
+    return centre;
+}
+
+Tile IterationArchive::GetTile(size_t tile) const
+{
+    return TileOf(*m_header, tile);
+}
+
+bool IterationArchive::ReadTile(size_t tile, uint16_t* values) const
+{
+    if (tile >= m_header->tileCount)
+    {
+        return false;
+    }
+
+    const Tile area = GetTile(tile);
+    const size_t count = static_cast<size_t>(area.xEnd - area.xStart) * (area.yEnd - area.yStart);
+    const IterationArchiveTile entry = Index()[tile];
+
+    if (entry.offset > m_bytes || entry.bytes > m_bytes - entry.offset)
+    {
+        return false;
+    }
+
+    const uint8_t* block = m_data + entry.offset;
+    switch (static_cast<TileEncoding>(entry.encoding))
+    {
+    case TileEncoding::Raw:
+    {
+        if (entry.bytes != count * sizeof(uint16_t))
+        {
+            return false;
+        }
+
+        memcpy(values, block, entry.bytes);
+        return true;
+    }
+    case TileEncoding::Runs:
+    {
+        // The runs must fill the tile exactly
+        size_t filled = 0;
+        for (size_t i = 0; i + 2 * sizeof(uint16_t) <= entry.bytes; i += 2 * sizeof(uint16_t))
+        {
+            uint16_t run[2];
+            memcpy(run, block + i, sizeof(run));
+            if (run[0] == 0 || run[0] > count - filled)
+            {
+                return false;
+            }
+
+            std::fill_n(values + filled, run[0], run[1]);
+            filled += run[0];
+        }
+
+        return filled == count;
+    }
+    default:
+    {
+        return false;
+    }
+    } // Switch
+}
+
+bool IterationArchive::Recolour(PosterSink& sink, const Tile& region, UINT gradient, size_t memoryBudget, const std::function<void(int, int)>& onProgress) const
+{
+    const IterationArchiveHeader& header = *m_header;
+    const PixelFormat format = sink.GetFormat();
+    const int pixelBytes = Fractal::PixelBytes(format);
+
+    if (format == PixelFormat::Iterations || region.xStart < 0 || region.yStart < 0 || region.xEnd > header.width ||
+        region.yEnd > header.height || region.xStart >= region.xEnd || region.yStart >= region.yEnd)
+    {
+        return false;
+    }
+
+    // Every count has one of 256 colours, they are worked out once
+    std::vector<uint8_t> colours(256 * pixelBytes);
+    for (int i = 0; i < 256; ++i)
+    {
+        Fractal::ColourPixel(colours.data() + i * pixelBytes, format, static_cast<uint8_t>(i), gradient);
+    }
+
+    const int width = region.xEnd - region.xStart, height = region.yEnd - region.yStart;
+    const size_t columns = (header.width + header.tileWidth - 1) / header.tileWidth;
+    const int firstColumn = region.xStart / header.tileWidth;
+    const int lastColumn = (region.xEnd - 1) / header.tileWidth;
+
+    // Bands end on the rows of tiles of the archive, so no tile is decoded twice
+    const size_t rowBytes = static_cast<size_t>(width) * pixelBytes;
+    size_t bandRows = memoryBudget / (rowBytes ? rowBytes : 1);
+    bandRows = std::max(bandRows - bandRows % header.tileHeight, static_cast<size_t>(header.tileHeight));
+
+    if (!sink.Open(width, height))
+    {
+        return false;
+    }
+
+    const int threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads(threadCount);
+
+    bool finished = true;
+    for (int y = region.yStart; y < region.yEnd && finished;)
+    {
+        const int bandEnd = std::min(static_cast<int>((y / header.tileHeight) * header.tileHeight + bandRows), region.yEnd);
+
+        size_t stride;
+        uint8_t* band = sink.BeginBand(y - region.yStart, bandEnd - y, stride);
+        if (!band)
+        {
+            finished = false;
+            break;
+        }
+
+        // The tiles of the band are shared out as the threads ask for them
+        const int firstRow = y / header.tileHeight, lastRow = (bandEnd - 1) / header.tileHeight;
+        const int bandColumns = lastColumn - firstColumn + 1;
+        const int bandTiles = bandColumns * (lastRow - firstRow + 1);
+        std::atomic<int> next = 0;
+        std::atomic<bool> damaged = false;
+
+        for (std::thread& thread : threads)
+        {
+            thread = std::thread([&]
+                {
+                    std::vector<uint16_t> values(static_cast<size_t>(header.tileWidth) * header.tileHeight);
+                    for (int i = next++; i < bandTiles; i = next++)
+                    {
+                        const size_t tile = (firstRow + i / bandColumns) * columns + firstColumn + i % bandColumns;
+                        const Tile area = GetTile(tile);
+                        if (!ReadTile(tile, values.data()))
+                        {
+                            damaged = true;
+                            return;
+                        }
+
+                        // The part of the tile in the region and the band
+                        const int x0 = std::max(area.xStart, region.xStart), x1 = std::min(area.xEnd, region.xEnd);
+                        const int y0 = std::max(area.yStart, y), y1 = std::min(area.yEnd, bandEnd);
+                        const int tileWidth = area.xEnd - area.xStart;
+
+                        for (int row = y0; row < y1; ++row)
+                        {
+                            const uint16_t* counts = values.data() + static_cast<size_t>(row - area.yStart) * tileWidth + (x0 - area.xStart);
+                            uint8_t* pixel = band + (row - y) * stride + static_cast<size_t>(x0 - region.xStart) * pixelBytes;
+                            for (int x = x0; x < x1; ++x, pixel += pixelBytes)
+                            {
+                                const uint8_t index = static_cast<uint8_t>(header.indexSign * *counts++);
+                                memcpy(pixel, colours.data() + index * pixelBytes, pixelBytes);
+                            }
+                        }
+                    }
+                });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        finished = sink.EndBand() && !damaged;
+        y = bandEnd;
+
+        if (finished && onProgress)
+        {
+            onProgress(y - region.yStart, height);
+        }
+    }
+
+    return sink.Close() && finished;
+}
@@ -0,0 +1,204 @@
+/*********************************************************************************************
+**
+**	File Name:		iterationarchive.h
+**	Description:	This is the header file that contains the class definitions for the
+**                  iteration archive, a file of the iteration counts of a render in tiles that
+**                  is recoloured and cropped later without running the kernels again
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Poster.h"
+
+// Layout of the file, little endian, every offset is from the start of the file
+//
+//   IterationArchiveHeader     fixed size, below
+//   centre                     centreBytes of text, "cx cy\n" as written by FixedPoint::ToString
+//   index                      at indexOffset (16 byte aligned), an IterationArchiveTile per tile
+//   tile blocks                one per tile, in the order of the index, each 16 byte aligned
+//
+// Tiles are in rows from the top left, the same as the tiles of a render, the last column and
+// row are cut at the edge of the image. A tile is its values in rows, raw or as runs
+// The index is written last, so a render that stopped before its last band leaves an archive
+// that does not open
+
+// Values of the pixels
+enum class IterationValues : uint32_t
+{
+    // uint16 iteration count of each pixel, the iteration limit inside the set
+    Counts = 0
+    // 1 is kept for smooth (fractional) counts, the kernels do not keep |z| at escape yet
+};
+
+// How a tile block is stored
+enum class TileEncoding : uint32_t
+{
+    // width * height uint16 values
+    Raw = 0,
+    // Pairs of uint16 (length, value) until the tile is full, lengths are 1 or more
+    Runs = 1
+};
+
+// Bits of the precision field, how the kernels rendered the counts
+enum ArchivePrecision : uint32_t
+{
+    ARCHIVE_FORCE_DOUBLE = 1,
+    ARCHIVE_PERTURBATION = 2,
+    ARCHIVE_FMA = 4
+};
+
+struct IterationArchiveHeader
+{
+    // "FRACITER" and the version of the layout
+    char magic[8];
+    uint32_t version;
+    uint32_t values;
+
+    // Size of the image and of its tiles
+    int32_t width;
+    int32_t height;
+    int32_t tileWidth;
+    int32_t tileHeight;
+
+    int32_t maxIterations;
+
+    // 1 if the gradient index of a count is the count, -1 if it is the count negated
+    // (the SIMD backends), so a recolour matches the render it came from
+    int32_t indexSign;
+
+    // ID_GRADIENT_* and ID_LANGUAGE_* of the render, the gradient is the default of a recolour
+    uint32_t gradient;
+    uint32_t language;
+
+    // ArchivePrecision bits
+    uint32_t precision;
+    uint32_t reserved;
+
+    // Name of the fractal, 0 terminated
+    char fractal[32];
+
+    // Width of the view as mantissa * 2^exponent and its height over its width
+    // The exact centre is the text that follows the header
+    double mantissa;
+    int32_t exponent;
+    uint32_t centreBytes;
+    double aspect;
+
+    uint64_t tileCount;
+
+    // Where the index starts, 0 if the archive was never finished
+    uint64_t indexOffset;
+};
+
+static_assert(sizeof(IterationArchiveHeader) == 128, "the archive header is a fixed layout");
+
+struct IterationArchiveTile
+{
+    uint64_t offset;
+    uint32_t bytes;
+    uint32_t encoding;
+};
+
+static_assert(sizeof(IterationArchiveTile) == 16, "the archive index is a fixed layout");
+
+// Writes the archive as a poster renders the counts band by band
+class ArchiveSink : public PosterSink
+{
+private:
+    std::filesystem::path m_path;
+    std::ofstream m_file;
+
+    IterationArchiveHeader m_header{};
+    std::string m_centre;
+    bool m_compress;
+
+    std::vector<IterationArchiveTile> m_index;
+    uint64_t m_offset{};
+
+    // Counts of the band being rendered
+    std::vector<uint8_t> m_band;
+    size_t m_stride{};
+    int m_bandY{};
+    int m_bandRows{};
+
+    // Values and runs of the tile being written
+    std::vector<uint16_t> m_values;
+    std::vector<uint16_t> m_runs;
+
+    bool WriteTile(const Tile& tile);
+
+public:
+    // The request is the one the poster renders, its settings are resolved the same way here
+    // so the tiles of the archive are the tiles of the bands
+    ArchiveSink(const std::filesystem::path& path, const Fractal& fractal, const RenderRequest& request, bool compress = true);
+
+    PixelFormat GetFormat() const override;
+    bool Open(int width, int height) override;
+    uint8_t* BeginBand(int y, int count, size_t& stride) override;
+    bool EndBand() override;
+    bool Close() override;
+};
+
+// An archive mapped into memory, its tiles are read in any order
+class IterationArchive
+{
+private:
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+
+    const uint8_t* m_data{};
+    size_t m_bytes{};
+
+    const IterationArchiveHeader* m_header{};
+
+    const IterationArchiveTile* Index() const;
+
+public:
+    IterationArchive() = default;
+
+    ~IterationArchive();
+
+    IterationArchive(const IterationArchive&) = delete;
+    IterationArchive& operator=(const IterationArchive&) = delete;
+
+    // Map an archive, false if it is not one or was never finished
+    bool Open(const std::filesystem::path& path);
+
+    void Close();
+
+    const IterationArchiveHeader& GetHeader() const;
+
+    std::string GetFractal() const;
+
+    // Exact centre of the view, "cx cy" in the text of FixedPoint::ToString
+    std::string GetCentre() const;
+
+    // Pixels a tile covers
+    Tile GetTile(size_t tile) const;
+
+    // Values of a tile in rows of its width, false if its block is damaged
+    bool ReadTile(size_t tile, uint16_t* values) const;
+
+    // Colour a region of the image with a gradient into a sink, in bands of whole rows of tiles
+    // Each tile is decoded once, the tiles of a band on all the cores
+    // onProgress gets the rows that are finished and the height of the region after each band
+    bool Recolour(
+        PosterSink& sink,
+        const Tile& region,
+        UINT gradient,
+        size_t memoryBudget,
+        const std::function<void(int, int)>& onProgress = nullptr) const;
+};
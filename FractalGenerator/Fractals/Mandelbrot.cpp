@@ -9,15 +9,15 @@
 **
 **********************************************************************************************/
 
-#include "mandelbrot.h"
+#include "Mandelbrot.h"
 
-int Mandelbrot::GetCPPIterF(float xval, float yval) const
+int Mandelbrot::GetCPPIterF(float xval, float yval, int maxIterations) const
 {
     float x = 0.0, y = 0.0;
     float r = 0;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations)
+    while (r < m_rMax && n < maxIterations)
     {
         float x2 = x * x;
         float y2 = y * y;
@@ -32,13 +32,13 @@ int Mandelbrot::GetCPPIterF(float xval, float yval) const
     return n;
 }
 
-int Mandelbrot::GetCPPIterD(double xval, double yval) const
+int Mandelbrot::GetCPPIterD(double xval, double yval, int maxIterations) const
 {
     double x = 0.0, y = 0.0;
     double r = 0;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations)
+    while (r < m_rMax && n < maxIterations)
     {
         double x2 = x * x;
         double y2 = y * y;
@@ -52,28 +52,25 @@ int Mandelbrot::GetCPPIterD(double xval, double yval) const
     return n;
 }
 
-__m128i Mandelbrot::GetSSEIterF(__m128 xval, __m128 yval) const
+template<bool Fma>
+__m128i Mandelbrot::SSEIterF(__m128 xval, __m128 yval, int maxIterations) const
 {
     const __m128 rMax = _mm_set1_ps(m_rMax);
     __m128i n = _mm_setzero_si128();
     __m128 x = _mm_setzero_ps();
     __m128 y = _mm_setzero_ps();
-    __m128 x2 = _mm_setzero_ps();
     __m128 y2 = _mm_setzero_ps();
-    __m128 xy = _mm_setzero_ps();
     __m128 r = _mm_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m128 cmp = _mm_cmp_ps(rMax, r, _CMP_GT_OQ);
         if (!_mm_movemask_ps(cmp)) break;
 
-        x2 = _mm_mul_ps(x, x);
         y2 = _mm_mul_ps(y, y);
-        xy = _mm_mul_ps(x, y);
-        x = _mm_add_ps(_mm_sub_ps(x2, y2), xval);
-        y = _mm_add_ps(_mm_add_ps(xy, xy), yval);
-        r = _mm_add_ps(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
+        y = MulAdd<Fma>(_mm_add_ps(x, x), y, yval);
+        x = _mm_add_ps(MulSub<Fma>(x, x, y2), xval);
 
         __m128i bn = _mm_castps_si128(cmp);
         n = _mm_add_epi16(n, bn);
@@ -82,28 +79,30 @@ __m128i Mandelbrot::GetSSEIterF(__m128 xval, __m128 yval) const
     return n;
 }
 
-__m128i Mandelbrot::GetSSEIterD(__m128d xval, __m128d yval) const
+__m128i Mandelbrot::GetSSEIterF(__m128 xval, __m128 yval, int maxIterations, bool fma) const
+{
+    return fma ? SSEIterF<true>(xval, yval, maxIterations) : SSEIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m128i Mandelbrot::SSEIterD(__m128d xval, __m128d yval, int maxIterations) const
 {
     const __m128d rMax = _mm_set1_pd(m_rMax);
     __m128i n = _mm_setzero_si128();
     __m128d x = _mm_setzero_pd();
     __m128d y = _mm_setzero_pd();
-    __m128d x2 = _mm_setzero_pd();
     __m128d y2 = _mm_setzero_pd();
-    __m128d xy = _mm_setzero_pd();
     __m128d r = _mm_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m128d cmp = _mm_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm_movemask_pd(cmp)) break;
 
-        x2 = _mm_mul_pd(x, x);
         y2 = _mm_mul_pd(y, y);
-        xy = _mm_mul_pd(x, y);
-        x = _mm_add_pd(_mm_sub_pd(x2, y2), xval);
-        y = _mm_add_pd(_mm_add_pd(xy, xy), yval);
-        r = _mm_add_pd(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
+        y = MulAdd<Fma>(_mm_add_pd(x, x), y, yval);
+        x = _mm_add_pd(MulSub<Fma>(x, x, y2), xval);
 
         __m128i bn = _mm_castpd_si128(cmp);
         n = _mm_add_epi16(n, bn);
@@ -111,28 +110,30 @@ __m128i Mandelbrot::GetSSEIterD(__m128d xval, __m128d yval) const
     return n;
 }
 
-__m256i Mandelbrot::GetAVXIterF(__m256 xval, __m256 yval) const
+__m128i Mandelbrot::GetSSEIterD(__m128d xval, __m128d yval, int maxIterations, bool fma) const
+{
+    return fma ? SSEIterD<true>(xval, yval, maxIterations) : SSEIterD<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i Mandelbrot::AVXIterF(__m256 xval, __m256 yval, int maxIterations) const
 {
     const __m256 rMax = _mm256_set1_ps(m_rMax);
     __m256i n = _mm256_setzero_si256();
     __m256 x = _mm256_setzero_ps();
     __m256 y = _mm256_setzero_ps();
-    __m256 x2 = _mm256_setzero_ps();
     __m256 y2 = _mm256_setzero_ps();
-    __m256 xy = _mm256_setzero_ps();
     __m256 r = _mm256_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m256 cmp = _mm256_cmp_ps(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_ps(cmp)) break;
 
-        x2 = _mm256_mul_ps(x, x);
         y2 = _mm256_mul_ps(y, y);
-        xy = _mm256_mul_ps(x, y);
-        x = _mm256_add_ps(_mm256_sub_ps(x2, y2), xval);
-        y = _mm256_add_ps(_mm256_add_ps(xy, xy), yval);
-        r = _mm256_add_ps(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
+        y = MulAdd<Fma>(_mm256_add_ps(x, x), y, yval);
+        x = _mm256_add_ps(MulSub<Fma>(x, x, y2), xval);
 
         __m256i bn = _mm256_castps_si256(cmp);
         n = _mm256_add_epi16(n, bn);
@@ -141,28 +142,30 @@ __m256i Mandelbrot::GetAVXIterF(__m256 xval, __m256 yval) const
     return n;
 }
 
-__m256i Mandelbrot::GetAVXIterD(__m256d xval, __m256d yval) const
+__m256i Mandelbrot::GetAVXIterF(__m256 xval, __m256 yval, int maxIterations, bool fma) const
+{
+    return fma ? AVXIterF<true>(xval, yval, maxIterations) : AVXIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i Mandelbrot::AVXIterD(__m256d xval, __m256d yval, int maxIterations) const
 {
     const __m256d rMax = _mm256_set1_pd(m_rMax);
     __m256i n = _mm256_setzero_si256();
     __m256d x = _mm256_setzero_pd();
     __m256d y = _mm256_setzero_pd();
-    __m256d x2 = _mm256_setzero_pd();
     __m256d y2 = _mm256_setzero_pd();
-    __m256d xy = _mm256_setzero_pd();
     __m256d r = _mm256_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m256d cmp = _mm256_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_pd(cmp)) break;
 
-        x2 = _mm256_mul_pd(x, x);
         y2 = _mm256_mul_pd(y, y);
-        xy = _mm256_mul_pd(x, y);
-        x = _mm256_add_pd(_mm256_sub_pd(x2, y2), xval);
-        y = _mm256_add_pd(_mm256_add_pd(xy, xy), yval);
-        r = _mm256_add_pd(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
+        y = MulAdd<Fma>(_mm256_add_pd(x, x), y, yval);
+        x = _mm256_add_pd(MulSub<Fma>(x, x, y2), xval);
 
         __m256i bn = _mm256_castpd_si256(cmp);
         n = _mm256_add_epi16(n, bn);
@@ -170,3 +173,268 @@ __m256i Mandelbrot::GetAVXIterD(__m256d xval, __m256d yval) const
 
     return n;
 }
+
+__m256i Mandelbrot::GetAVXIterD(__m256d xval, __m256d yval, int maxIterations, bool fma) const
+{
+    return fma ? AVXIterD<true>(xval, yval, maxIterations) : AVXIterD<false>(xval, yval, maxIterations);
+}
+
+template<int N, bool Fma>
+void Mandelbrot::InterleaveAVXF(const __m256* xval, __m256 yval, __m256i* n, int maxIterations) const
+{
+    const __m256 rMax = _mm256_set1_ps(m_rMax);
+    __m256 x[N], y[N], r[N];
+
+    for (int k = 0; k < N; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_ps();
+        y[k] = _mm256_setzero_ps();
+        r[k] = _mm256_setzero_ps();
+    }
+
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        __m256 cmp[N];
+        __m256 active = _mm256_setzero_ps();
+
+        for (int k = 0; k < N; ++k)
+        {
+            cmp[k] = _mm256_cmp_ps(rMax, r[k], _CMP_GT_OQ);
+            active = _mm256_or_ps(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_ps(active)) break;
+
+        for (int k = 0; k < N; ++k)
+        {
+            __m256 y2 = _mm256_mul_ps(y[k], y[k]);
+            r[k] = MulAdd<Fma>(x[k], x[k], y2);
+            y[k] = MulAdd<Fma>(_mm256_add_ps(x[k], x[k]), y[k], yval);
+            x[k] = _mm256_add_ps(MulSub<Fma>(x[k], x[k], y2), xval[k]);
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castps_si256(cmp[k]));
+        }
+    }
+}
+
+void Mandelbrot::GetAVXIterFN(const __m256* xval, __m256 yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    switch (interleave)
+    {
+    case 2:
+    {
+        fma ? InterleaveAVXF<2, true>(xval, yval, n, maxIterations) : InterleaveAVXF<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXF<3, true>(xval, yval, n, maxIterations) : InterleaveAVXF<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXF<4, true>(xval, yval, n, maxIterations) : InterleaveAVXF<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterFN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
+
+template<int N, bool Fma>
+void Mandelbrot::InterleaveAVXD(const __m256d* xval, __m256d yval, __m256i* n, int maxIterations) const
+{
+    const __m256d rMax = _mm256_set1_pd(m_rMax);
+    __m256d x[N], y[N], r[N];
+
+    for (int k = 0; k < N; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_pd();
+        y[k] = _mm256_setzero_pd();
+        r[k] = _mm256_setzero_pd();
+    }
+
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        __m256d cmp[N];
+        __m256d active = _mm256_setzero_pd();
+
+        for (int k = 0; k < N; ++k)
+        {
+            cmp[k] = _mm256_cmp_pd(rMax, r[k], _CMP_GT_OQ);
+            active = _mm256_or_pd(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_pd(active)) break;
+
+        for (int k = 0; k < N; ++k)
+        {
+            __m256d y2 = _mm256_mul_pd(y[k], y[k]);
+            r[k] = MulAdd<Fma>(x[k], x[k], y2);
+            y[k] = MulAdd<Fma>(_mm256_add_pd(x[k], x[k]), y[k], yval);
+            x[k] = _mm256_add_pd(MulSub<Fma>(x[k], x[k], y2), xval[k]);
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castpd_si256(cmp[k]));
+        }
+    }
+}
+
+void Mandelbrot::GetAVXIterDN(const __m256d* xval, __m256d yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    switch (interleave)
+    {
+    case 2:
+    {
+        fma ? InterleaveAVXD<2, true>(xval, yval, n, maxIterations) : InterleaveAVXD<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXD<3, true>(xval, yval, n, maxIterations) : InterleaveAVXD<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXD<4, true>(xval, yval, n, maxIterations) : InterleaveAVXD<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterDN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
+
+bool Mandelbrot::GetReferenceOrbit(double cx, double cy, int maxIterations, std::vector<float>& zx, std::vector<float>& zy) const
+{
+    zx.clear();
+    zy.clear();
+
+    double x = 0.0, y = 0.0;
+
+    // Every Z up to and including the first one that escaped
+    for (int n = 0; n < maxIterations; ++n)
+    {
+        zx.push_back(static_cast<float>(x));
+        zy.push_back(static_cast<float>(y));
+
+        double x2 = x * x;
+        double y2 = y * y;
+        if (x2 + y2 >= m_rMax) break;
+
+        y = 2 * x * y + cy;
+        x = x2 - y2 + cx;
+    }
+    return true;
+}
+
+template<int N, bool Fma>
+void Mandelbrot::AVXIterPerturb(const ReferenceOrbit& orbit, const __m256* dcx, const __m256* dcy, __m256i* n, __m256* glitched, int maxIterations) const
+{
+    const __m256 rMax = _mm256_set1_ps(m_rMax);
+    const __m256 scale = _mm256_set1_ps(static_cast<float>(orbit.scale));
+    const int length = static_cast<int>(orbit.zx.size());
+    const float* zxs = orbit.zx.data();
+    const float* zys = orbit.zy.data();
+    const float* glitchRs = orbit.glitchR.data();
+
+    // Offsets to the reference, divided by the scale
+    __m256 a[N], b[N], r[N];
+    for (int k = 0; k < N; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        a[k] = _mm256_setzero_ps();
+        b[k] = _mm256_setzero_ps();
+        r[k] = _mm256_setzero_ps();
+        glitched[k] = _mm256_setzero_ps();
+    }
+
+    int i = 0;
+    for (; i < length; ++i)
+    {
+        // Glitched lanes stop, they are rendered again
+        __m256 cmp[N];
+        __m256 active = _mm256_setzero_ps();
+        for (int k = 0; k < N; ++k)
+        {
+            cmp[k] = _mm256_andnot_ps(glitched[k], _mm256_cmp_ps(rMax, r[k], _CMP_GT_OQ));
+            active = _mm256_or_ps(active, cmp[k]);
+        }
+        if (!_mm256_movemask_ps(active)) break;
+
+        // Shared by every vector, straight from the orbit
+        const __m256 zx = _mm256_broadcast_ss(zxs + i);
+        const __m256 zy = _mm256_broadcast_ss(zys + i);
+        const __m256 glitchR = _mm256_broadcast_ss(glitchRs + i);
+
+        for (int k = 0; k < N; ++k)
+        {
+            // z = Z + s * d
+            __m256 x = MulAdd<Fma>(scale, a[k], zx);
+            __m256 y = MulAdd<Fma>(scale, b[k], zy);
+            r[k] = MulAdd<Fma>(x, x, _mm256_mul_ps(y, y));
+
+            // The orbit came close to 0 where the reference did not, the offset has no precision left
+            // Lanes that escaped are far from 0, so they never count as glitched
+            glitched[k] = _mm256_or_ps(glitched[k], _mm256_cmp_ps(r[k], glitchR, _CMP_LT_OQ));
+
+            // d' = 2 Z d + s d^2 + dc = d (2 Z + s d) + dc, and 2 Z + s d is z + Z
+            const __m256 u = _mm256_add_ps(x, zx);
+            const __m256 v = _mm256_add_ps(y, zy);
+            const __m256 re = MulAdd<Fma>(a[k], u, NegMulAdd<Fma>(b[k], v, dcx[k]));
+            b[k] = MulAdd<Fma>(b[k], u, MulAdd<Fma>(a[k], v, dcy[k]));
+            a[k] = re;
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castps_si256(cmp[k]));
+        }
+    }
+
+    // Lanes still iterating when the reference escaped need Z the orbit does not have
+    if (i == length && length < maxIterations)
+    {
+        for (int k = 0; k < N; ++k)
+        {
+            glitched[k] = _mm256_or_ps(glitched[k], _mm256_cmp_ps(rMax, r[k], _CMP_GT_OQ));
+        }
+    }
+}
+
+void Mandelbrot::GetAVXIterPerturb(const ReferenceOrbit& orbit, const __m256* dcx, const __m256* dcy, __m256i* n, __m256* glitched, int vectors, int maxIterations, bool fma) const
+{
+    switch (vectors)
+    {
+    case 1:
+    {
+        fma ? AVXIterPerturb<1, true>(orbit, dcx, dcy, n, glitched, maxIterations) : AVXIterPerturb<1, false>(orbit, dcx, dcy, n, glitched, maxIterations);
+        break;
+    }
+    case 2:
+    {
+        fma ? AVXIterPerturb<2, true>(orbit, dcx, dcy, n, glitched, maxIterations) : AVXIterPerturb<2, false>(orbit, dcx, dcy, n, glitched, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? AVXIterPerturb<3, true>(orbit, dcx, dcy, n, glitched, maxIterations) : AVXIterPerturb<3, false>(orbit, dcx, dcy, n, glitched, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? AVXIterPerturb<4, true>(orbit, dcx, dcy, n, glitched, maxIterations) : AVXIterPerturb<4, false>(orbit, dcx, dcy, n, glitched, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterPerturb(orbit, dcx, dcy, n, glitched, vectors, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
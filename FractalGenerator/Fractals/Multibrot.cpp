@@ -9,15 +9,15 @@
 **
 **********************************************************************************************/
 
-#include "multibrot.h"
+#include "Multibrot.h"
 
-int Multibrot::GetCPPIterF(float xval, float yval) const
+int Multibrot::GetCPPIterF(float xval, float yval, int maxIterations) const
 {
     float x = 0.0, y = 0.0;
     float r = 0.0;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations) {
+    while (r < m_rMax && n < maxIterations) {
         float x2 = x * x;
         float x3 = x2 * x;
         float x4 = x3 * x;
@@ -39,13 +39,13 @@ int Multibrot::GetCPPIterF(float xval, float yval) const
     return n;
 }
 
-int Multibrot::GetCPPIterD(double xval, double yval) const
+int Multibrot::GetCPPIterD(double xval, double yval, int maxIterations) const
 {
     double x = 0.0, y = 0.0;
     double r = 0.0;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations) {
+    while (r < m_rMax && n < maxIterations) {
         double x2 = x * x;
         double x3 = x2 * x;
         double x4 = x3 * x;
@@ -67,7 +67,8 @@ int Multibrot::GetCPPIterD(double xval, double yval) const
     return n;
 }
 
-__m128i Multibrot::GetSSEIterF(__m128 xval, __m128 yval) const
+template<bool Fma>
+__m128i Multibrot::SSEIterF(__m128 xval, __m128 yval, int maxIterations) const
 {
     const __m128 rMax = _mm_set1_ps(m_rMax);
     __m128i n = _mm_setzero_si128();
@@ -75,7 +76,7 @@ __m128i Multibrot::GetSSEIterF(__m128 xval, __m128 yval) const
     __m128 y = _mm_setzero_ps();
     __m128 r = _mm_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m128 cmp = _mm_cmp_ps(rMax, r, _CMP_GT_OQ);
         if (!_mm_movemask_ps(cmp)) break;
@@ -90,13 +91,13 @@ __m128i Multibrot::GetSSEIterF(__m128 xval, __m128 yval) const
         __m128 y4 = _mm_mul_ps(y3, y);
         __m128 y5 = _mm_mul_ps(y4, y);
 
-        __m128 real1 = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(10), x3), y2); // 10x^3y^2
-        __m128 real2 = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(5), x), y4);   // 5xy^4
-        x = _mm_add_ps(_mm_add_ps(_mm_sub_ps(x5, real1), real2), xval);
+        __m128 real1 = _mm_mul_ps(_mm_set1_ps(10), x3); // 10x^3, times y^2
+        __m128 real2 = _mm_mul_ps(_mm_set1_ps(5), x);   // 5x, times y^4
+        x = _mm_add_ps(MulAdd<Fma>(real2, y4, NegMulAdd<Fma>(real1, y2, x5)), xval);
 
-        __m128 imag1 = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(5), x4), y);
+        __m128 imag1 = _mm_mul_ps(_mm_set1_ps(5), x4);
         __m128 imag2 = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(10), x2), y3);
-        y = _mm_add_ps(_mm_add_ps(_mm_sub_ps(imag1, imag2), y5), yval);
+        y = _mm_add_ps(_mm_add_ps(MulSub<Fma>(imag1, y, imag2), y5), yval);
 
         r = _mm_add_ps(x2, y2);
 
@@ -107,7 +108,13 @@ __m128i Multibrot::GetSSEIterF(__m128 xval, __m128 yval) const
     return n;
 }
 
-__m128i Multibrot::GetSSEIterD(__m128d xval, __m128d yval) const
+__m128i Multibrot::GetSSEIterF(__m128 xval, __m128 yval, int maxIterations, bool fma) const
+{
+    return fma ? SSEIterF<true>(xval, yval, maxIterations) : SSEIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m128i Multibrot::SSEIterD(__m128d xval, __m128d yval, int maxIterations) const
 {
     const __m128d rMax = _mm_set1_pd(m_rMax);
     __m128i n = _mm_setzero_si128();
@@ -117,7 +124,7 @@ __m128i Multibrot::GetSSEIterD(__m128d xval, __m128d yval) const
     __m128d abs_y = _mm_setzero_pd();
     __m128d r = _mm_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m128d cmp = _mm_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm_movemask_pd(cmp)) break;
@@ -125,12 +132,10 @@ __m128i Multibrot::GetSSEIterD(__m128d xval, __m128d yval) const
         abs_x = _mm_andnot_pd(_mm_set1_pd(-0.0), x);
         abs_y = _mm_andnot_pd(_mm_set1_pd(-0.0), y);
 
-        __m128d xy = _mm_mul_pd(abs_x, abs_y);
-        __m128d x2 = _mm_mul_pd(abs_x, abs_x);
         __m128d y2 = _mm_mul_pd(abs_y, abs_y);
-        x = _mm_add_pd(_mm_sub_pd(x2, y2), xval);
-        y = _mm_add_pd(_mm_add_pd(xy, xy), yval);
-        r = _mm_add_pd(x2, y2);
+        x = _mm_add_pd(MulSub<Fma>(abs_x, abs_x, y2), xval);
+        y = MulAdd<Fma>(_mm_add_pd(abs_x, abs_x), abs_y, yval);
+        r = MulAdd<Fma>(abs_x, abs_x, y2);
 
         __m128i bn = _mm_castpd_si128(cmp);
         n = _mm_add_epi16(n, bn);
@@ -139,7 +144,13 @@ __m128i Multibrot::GetSSEIterD(__m128d xval, __m128d yval) const
     return n;
 }
 
-__m256i Multibrot::GetAVXIterF(__m256 xval, __m256 yval) const
+__m128i Multibrot::GetSSEIterD(__m128d xval, __m128d yval, int maxIterations, bool fma) const
+{
+    return fma ? SSEIterD<true>(xval, yval, maxIterations) : SSEIterD<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i Multibrot::AVXIterF(__m256 xval, __m256 yval, int maxIterations) const
 {
     const __m256 rMax = _mm256_set1_ps(m_rMax);
     __m256i n = _mm256_setzero_si256();
@@ -147,7 +158,7 @@ __m256i Multibrot::GetAVXIterF(__m256 xval, __m256 yval) const
     __m256 y = _mm256_setzero_ps();
     __m256 r = _mm256_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m256 cmp = _mm256_cmp_ps(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_ps(cmp)) break;
@@ -162,13 +173,13 @@ __m256i Multibrot::GetAVXIterF(__m256 xval, __m256 yval) const
         __m256 y4 = _mm256_mul_ps(y3, y);
         __m256 y5 = _mm256_mul_ps(y4, y);
 
-        __m256 real1 = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(10), x3), y2);
-        __m256 real2 = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(5), x), y4);
-        x = _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(x5, real1), real2), xval);
+        __m256 real1 = _mm256_mul_ps(_mm256_set1_ps(10), x3);
+        __m256 real2 = _mm256_mul_ps(_mm256_set1_ps(5), x);
+        x = _mm256_add_ps(MulAdd<Fma>(real2, y4, NegMulAdd<Fma>(real1, y2, x5)), xval);
 
-        __m256 imag1 = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(5), x4), y);
+        __m256 imag1 = _mm256_mul_ps(_mm256_set1_ps(5), x4);
         __m256 imag2 = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(10), x2), y3);
-        y = _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(imag1, imag2), y5), yval);
+        y = _mm256_add_ps(_mm256_add_ps(MulSub<Fma>(imag1, y, imag2), y5), yval);
 
         r = _mm256_add_ps(x2, y2);
 
@@ -179,7 +190,13 @@ __m256i Multibrot::GetAVXIterF(__m256 xval, __m256 yval) const
     return n;
 }
 
-__m256i Multibrot::GetAVXIterD(__m256d xval, __m256d yval) const
+__m256i Multibrot::GetAVXIterF(__m256 xval, __m256 yval, int maxIterations, bool fma) const
+{
+    return fma ? AVXIterF<true>(xval, yval, maxIterations) : AVXIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i Multibrot::AVXIterD(__m256d xval, __m256d yval, int maxIterations) const
 {
     const __m256d rMax = _mm256_set1_pd(m_rMax);
     __m256i n = _mm256_setzero_si256();
@@ -189,7 +206,7 @@ __m256i Multibrot::GetAVXIterD(__m256d xval, __m256d yval) const
     __m256d abs_y = _mm256_setzero_pd();
     __m256d r = _mm256_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m256d cmp = _mm256_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_pd(cmp)) break;
@@ -197,12 +214,10 @@ __m256i Multibrot::GetAVXIterD(__m256d xval, __m256d yval) const
         abs_x = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
         abs_y = _mm256_andnot_pd(_mm256_set1_pd(-0.0), y);
 
-        __m256d xy = _mm256_mul_pd(abs_x, abs_y);
-        __m256d x2 = _mm256_mul_pd(abs_x, abs_x);
         __m256d y2 = _mm256_mul_pd(abs_y, abs_y);
-        x = _mm256_add_pd(_mm256_sub_pd(x2, y2), xval);
-        y = _mm256_add_pd(_mm256_add_pd(xy, xy), yval);
-        r = _mm256_add_pd(x2, y2);
+        x = _mm256_add_pd(MulSub<Fma>(abs_x, abs_x, y2), xval);
+        y = MulAdd<Fma>(_mm256_add_pd(abs_x, abs_x), abs_y, yval);
+        r = MulAdd<Fma>(abs_x, abs_x, y2);
 
         __m256i bn = _mm256_castpd_si256(cmp);
         n = _mm256_add_epi16(n, bn);
@@ -210,3 +225,163 @@ __m256i Multibrot::GetAVXIterD(__m256d xval, __m256d yval) const
 
     return n;
 }
+
+__m256i Multibrot::GetAVXIterD(__m256d xval, __m256d yval, int maxIterations, bool fma) const
+{
+    return fma ? AVXIterD<true>(xval, yval, maxIterations) : AVXIterD<false>(xval, yval, maxIterations);
+}
+
+template<int N, bool Fma>
+void Multibrot::InterleaveAVXF(const __m256* xval, __m256 yval, __m256i* n, int maxIterations) const
+{
+    const __m256 rMax = _mm256_set1_ps(m_rMax);
+    const __m256 five = _mm256_set1_ps(5);
+    const __m256 ten = _mm256_set1_ps(10);
+    __m256 x[N], y[N], r[N];
+
+    for (int k = 0; k < N; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_ps();
+        y[k] = _mm256_setzero_ps();
+        r[k] = _mm256_setzero_ps();
+    }
+
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        __m256 cmp[N];
+        __m256 active = _mm256_setzero_ps();
+
+        for (int k = 0; k < N; ++k)
+        {
+            cmp[k] = _mm256_cmp_ps(rMax, r[k], _CMP_GT_OQ);
+            active = _mm256_or_ps(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_ps(active)) break;
+
+        for (int k = 0; k < N; ++k)
+        {
+            __m256 x2 = _mm256_mul_ps(x[k], x[k]);
+            __m256 x3 = _mm256_mul_ps(x2, x[k]);
+            __m256 x4 = _mm256_mul_ps(x3, x[k]);
+            __m256 x5 = _mm256_mul_ps(x4, x[k]);
+
+            __m256 y2 = _mm256_mul_ps(y[k], y[k]);
+            __m256 y3 = _mm256_mul_ps(y2, y[k]);
+            __m256 y4 = _mm256_mul_ps(y3, y[k]);
+            __m256 y5 = _mm256_mul_ps(y4, y[k]);
+
+            __m256 real1 = _mm256_mul_ps(ten, x3);
+            __m256 real2 = _mm256_mul_ps(five, x[k]);
+            __m256 imag1 = _mm256_mul_ps(five, x4);
+            __m256 imag2 = _mm256_mul_ps(_mm256_mul_ps(ten, x2), y3);
+
+            x[k] = _mm256_add_ps(MulAdd<Fma>(real2, y4, NegMulAdd<Fma>(real1, y2, x5)), xval[k]);
+            y[k] = _mm256_add_ps(_mm256_add_ps(MulSub<Fma>(imag1, y[k], imag2), y5), yval);
+            r[k] = _mm256_add_ps(x2, y2);
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castps_si256(cmp[k]));
+        }
+    }
+}
+
+void Multibrot::GetAVXIterFN(const __m256* xval, __m256 yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    switch (interleave)
+    {
+    case 2:
+    {
+        fma ? InterleaveAVXF<2, true>(xval, yval, n, maxIterations) : InterleaveAVXF<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXF<3, true>(xval, yval, n, maxIterations) : InterleaveAVXF<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXF<4, true>(xval, yval, n, maxIterations) : InterleaveAVXF<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterFN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
+
+// Same iteration as GetAVXIterD, so the interleave never changes the counts
+template<int N, bool Fma>
+void Multibrot::InterleaveAVXD(const __m256d* xval, __m256d yval, __m256i* n, int maxIterations) const
+{
+    const __m256d rMax = _mm256_set1_pd(m_rMax);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d x[N], y[N], r[N];
+
+    for (int k = 0; k < N; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_pd();
+        y[k] = _mm256_setzero_pd();
+        r[k] = _mm256_setzero_pd();
+    }
+
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        __m256d cmp[N];
+        __m256d active = _mm256_setzero_pd();
+
+        for (int k = 0; k < N; ++k)
+        {
+            cmp[k] = _mm256_cmp_pd(rMax, r[k], _CMP_GT_OQ);
+            active = _mm256_or_pd(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_pd(active)) break;
+
+        for (int k = 0; k < N; ++k)
+        {
+            __m256d abs_x = _mm256_andnot_pd(sign, x[k]);
+            __m256d abs_y = _mm256_andnot_pd(sign, y[k]);
+
+            __m256d y2 = _mm256_mul_pd(abs_y, abs_y);
+            x[k] = _mm256_add_pd(MulSub<Fma>(abs_x, abs_x, y2), xval[k]);
+            y[k] = MulAdd<Fma>(_mm256_add_pd(abs_x, abs_x), abs_y, yval);
+            r[k] = MulAdd<Fma>(abs_x, abs_x, y2);
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castpd_si256(cmp[k]));
+        }
+    }
+}
+
+void Multibrot::GetAVXIterDN(const __m256d* xval, __m256d yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    switch (interleave)
+    {
+    case 2:
+    {
+        fma ? InterleaveAVXD<2, true>(xval, yval, n, maxIterations) : InterleaveAVXD<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXD<3, true>(xval, yval, n, maxIterations) : InterleaveAVXD<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXD<4, true>(xval, yval, n, maxIterations) : InterleaveAVXD<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterDN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
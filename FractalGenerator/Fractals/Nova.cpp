@@ -9,15 +9,15 @@
 **
 **********************************************************************************************/
 
-#include "nova.h"
+#include "Nova.h"
 
-int Nova::GetCPPIterF(float xval, float yval) const
+int Nova::GetCPPIterF(float xval, float yval, int maxIterations) const
 {
     float x = 0.0, y = 0.0;
     float r = 0.0;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations) {
+    while (r < m_rMax && n < maxIterations) {
         float x2 = x * x;
         float x3 = x2 * x;
         float y2 = y * y;
@@ -48,13 +48,13 @@ int Nova::GetCPPIterF(float xval, float yval) const
     return n;
 }
 
-int Nova::GetCPPIterD(double xval, double yval) const
+int Nova::GetCPPIterD(double xval, double yval, int maxIterations) const
 {
     double x = 0.0, y = 0.0;
     double r = 0.0;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations) {
+    while (r < m_rMax && n < maxIterations) {
         double x2 = x * x;
         double x3 = x2 * x;
         double y2 = y * y;
@@ -85,22 +85,22 @@ int Nova::GetCPPIterD(double xval, double yval) const
     return n;
 }
 
-__m128i Nova::GetSSEIterF(__m128 xval, __m128 yval) const
+__m128i Nova::GetSSEIterF(__m128 xval, __m128 yval, int maxIterations, bool fma) const
 {
     return _mm_setzero_si128();
 }
 
-__m128i Nova::GetSSEIterD(__m128d xval, __m128d yval) const
+__m128i Nova::GetSSEIterD(__m128d xval, __m128d yval, int maxIterations, bool fma) const
 {
     return _mm_setzero_si128();
 }
 
-__m256i Nova::GetAVXIterF(__m256 xval, __m256 yval) const
+__m256i Nova::GetAVXIterF(__m256 xval, __m256 yval, int maxIterations, bool fma) const
 {
     return _mm256_setzero_si256();
 }
 
-__m256i Nova::GetAVXIterD(__m256d xval, __m256d yval) const
+__m256i Nova::GetAVXIterD(__m256d xval, __m256d yval, int maxIterations, bool fma) const
 {
     return _mm256_setzero_si256();
 }
@@ -16,22 +16,37 @@
 class Nova : public Fractal
 {
 private:
-    int GetCPPIterF(float xval, float yval) const override;
+    int GetCPPIterF(float xval, float yval, int maxIterations) const override;
 
-    int GetCPPIterD(double xval, double yval) const override;
+    int GetCPPIterD(double xval, double yval, int maxIterations) const override;
 
-    __m128i GetSSEIterF(__m128 xval, __m128 yval) const override;
+    TARGET_AVX2 __m128i GetSSEIterF(__m128 xval, __m128 yval, int maxIterations, bool fma) const override;
 
-    __m128i GetSSEIterD(__m128d xval, __m128d yval) const override;
+    TARGET_AVX2 __m128i GetSSEIterD(__m128d xval, __m128d yval, int maxIterations, bool fma) const override;
 
-    __m256i GetAVXIterF(__m256 xval, __m256 yval) const override;
+    TARGET_AVX2 __m256i GetAVXIterF(__m256 xval, __m256 yval, int maxIterations, bool fma) const override;
 
-    __m256i GetAVXIterD(__m256d xval, __m256d yval) const override;
+    TARGET_AVX2 __m256i GetAVXIterD(__m256d xval, __m256d yval, int maxIterations, bool fma) const override;
 
 public:
-    Nova(std::shared_ptr<App> app) : Fractal(app, -2.5, 2.5, -2.5, 2.75)
+    Nova(std::shared_ptr<RenderHost> host) : Fractal(host, -2.5, 2.5, -2.5, 2.75)
     {
     }
 
     ~Nova() {}
+
+    std::unique_ptr<Fractal> Clone() const override
+    {
+        return std::make_unique<Nova>(*this);
+    }
+
+    const char* GetName() const override
+    {
+        return "Nova";
+    }
+
+    bool HasSIMDKernels() const override
+    {
+        return false;
+    }
 };
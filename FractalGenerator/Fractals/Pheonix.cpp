@@ -9,9 +9,9 @@
 **
 **********************************************************************************************/
 
-#include "pheonix.h"
+#include "Pheonix.h"
 
-int Pheonix::GetCPPIterF(float xval, float yval) const
+int Pheonix::GetCPPIterF(float xval, float yval, int maxIterations) const
 {
     float px = -0.49f, py = 0.21f;
     float x = 0.0f, y = 0.0f;
@@ -19,7 +19,7 @@ int Pheonix::GetCPPIterF(float xval, float yval) const
     float r = 0.0f;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations)
+    while (r < m_rMax && n < maxIterations)
     {
         float x2 = x * x;
         float y2 = y * y;
@@ -38,7 +38,7 @@ int Pheonix::GetCPPIterF(float xval, float yval) const
     return n;
 }
 
-int Pheonix::GetCPPIterD(double xval, double yval) const
+int Pheonix::GetCPPIterD(double xval, double yval, int maxIterations) const
 {
     double px = -0.49, py = 0.21;
     double x = 0.0, y = 0.0;
@@ -46,7 +46,7 @@ int Pheonix::GetCPPIterD(double xval, double yval) const
     double r = 0.0;
     int n = 0;
 
-    while (r < m_rMax && n < m_maxIterations)
+    while (r < m_rMax && n < maxIterations)
     {
         double x2 = x * x;
         double y2 = y * y;
@@ -65,7 +65,8 @@ int Pheonix::GetCPPIterD(double xval, double yval) const
     return n;
 }
 
-__m128i Pheonix::GetSSEIterF(__m128 xval, __m128 yval) const
+template<bool Fma>
+__m128i Pheonix::SSEIterF(__m128 xval, __m128 yval, int maxIterations) const
 {
     const __m128 rMax = _mm_set1_ps(m_rMax);
     const __m128 px = _mm_set1_ps(-0.49f);
@@ -77,27 +78,23 @@ __m128i Pheonix::GetSSEIterF(__m128 xval, __m128 yval) const
     __m128 yprev = _mm_setzero_ps();
     __m128 r = _mm_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m128 cmp = _mm_cmp_ps(rMax, r, _CMP_GT_OQ);
         if (!_mm_movemask_ps(cmp)) break;
 
-        __m128 x2 = _mm_mul_ps(x, x);
         __m128 y2 = _mm_mul_ps(y, y);
-        __m128 pValx = _mm_mul_ps(px, xprev);
-        __m128 pValy = _mm_mul_ps(py, yprev);
 
-        __m128 xtemp = _mm_add_ps(pValx, xval);
-        xtemp = _mm_add_ps(xtemp, _mm_sub_ps(x2, y2));
+        __m128 xtemp = MulAdd<Fma>(px, xprev, xval);
+        xtemp = _mm_add_ps(xtemp, MulSub<Fma>(x, x, y2));
 
-        __m128 ytemp = _mm_add_ps(pValy, yval);
-        __m128 xy = _mm_mul_ps(x, y);
-        ytemp = _mm_add_ps(ytemp, _mm_add_ps(xy, xy)); // 2xy
+        __m128 ytemp = MulAdd<Fma>(py, yprev, yval);
+        ytemp = MulAdd<Fma>(_mm_add_ps(x, x), y, ytemp); // 2xy
 
         xprev = x;
         yprev = y;
 
-        r = _mm_add_ps(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
         x = xtemp;
         y = ytemp;
 
@@ -108,7 +105,13 @@ __m128i Pheonix::GetSSEIterF(__m128 xval, __m128 yval) const
     return n;
 }
 
-__m128i Pheonix::GetSSEIterD(__m128d xval, __m128d yval) const
+__m128i Pheonix::GetSSEIterF(__m128 xval, __m128 yval, int maxIterations, bool fma) const
+{
+    return fma ? SSEIterF<true>(xval, yval, maxIterations) : SSEIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m128i Pheonix::SSEIterD(__m128d xval, __m128d yval, int maxIterations) const
 {
     const __m128d rMax = _mm_set1_pd(m_rMax);
     const __m128d px = _mm_set1_pd(-0.49);
@@ -120,27 +123,23 @@ __m128i Pheonix::GetSSEIterD(__m128d xval, __m128d yval) const
     __m128d yprev = _mm_setzero_pd();
     __m128d r = _mm_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m128d cmp = _mm_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm_movemask_pd(cmp)) break;
 
-        __m128d x2 = _mm_mul_pd(x, x);
         __m128d y2 = _mm_mul_pd(y, y);
-        __m128d pValx = _mm_mul_pd(px, xprev);
-        __m128d pValy = _mm_mul_pd(py, yprev);
 
-        __m128d xtemp = _mm_add_pd(pValx, xval);
-        xtemp = _mm_add_pd(xtemp, _mm_sub_pd(x2, y2));
+        __m128d xtemp = MulAdd<Fma>(px, xprev, xval);
+        xtemp = _mm_add_pd(xtemp, MulSub<Fma>(x, x, y2));
 
-        __m128d ytemp = _mm_add_pd(pValy, yval);
-        __m128d xy = _mm_mul_pd(x, y);
-        ytemp = _mm_add_pd(ytemp, _mm_add_pd(xy, xy)); // 2xy
+        __m128d ytemp = MulAdd<Fma>(py, yprev, yval);
+        ytemp = MulAdd<Fma>(_mm_add_pd(x, x), y, ytemp); // 2xy
 
         xprev = x;
         yprev = y;
 
-        r = _mm_add_pd(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
         x = xtemp;
         y = ytemp;
 
@@ -151,7 +150,13 @@ __m128i Pheonix::GetSSEIterD(__m128d xval, __m128d yval) const
     return n;
 }
 
-__m256i Pheonix::GetAVXIterF(__m256 xval, __m256 yval) const
+__m128i Pheonix::GetSSEIterD(__m128d xval, __m128d yval, int maxIterations, bool fma) const
+{
+    return fma ? SSEIterD<true>(xval, yval, maxIterations) : SSEIterD<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i Pheonix::AVXIterF(__m256 xval, __m256 yval, int maxIterations) const
 {
     const __m256 rMax = _mm256_set1_ps(m_rMax);
     const __m256 px = _mm256_set1_ps(-0.49f);
@@ -163,27 +168,23 @@ __m256i Pheonix::GetAVXIterF(__m256 xval, __m256 yval) const
     __m256 yprev = _mm256_setzero_ps();
     __m256 r = _mm256_setzero_ps();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m256 cmp = _mm256_cmp_ps(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_ps(cmp)) break;
 
-        __m256 x2 = _mm256_mul_ps(x, x);
         __m256 y2 = _mm256_mul_ps(y, y);
-        __m256 pValx = _mm256_mul_ps(px, xprev);
-        __m256 pValy = _mm256_mul_ps(py, yprev);
 
-        __m256 xtemp = _mm256_add_ps(pValx, xval);
-        xtemp = _mm256_add_ps(xtemp, _mm256_sub_ps(x2, y2));
+        __m256 xtemp = MulAdd<Fma>(px, xprev, xval);
+        xtemp = _mm256_add_ps(xtemp, MulSub<Fma>(x, x, y2));
 
-        __m256 ytemp = _mm256_add_ps(pValy, yval);
-        __m256 xy = _mm256_mul_ps(x, y);
-        ytemp = _mm256_add_ps(ytemp, _mm256_add_ps(xy, xy)); // 2xy
+        __m256 ytemp = MulAdd<Fma>(py, yprev, yval);
+        ytemp = MulAdd<Fma>(_mm256_add_ps(x, x), y, ytemp); // 2xy
 
         xprev = x;
         yprev = y;
 
-        r = _mm256_add_ps(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
         x = xtemp;
         y = ytemp;
 
@@ -194,7 +195,13 @@ __m256i Pheonix::GetAVXIterF(__m256 xval, __m256 yval) const
     return n;
 }
 
-__m256i Pheonix::GetAVXIterD(__m256d xval, __m256d yval) const
+__m256i Pheonix::GetAVXIterF(__m256 xval, __m256 yval, int maxIterations, bool fma) const
+{
+    return fma ? AVXIterF<true>(xval, yval, maxIterations) : AVXIterF<false>(xval, yval, maxIterations);
+}
+
+template<bool Fma>
+__m256i Pheonix::AVXIterD(__m256d xval, __m256d yval, int maxIterations) const
 {
     const __m256d rMax = _mm256_set1_pd(m_rMax);
     const __m256d px = _mm256_set1_pd(-0.49);
@@ -206,27 +213,23 @@ __m256i Pheonix::GetAVXIterD(__m256d xval, __m256d yval) const
     __m256d yprev = _mm256_setzero_pd();
     __m256d r = _mm256_setzero_pd();
 
-    for (int i = 0; i < m_maxIterations; ++i)
+    for (int i = 0; i < maxIterations; ++i)
     {
         __m256d cmp = _mm256_cmp_pd(rMax, r, _CMP_GT_OQ);
         if (!_mm256_movemask_pd(cmp)) break;
 
-        __m256d x2 = _mm256_mul_pd(x, x);
         __m256d y2 = _mm256_mul_pd(y, y);
-        __m256d pValx = _mm256_mul_pd(px, xprev);
-        __m256d pValy = _mm256_mul_pd(py, yprev);
 
-        __m256d xtemp = _mm256_add_pd(pValx, xval);
-        xtemp = _mm256_add_pd(xtemp, _mm256_sub_pd(x2, y2));
+        __m256d xtemp = MulAdd<Fma>(px, xprev, xval);
+        xtemp = _mm256_add_pd(xtemp, MulSub<Fma>(x, x, y2));
 
-        __m256d ytemp = _mm256_add_pd(pValy, yval);
-        __m256d xy = _mm256_mul_pd(x, y);
-        ytemp = _mm256_add_pd(ytemp, _mm256_add_pd(xy, xy)); // 2xy
+        __m256d ytemp = MulAdd<Fma>(py, yprev, yval);
+        ytemp = MulAdd<Fma>(_mm256_add_pd(x, x), y, ytemp); // 2xy
 
         xprev = x;
         yprev = y;
 
-        r = _mm256_add_pd(x2, y2);
+        r = MulAdd<Fma>(x, x, y2);
         x = xtemp;
         y = ytemp;
 
@@ -236,3 +239,178 @@ __m256i Pheonix::GetAVXIterD(__m256d xval, __m256d yval) const
 
     return n;
 }
+
+__m256i Pheonix::GetAVXIterD(__m256d xval, __m256d yval, int maxIterations, bool fma) const
+{
+    return fma ? AVXIterD<true>(xval, yval, maxIterations) : AVXIterD<false>(xval, yval, maxIterations);
+}
+
+template<int N, bool Fma>
+void Pheonix::InterleaveAVXF(const __m256* xval, __m256 yval, __m256i* n, int maxIterations) const
+{
+    const __m256 rMax = _mm256_set1_ps(m_rMax);
+    const __m256 px = _mm256_set1_ps(-0.49f);
+    const __m256 py = _mm256_set1_ps(0.21f);
+    __m256 x[N], y[N], xprev[N], yprev[N], r[N], live[N];
+
+    for (int k = 0; k < N; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_ps();
+        y[k] = _mm256_setzero_ps();
+        xprev[k] = _mm256_setzero_ps();
+        yprev[k] = _mm256_setzero_ps();
+        r[k] = _mm256_setzero_ps();
+        live[k] = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    }
+
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        __m256 cmp[N];
+        __m256 active = _mm256_setzero_ps();
+
+        for (int k = 0; k < N; ++k)
+        {
+            // An orbit can come back inside the boundary, so a vector stops counting where the
+            // single vector kernel would have stopped iterating (once all of its lanes are outside)
+            cmp[k] = _mm256_and_ps(_mm256_cmp_ps(rMax, r[k], _CMP_GT_OQ), live[k]);
+            live[k] = _mm256_testz_ps(cmp[k], cmp[k]) ? _mm256_setzero_ps() : live[k];
+            active = _mm256_or_ps(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_ps(active)) break;
+
+        for (int k = 0; k < N; ++k)
+        {
+            __m256 y2 = _mm256_mul_ps(y[k], y[k]);
+
+            __m256 xtemp = MulAdd<Fma>(px, xprev[k], xval[k]);
+            xtemp = _mm256_add_ps(xtemp, MulSub<Fma>(x[k], x[k], y2));
+
+            __m256 ytemp = MulAdd<Fma>(py, yprev[k], yval);
+            ytemp = MulAdd<Fma>(_mm256_add_ps(x[k], x[k]), y[k], ytemp); // 2xy
+
+            xprev[k] = x[k];
+            yprev[k] = y[k];
+
+            r[k] = MulAdd<Fma>(x[k], x[k], y2);
+            x[k] = xtemp;
+            y[k] = ytemp;
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castps_si256(cmp[k]));
+        }
+    }
+}
+
+void Pheonix::GetAVXIterFN(const __m256* xval, __m256 yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    switch (interleave)
+    {
+    case 2:
+    {
+        fma ? InterleaveAVXF<2, true>(xval, yval, n, maxIterations) : InterleaveAVXF<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXF<3, true>(xval, yval, n, maxIterations) : InterleaveAVXF<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXF<4, true>(xval, yval, n, maxIterations) : InterleaveAVXF<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterFN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
+
+template<int N, bool Fma>
+void Pheonix::InterleaveAVXD(const __m256d* xval, __m256d yval, __m256i* n, int maxIterations) const
+{
+    const __m256d rMax = _mm256_set1_pd(m_rMax);
+    const __m256d px = _mm256_set1_pd(-0.49);
+    const __m256d py = _mm256_set1_pd(0.21);
+    __m256d x[N], y[N], xprev[N], yprev[N], r[N], live[N];
+
+    for (int k = 0; k < N; ++k)
+    {
+        n[k] = _mm256_setzero_si256();
+        x[k] = _mm256_setzero_pd();
+        y[k] = _mm256_setzero_pd();
+        xprev[k] = _mm256_setzero_pd();
+        yprev[k] = _mm256_setzero_pd();
+        r[k] = _mm256_setzero_pd();
+        live[k] = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+    }
+
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        __m256d cmp[N];
+        __m256d active = _mm256_setzero_pd();
+
+        for (int k = 0; k < N; ++k)
+        {
+            // An orbit can come back inside the boundary, so a vector stops counting where the
+            // single vector kernel would have stopped iterating (once all of its lanes are outside)
+            cmp[k] = _mm256_and_pd(_mm256_cmp_pd(rMax, r[k], _CMP_GT_OQ), live[k]);
+            live[k] = _mm256_testz_pd(cmp[k], cmp[k]) ? _mm256_setzero_pd() : live[k];
+            active = _mm256_or_pd(active, cmp[k]);
+        }
+
+        // Stop once every lane of every vector has escaped
+        if (!_mm256_movemask_pd(active)) break;
+
+        for (int k = 0; k < N; ++k)
+        {
+            __m256d y2 = _mm256_mul_pd(y[k], y[k]);
+
+            __m256d xtemp = MulAdd<Fma>(px, xprev[k], xval[k]);
+            xtemp = _mm256_add_pd(xtemp, MulSub<Fma>(x[k], x[k], y2));
+
+            __m256d ytemp = MulAdd<Fma>(py, yprev[k], yval);
+            ytemp = MulAdd<Fma>(_mm256_add_pd(x[k], x[k]), y[k], ytemp); // 2xy
+
+            xprev[k] = x[k];
+            yprev[k] = y[k];
+
+            r[k] = MulAdd<Fma>(x[k], x[k], y2);
+            x[k] = xtemp;
+            y[k] = ytemp;
+
+            n[k] = _mm256_add_epi16(n[k], _mm256_castpd_si256(cmp[k]));
+        }
+    }
+}
+
+void Pheonix::GetAVXIterDN(const __m256d* xval, __m256d yval, __m256i* n, int interleave, int maxIterations, bool fma) const
+{
+    switch (interleave)
+    {
+    case 2:
+    {
+        fma ? InterleaveAVXD<2, true>(xval, yval, n, maxIterations) : InterleaveAVXD<2, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 3:
+    {
+        fma ? InterleaveAVXD<3, true>(xval, yval, n, maxIterations) : InterleaveAVXD<3, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    case 4:
+    {
+        fma ? InterleaveAVXD<4, true>(xval, yval, n, maxIterations) : InterleaveAVXD<4, false>(xval, yval, n, maxIterations);
+        break;
+    }
+    default:
+    {
+        Fractal::GetAVXIterDN(xval, yval, n, interleave, maxIterations, fma);
+        break;
+    }
+    } // Switch
+}
@@ -0,0 +1,54 @@
+/*********************************************************************************************
+**
+**	File Name:		platform.h
+**	Description:	This is the header file that contains the few Windows types and functions
+**                  the render core uses, so the core also builds on other platforms
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+// Functions that use AVX2 and FMA, only called once the backend or CPUID picked them
+// Everything else of the core runs on any x86-64, MSVC takes the intrinsics without it
+#ifdef _MSC_VER
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+#ifdef _WIN32
+
+#include <Windows.h>
+
+#else
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+typedef unsigned int UINT;
+typedef uint16_t WORD;
+typedef uint8_t BYTE;
+
+// Pixel position on the window
+struct POINT
+{
+    long x;
+    long y;
+};
+
+// aligned_alloc wants the size to be a multiple of the alignment
+inline void* _aligned_malloc(size_t size, size_t alignment)
+{
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+inline void _aligned_free(void* memory)
+{
+    std::free(memory);
+}
+
+#endif
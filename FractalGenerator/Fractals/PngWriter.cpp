@@ -0,0 +1,283 @@
+/*********************************************************************************************
+**
+**	File Name:		pngwriter.cpp
+**	Description:	This is the file that contains the function definitions for the PNG
+**                  writer
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "Deflate.h"
+#include "PngWriter.h"
+
+// Bytes of filtered rows compressed as one block, enough that the blocks compress nearly as
+// well as one stream and small enough to spread a band over every thread
+static const size_t s_blockBytes = 256 * 1024;
+
+// Predictor of the Paeth filter, whichever of left, up and up left is closest to left + up - up left
+static int Paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+PngWriter::PngWriter(int threads)
+    : m_threads(threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency())))
+{
+}
+
+bool PngWriter::Open(const std::filesystem::path& path, int width, int height)
+{
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file)
+    {
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_rows = 0;
+    m_adler = 1;
+    m_previous.assign(static_cast<size_t>(width) * 3, 0);
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    m_file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    // Width, height, 8 bits per sample, RGB, deflate, adaptive filters, no interlace
+    uint8_t header[13] = {
+        static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16), static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+        static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16), static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+        8, 2, 0, 0, 0 };
+    WriteChunk("IHDR", header, sizeof(header));
+
+    return static_cast<bool>(m_file);
+}
+
+bool PngWriter::WriteRows(const uint8_t* rows, size_t stride, int count)
+{
+    if (count <= 0)
+    {
+        return static_cast<bool>(m_file);
+    }
+
+    const size_t rowBytes = static_cast<size_t>(m_width) * 3;
+    const int blockRows = std::max(1, static_cast<int>(s_blockBytes / (rowBytes + 1)));
+    const int blockCount = (count + blockRows - 1) / blockRows;
+    const bool last = m_rows + count >= m_height;
+
+    // Each thread filters and compresses whole blocks, the filters of a block's first row
+    // read the row above it, which is in the same call or kept from the last one
+    m_blocks.resize(blockCount);
+    std::vector<uint32_t> adlers(blockCount);
+    std::atomic<int> nextBlock = 0;
+
+    auto worker = [&]
+        {
+            Deflate deflate;
+            std::vector<uint8_t> filtered;
+
+            for (int block = nextBlock.fetch_add(1); block < blockCount; block = nextBlock.fetch_add(1))
+            {
+                const int first = block * blockRows, end = std::min(first + blockRows, count);
+
+                filtered.resize((end - first) * (rowBytes + 1));
+                for (int y = first; y < end; ++y)
+                {
+                    const uint8_t* previous = y > 0 ? rows + (y - 1) * stride : m_previous.data();
+                    FilterRow(rows + y * stride, previous, rowBytes, &filtered[(y - first) * (rowBytes + 1)]);
+                }
+
+                adlers[block] = Adler32(1, filtered.data(), filtered.size());
+                m_blocks[block].clear();
+                deflate.Compress(filtered.data(), filtered.size(), last && end == count, m_blocks[block]);
+            }
+        };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < std::min(m_threads, blockCount); ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // The zlib stream starts in the first chunk
+    if (m_rows == 0)
+    {
+        static const uint8_t header[2] = { 0x78, 0x01 };
+        WriteChunk("IDAT", header, sizeof(header));
+    }
+
+    for (int block = 0; block < blockCount; ++block)
+    {
+        const int blockSize = std::min(blockRows, count - block * blockRows);
+        m_adler = CombineAdler32(m_adler, adlers[block], blockSize * (rowBytes + 1));
+    }
+
+    if (last)
+    {
+        std::vector<uint8_t>& end = m_blocks.back();
+        end.push_back(static_cast<uint8_t>(m_adler >> 24));
+        end.push_back(static_cast<uint8_t>(m_adler >> 16));
+        end.push_back(static_cast<uint8_t>(m_adler >> 8));
+        end.push_back(static_cast<uint8_t>(m_adler));
+    }
+
+    // A chunk for each block, so no chunk outgrows the 2 GB a PNG chunk may hold
+    for (const std::vector<uint8_t>& block : m_blocks)
+    {
+        WriteChunk("IDAT", block.data(), block.size());
+    }
+
+    memcpy(m_previous.data(), rows + (count - 1) * stride, rowBytes);
+    m_rows += count;
+
+    return static_cast<bool>(m_file);
+}
+
+void PngWriter::FilterRow(const uint8_t* row, const uint8_t* previous, size_t rowBytes, uint8_t* filtered)
+{
+    // The left pixel is 3 bytes back
+    const size_t left = 3;
+
+    // Sum of the filtered bytes as signed values, the filter with the smallest sum leaves
+    // the most zeros and small values, which compress best
+    uint64_t sums[5] = {};
+    for (size_t i = 0; i < rowBytes; ++i)
+    {
+        const int x = row[i], a = i >= left ? row[i - left] : 0, b = previous[i], c = i >= left ? previous[i - left] : 0;
+
+        sums[0] += abs(static_cast<int8_t>(x));
+        sums[1] += abs(static_cast<int8_t>(x - a));
+        sums[2] += abs(static_cast<int8_t>(x - b));
+        sums[3] += abs(static_cast<int8_t>(x - (a + b) / 2));
+        sums[4] += abs(static_cast<int8_t>(x - Paeth(a, b, c)));
+    }
+
+    const int filter = static_cast<int>(std::min_element(sums, sums + 5) - sums);
+    filtered[0] = static_cast<uint8_t>(filter);
+
+    for (size_t i = 0; i < rowBytes; ++i)
+    {
+        const int x = row[i], a = i >= left ? row[i - left] : 0, b = previous[i], c = i >= left ? previous[i - left] : 0;
+
+        int predicted = 0;
+        switch (filter)
+        {
+        case 1:
+            predicted = a;
+            break;
+        case 2:
+            predicted = b;
+            break;
+        case 3:
+            predicted = (a + b) / 2;
+            break;
+        case 4:
+            predicted = Paeth(a, b, c);
+            break;
+        } // Switch
+
+        filtered[i + 1] = static_cast<uint8_t>(x - predicted);
+    }
+}
+
+bool PngWriter::Close()
+{
+    if (m_rows < m_height)
+    {
+        m_file.close();
+        return false;
+    }
+
+    WriteChunk("IEND", nullptr, 0);
+    m_file.close();
+
+    return !m_file.fail();
+}
+
+void PngWriter::WriteChunk(const char* type, const uint8_t* data, size_t size)
+{
+    uint8_t length[4] = { static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size) };
+    m_file.write(reinterpret_cast<const char*>(length), 4);
+    m_file.write(type, 4);
+    m_file.write(reinterpret_cast<const char*>(data), size);
+
+    // CRC of the type and the data
+    uint32_t crc = Crc32(0xffffffff, reinterpret_cast<const uint8_t*>(type), 4);
+    crc = Crc32(crc, data, size) ^ 0xffffffff;
+
+    uint8_t check[4] = { static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16), static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc) };
+    m_file.write(reinterpret_cast<const char*>(check), 4);
+}
+
+uint32_t PngWriter::Crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static const std::vector<uint32_t> table = []
+        {
+            std::vector<uint32_t> entries(256);
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+                }
+                entries[n] = c;
+            }
+            return entries;
+        }();
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+uint32_t PngWriter::Adler32(uint32_t adler, const uint8_t* data, size_t size)
+{
+    uint32_t a = adler & 0xffff, b = adler >> 16;
+
+    // The sums are reduced every 5552 bytes, the most that can be added without overflowing
+    while (size > 0)
+    {
+        size_t block = std::min(size, static_cast<size_t>(5552));
+        for (size_t i = 0; i < block; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+
+        a %= 65521;
+        b %= 65521;
+        data += block;
+        size -= block;
+    }
+
+    return (b << 16) | a;
+}
+
+uint32_t PngWriter::CombineAdler32(uint32_t first, uint32_t second, size_t secondSize)
+{
+    const uint64_t base = 65521;
+    const uint64_t remainder = secondSize % base;
+
+    // The second's sums start from 1 and 0, the first's carry into them for each of its bytes
+    uint64_t a = (first & 0xffff) + (second & 0xffff) + base - 1;
+    uint64_t b = (remainder * (first & 0xffff)) % base + (first >> 16) + (second >> 16) + base - remainder;
+
+    return static_cast<uint32_t>(((b % base) << 16) | (a % base));
+}
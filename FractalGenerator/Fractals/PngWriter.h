@@ -0,0 +1,70 @@
+/*********************************************************************************************
+**
+**	File Name:		pngwriter.h
+**	Description:	This is the header file that contains the class definition for the PNG
+**                  writer, which streams an 8 bit RGB image to a file from the top row down
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+// Blocks of rows are filtered and compressed on their own threads, each block ends with a
+// sync flush so the blocks join into one zlib stream in order
+class PngWriter
+{
+private:
+    std::ofstream m_file;
+
+    int m_width{};
+    int m_height{};
+
+    // Threads that compress the blocks of rows
+    int m_threads;
+
+    // Rows written so far
+    int m_rows{};
+
+    // Adler-32 of the filtered rows, the end of the zlib stream
+    uint32_t m_adler = 1;
+
+    // Last row of the previous call, the filters of the next row predict from it
+    std::vector<uint8_t> m_previous;
+
+    // Compressed blocks of the call, in order
+    std::vector<std::vector<uint8_t>> m_blocks;
+
+    // Filter a row with whichever of the five filters leaves the smallest bytes
+    // previous is the row above, zeros for the first row
+    static void FilterRow(const uint8_t* row, const uint8_t* previous, size_t rowBytes, uint8_t* filtered);
+
+    // Chunk of the file with its length and CRC
+    void WriteChunk(const char* type, const uint8_t* data, size_t size);
+
+    static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size);
+    static uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size);
+
+    // Adler-32 of two pieces of data joined, from the checksum of each and the size of the second
+    static uint32_t CombineAdler32(uint32_t first, uint32_t second, size_t secondSize);
+
+public:
+    // threads is 0 for one per processor
+    PngWriter(int threads = 0);
+
+    // Start an image, writes the signature and the header
+    bool Open(const std::filesystem::path& path, int width, int height);
+
+    // Append rows of RGB pixels, stride is the bytes from one row to the next
+    // Only the compressed rows of each call are held in memory
+    bool WriteRows(const uint8_t* rows, size_t stride, int count);
+
+    // End the image once every row is written
+    bool Close();
+};
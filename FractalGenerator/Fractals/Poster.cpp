@@ -0,0 +1,386 @@
+/*********************************************************************************************
+**
+**	File Name:		poster.cpp
+**	Description:	This is the file that contains the function definitions for the poster
+**                  renderer and its files
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "Poster.h"
+
+PpmSink::PpmSink(const std::filesystem::path& path)
+    : m_path(path)
+{
+}
+
+PpmSink::~PpmSink()
+{
+    EndBand();
+    Close();
+}
+
+PixelFormat PpmSink::GetFormat() const
+{
+    return PixelFormat::RGB;
+}
+
+bool PpmSink::Open(int width, int height)
+{
+    return OpenFile(width, height, false);
+}
+
+bool PpmSink::Resume(int width, int height)
+{
+    return OpenFile(width, height, true);
+}
+
+bool PpmSink::OpenFile(int width, int height, bool existing)
+{
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    m_headerBytes = header.size();
+    m_rowBytes = static_cast<size_t>(width) * 3;
+    const unsigned long long fileBytes = m_headerBytes + m_rowBytes * height;
+    std::string found(header.size(), '\0');
+
+#ifdef _WIN32
+    m_file = CreateFileA(m_path.string().c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, existing ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    DWORD done;
+    if (existing)
+    {
+        // The image a killed render left is already full size, with this header
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || static_cast<unsigned long long>(size.QuadPart) != fileBytes ||
+            !ReadFile(m_file, found.data(), static_cast<DWORD>(found.size()), &done, nullptr) || found != header)
+        {
+            Close();
+            return false;
+        }
+    }
+    else if (!WriteFile(m_file, header.data(), static_cast<DWORD>(header.size()), &done, nullptr))
+    {
+        return false;
+    }
+
+    // The mapping grows the file to its full size
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(fileBytes >> 32), static_cast<DWORD>(fileBytes), nullptr);
+    return m_mapping != nullptr;
+#else
+    m_file = open(m_path.c_str(), existing ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_file < 0)
+    {
+        return false;
+    }
+
+    if (existing)
+    {
+        // The image a killed render left is already full size, with this header
+        struct stat info;
+        if (fstat(m_file, &info) != 0 || static_cast<unsigned long long>(info.st_size) != fileBytes ||
+            pread(m_file, found.data(), found.size(), 0) != static_cast<ssize_t>(found.size()) || found != header)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    return write(m_file, header.data(), header.size()) == static_cast<ssize_t>(header.size()) &&
+        ftruncate(m_file, static_cast<off_t>(fileBytes)) == 0;
+#endif
+}
+
+uint8_t* PpmSink::BeginBand(int y, int count, size_t& stride)
+{
+    const unsigned long long offset = m_headerBytes + m_rowBytes * y;
+
+    // Mappings start on a boundary of the allocation granularity (a page)
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const unsigned long long granularity = info.dwAllocationGranularity;
+#else
+    const unsigned long long granularity = static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+#endif
+    const unsigned long long start = offset - offset % granularity;
+    m_viewBytes = static_cast<size_t>(offset - start + m_rowBytes * count);
+
+#ifdef _WIN32
+    void* view = MapViewOfFile(m_mapping, FILE_MAP_WRITE, static_cast<DWORD>(start >> 32), static_cast<DWORD>(start), m_viewBytes);
+    if (!view)
+    {
+        return nullptr;
+    }
+#else
+    void* view = mmap(nullptr, m_viewBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, static_cast<off_t>(start));
+    if (view == MAP_FAILED)
+    {
+        return nullptr;
+    }
+#endif
+
+    m_view = static_cast<uint8_t*>(view);
+    stride = m_rowBytes;
+    return m_view + (offset - start);
+}
+
+bool PpmSink::EndBand()
+{
+    if (!m_view)
+    {
+        return true;
+    }
+
+    // Unmapping leaves the rows to the OS to write back, so only one band is ever mapped
+#ifdef _WIN32
+    bool unmapped = UnmapViewOfFile(m_view) != 0;
+#else
+    bool unmapped = munmap(m_view, m_viewBytes) == 0;
+#endif
+
+    m_view = nullptr;
+    return unmapped;
+}
+
+bool PpmSink::Flush()
+{
+    // The band is written back through its mapping, the earlier bands through the file
+#ifdef _WIN32
+    return (!m_view || FlushViewOfFile(m_view, m_viewBytes)) && FlushFileBuffers(m_file);
+#else
+    return (!m_view || msync(m_view, m_viewBytes, MS_SYNC) == 0) && fsync(m_file) == 0;
+#endif
+}
+
+bool PpmSink::Close()
+{
+#ifdef _WIN32
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    bool closed = CloseHandle(m_file) != 0;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_file < 0)
+    {
+        return false;
+    }
+
+    bool closed = close(m_file) == 0;
+    m_file = -1;
+#endif
+
+    return closed;
+}
+
+PngSink::PngSink(const std::filesystem::path& path, int threads)
+    : m_path(path), m_writer(threads)
+{
+}
+
+PixelFormat PngSink::GetFormat() const
+{
+    return PixelFormat::RGB;
+}
+
+bool PngSink::Open(int width, int height)
+{
+    m_stride = static_cast<size_t>(width) * 3;
+    return m_writer.Open(m_path, width, height);
+}
+
+uint8_t* PngSink::BeginBand(int /*y*/, int count, size_t& stride)
+{
+    // The buffer of the first band is reused by the rest, they are never taller
+    m_band.resize(m_stride * count);
+    m_rows = count;
+
+    stride = m_stride;
+    return m_band.data();
+}
+
+bool PngSink::EndBand()
+{
+    return m_writer.WriteRows(m_band.data(), m_stride, m_rows);
+}
+
+bool PngSink::Close()
+{
+    return m_writer.Close();
+}
+
+Poster::Poster(const Fractal& fractal, const RenderRequest& request, size_t memoryBudget)
+    : m_fractal(fractal), m_request(request)
+{
+    // The tiles are fixed here, so every run of the same request splits the image the same way
+    m_request.settings = fractal.ResolveSettings(request.settings);
+
+    // Bands are the full width of the image, sized for the widest pixel format
+    const size_t rowBytes = static_cast<size_t>(request.width) * Fractal::PixelBytes(PixelFormat::RGBA);
+    size_t rows = memoryBudget / (rowBytes ? rowBytes : 1);
+
+    // Whole rows of tiles, so the bands split the image into the tiles a single render would
+    const size_t tileRows = m_request.settings.tileHeight;
+    rows = std::max(rows - rows % tileRows, tileRows);
+
+    m_bandRows = static_cast<int>(std::min(rows, static_cast<size_t>(std::max(request.height, 1))));
+}
+
+int Poster::GetBandRows() const
+{
+    return m_bandRows;
+}
+
+bool Poster::Render(PosterSink& sink, const std::function<void(int, int)>& onProgress, const std::atomic<bool>* cancel, Checkpoint* checkpoint)
+{
+    const int width = m_request.width, height = m_request.height;
+    const int tileWidth = m_request.settings.tileWidth, tileHeight = m_request.settings.tileHeight;
+    const size_t columns = (width + tileWidth - 1) / tileWidth;
+    const size_t tileCount = columns * ((height + tileHeight - 1) / tileHeight);
+
+    RenderRequest band = m_request;
+    band.format = sink.GetFormat();
+    band.left = 0;
+    band.top = 0;
+
+    // A journal of this job carries on with the image it left, anything else starts over
+    std::atomic<uint8_t>* tilesDone = nullptr;
+    bool resumed = false;
+    if (checkpoint)
+    {
+        resumed = checkpoint->Load(Checkpoint::DescribeJob(m_fractal.GetName(), band), tileCount) && sink.Resume(width, height);
+        if (!resumed)
+        {
+            checkpoint->Clear();
+        }
+        tilesDone = checkpoint->GetTiles();
+    }
+
+    if (!resumed && !sink.Open(width, height))
+    {
+        return false;
+    }
+
+    // The journal is saved on its own thread while the bands render
+    // The lock keeps the band from being mapped or unmapped while the sink flushes it
+    std::mutex sinkLock;
+    std::condition_variable wake;
+    bool stopped = false;
+    std::thread journal;
+
+    if (checkpoint)
+    {
+        journal = std::thread([&]
+            {
+                std::unique_lock<std::mutex> hold(sinkLock);
+                while (!wake.wait_for(hold, std::chrono::duration<double>(checkpoint->GetInterval()), [&] { return stopped; }))
+                {
+                    checkpoint->Save([&] { return sink.Flush(); });
+                }
+            });
+    }
+
+    bool finished = true;
+    for (int y = 0; y < height && finished; y += m_bandRows)
+    {
+        const int rows = std::min(m_bandRows, height - y);
+
+        // The tiles of the band follow on from those of the bands above it
+        const size_t firstTile = y / tileHeight * columns;
+        const size_t bandTiles = (rows + tileHeight - 1) / tileHeight * columns;
+
+        bool bandDone = tilesDone != nullptr;
+        for (size_t i = firstTile; i < firstTile + bandTiles && bandDone; ++i)
+        {
+            bandDone = tilesDone[i].load(std::memory_order_relaxed) != 0;
+        }
+
+        if (!bandDone)
+        {
+            uint8_t* rowsBuffer;
+            {
+                std::lock_guard<std::mutex> hold(sinkLock);
+                rowsBuffer = sink.BeginBand(y, rows, band.stride);
+            }
+
+            if (!rowsBuffer)
+            {
+                finished = false;
+                break;
+            }
+
+            // The band is a region of the whole image, so its pixels are the ones a single render would have
+            band.region = { 0, y, width, y + rows };
+            finished = m_fractal.Render(band, rowsBuffer, cancel, tilesDone ? tilesDone + firstTile : nullptr);
+
+            std::lock_guard<std::mutex> hold(sinkLock);
+            finished = sink.EndBand() && finished;
+        }
+
+        if (finished && onProgress)
+        {
+            onProgress(y + rows, height);
+        }
+    }
+
+    if (journal.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> hold(sinkLock);
+            stopped = true;
+        }
+        wake.notify_one();
+        journal.join();
+    }
+
+    if (!finished)
+    {
+        // The tiles finished so far are journaled, the next run starts from them
+        if (checkpoint)
+        {
+            checkpoint->Save([&] { return sink.Flush(); });
+        }
+
+        sink.Close();
+        return false;
+    }
+
+    if (!sink.Close())
+    {
+        return false;
+    }
+
+    if (checkpoint)
+    {
+        checkpoint->Remove();
+    }
+
+    return true;
+}
@@ -0,0 +1,148 @@
+/*********************************************************************************************
+**
+**	File Name:		poster.h
+**	Description:	This is the header file that contains the class definitions for the
+**                  poster renderer, which renders images of any size in bands of rows and
+**                  streams each band to a file, and the files it writes
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <filesystem>
+#include "Checkpoint.h"
+#include "Fractal.h"
+#include "PngWriter.h"
+
+// Destination of the rows of a poster, the bands are handed to it in order from the top
+class PosterSink
+{
+public:
+    virtual ~PosterSink() {}
+
+    // Layout the pixels are rendered in
+    virtual PixelFormat GetFormat() const = 0;
+
+    // Start an image of the given size, false if it can not be written
+    virtual bool Open(int width, int height) = 0;
+
+    // Memory the rows [y, y + count) are rendered into and the bytes from one row to the next
+    // nullptr if there is none
+    virtual uint8_t* BeginBand(int y, int count, size_t& stride) = 0;
+
+    // The rows of the band are rendered
+    virtual bool EndBand() = 0;
+
+    // Every band is written
+    virtual bool Close() = 0;
+
+    // Carry on with the image a killed render left, instead of Open
+    // False if the sink can not, or the image is not there or not of this size
+    virtual bool Resume(int /*width*/, int /*height*/)
+    {
+        return false;
+    }
+
+    // Make every row written so far survive the process, the mapped band as well
+    // False if the sink can not, the rows are only in memory until their band ends
+    virtual bool Flush()
+    {
+        return false;
+    }
+};
+
+// Binary PPM mapped into memory one band at a time
+// The kernels write straight into the file, nothing is copied
+class PpmSink : public PosterSink
+{
+private:
+    std::filesystem::path m_path;
+
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+
+    // Bytes of the header and of one row
+    size_t m_headerBytes{};
+    size_t m_rowBytes{};
+
+    // Mapping of the band being rendered, it starts on a page boundary at or before the band
+    uint8_t* m_view{};
+    size_t m_viewBytes{};
+
+    // Create the file or open the one that is there, the header of both is checked
+    bool OpenFile(int width, int height, bool existing);
+
+public:
+    PpmSink(const std::filesystem::path& path);
+
+    ~PpmSink();
+
+    PpmSink(const PpmSink&) = delete;
+    PpmSink& operator=(const PpmSink&) = delete;
+
+    PixelFormat GetFormat() const override;
+    bool Open(int width, int height) override;
+    uint8_t* BeginBand(int y, int count, size_t& stride) override;
+    bool EndBand() override;
+    bool Close() override;
+    bool Resume(int width, int height) override;
+    bool Flush() override;
+};
+
+// PNG streamed from a buffer of one band
+class PngSink : public PosterSink
+{
+private:
+    std::filesystem::path m_path;
+    PngWriter m_writer;
+
+    std::vector<uint8_t> m_band;
+    size_t m_stride{};
+    int m_rows{};
+
+public:
+    // threads compress the rows, 0 for one per processor
+    PngSink(const std::filesystem::path& path, int threads = 0);
+
+    PixelFormat GetFormat() const override;
+    bool Open(int width, int height) override;
+    uint8_t* BeginBand(int y, int count, size_t& stride) override;
+    bool EndBand() override;
+    bool Close() override;
+};
+
+class Poster
+{
+private:
+    const Fractal& m_fractal;
+
+    // Request of the whole image, each band renders a region of it
+    RenderRequest m_request;
+
+    // Rows of each band, as many as fit in the memory budget and at least one row of tiles
+    int m_bandRows;
+
+public:
+    // The memory budget bounds one band, whatever the size of the image
+    Poster(const Fractal& fractal, const RenderRequest& request, size_t memoryBudget);
+
+    int GetBandRows() const;
+
+    // Render every band into the sink, each band on all the threads of the request
+    // onProgress gets the rows that are finished and the height after each band
+    // With a checkpoint the finished tiles are journaled every interval and when the render
+    // stops, and a journal of the same job resumes a sink that can, skipping its tiles
+    // Returns false if the render was cancelled or the sink failed
+    bool Render(
+        PosterSink& sink,
+        const std::function<void(int, int)>& onProgress = nullptr,
+        const std::atomic<bool>* cancel = nullptr,
+        Checkpoint* checkpoint = nullptr);
+};
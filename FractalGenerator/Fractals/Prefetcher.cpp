@@ -0,0 +1,267 @@
+/*********************************************************************************************
+**
+**	File Name:		prefetcher.cpp
+**	Description:	This is the file that contains the function definitions for the prefetcher
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "Prefetcher.h"
+#include "Topology.h"
+
+Prefetcher::Prefetcher(int width, int height, size_t memoryBudget, double cpuShare)
+    : m_width(width), m_height(height), m_memoryBudget(memoryBudget), m_cpuShare(cpuShare)
+{
+}
+
+Prefetcher::~Prefetcher()
+{
+    Stop();
+}
+
+void Prefetcher::Start(const Fractal& fractal, const Colour* pixelBuffer)
+{
+    Stop();
+    m_cancel = false;
+
+    const Viewport view = fractal.GetViewport();
+    const size_t frameSize = static_cast<size_t>(m_width) * m_height;
+
+    // The start view and the next zooms first, then the pans to the sides before the corners
+    std::vector<Viewport> views = {
+        view,
+        fractal.ZoomedViewport(Fractal::ZoomType::ZOOM_IN),
+        fractal.ZoomedViewport(Fractal::ZoomType::ZOOM_OUT)
+    };
+
+    const int neighbours[8][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 } };
+    for (const auto& neighbour : neighbours)
+    {
+        views.push_back(NeighbourViewport(view, neighbour[0], neighbour[1]));
+    }
+
+    // Only as many images as fit in the memory budget
+    size_t frames = m_memoryBudget / (sizeof(Colour) * frameSize);
+    if (frames < 2)
+    {
+        m_entries.clear();
+        return;
+    }
+
+    if (views.size() > frames)
+    {
+        views.resize(frames);
+    }
+
+    // Reuse the buffers of the last prediction
+    std::vector<Buffer> buffers;
+    for (auto& entry : m_entries)
+    {
+        buffers.push_back(std::move(entry.m_buffer));
+    }
+    m_entries.clear();
+
+    for (const auto& next : views)
+    {
+        Buffer buffer;
+        if (buffers.empty())
+        {
+            buffer.reset(static_cast<Colour*>(_aligned_malloc(sizeof(Colour) * frameSize, 32)));
+        }
+        else
+        {
+            buffer = std::move(buffers.back());
+            buffers.pop_back();
+        }
+
+        m_entries.push_back({ next, std::move(buffer), false });
+    }
+
+    // The start view is already on the window
+    memcpy(m_entries[0].m_buffer.get(), pixelBuffer, sizeof(Colour) * frameSize);
+    m_entries[0].m_ready = true;
+
+    // The background renders leave the rest of the cores to the window
+    int threads = static_cast<int>(std::thread::hardware_concurrency() * m_cpuShare);
+    threads = threads > 1 ? threads : 1;
+    m_fractal = fractal.Clone();
+    m_request = fractal.GetRequest();
+    m_request.settings.threads = m_request.settings.threads < threads ? m_request.settings.threads : threads;
+    m_request.settings.background = true;
+
+    m_thread = std::thread(&Prefetcher::Run, this);
+}
+
+void Prefetcher::Run()
+{
+    // The window's renders come first, and the workers of these renders too
+    Topology::LowerPriority();
+
+    for (size_t i = 1; i < m_entries.size() && !m_cancel; ++i)
+    {
+        Entry& entry = m_entries[i];
+
+        // A cancelled render leaves the entry not ready
+        RenderRequest request = m_request;
+        request.view = entry.m_view;
+        entry.m_ready = m_fractal->Render(request, entry.m_buffer.get(), &m_cancel);
+    }
+}
+
+void Prefetcher::Stop()
+{
+    m_cancel = true;
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void Prefetcher::Clear()
+{
+    Stop();
+    m_entries.clear();
+    m_fractal.reset();
+}
+
+Viewport Prefetcher::NeighbourViewport(const Viewport& view, int gridX, int gridY)
+{
+    Viewport neighbour = view;
+    neighbour.Pan(gridX * view.Width(), gridY * view.Height());
+    return neighbour;
+}
+
+bool Prefetcher::SameView(const Viewport& a, const Viewport& b) const
+{
+    // Zooms are exact, the centres of pans may differ by the rounding of the move
+    if (a.mantissa != b.mantissa || a.exponent != b.exponent || a.aspect != b.aspect)
+    {
+        return false;
+    }
+
+    const double xTolerance = a.Width() / m_width / 1000;
+    const double yTolerance = a.Height() / m_height / 1000;
+
+    return fabs((a.cx - b.cx).ToDouble()) < xTolerance && fabs((a.cy - b.cy).ToDouble()) < yTolerance;
+}
+
+const Prefetcher::Entry* Prefetcher::Find(const Viewport& view) const
+{
+    for (const auto& entry : m_entries)
+    {
+        if (entry.m_ready && SameView(entry.m_view, view))
+        {
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
+bool Prefetcher::TakeShifted(const Viewport& view, Colour* pixelBuffer) const
+{
+    const Viewport& start = m_entries[0].m_view;
+    const double dx = start.Width() / m_width;
+    const double dy = start.Height() / m_height;
+
+    // A move keeps the size of the view and shifts it by whole pixels
+    const double shiftX = (view.cx - start.cx).ToDouble() / dx;
+    const double shiftY = (view.cy - start.cy).ToDouble() / dy;
+    const int sx = static_cast<int>(lround(shiftX));
+    const int sy = static_cast<int>(lround(shiftY));
+
+    Viewport shifted = start;
+    shifted.Pan(sx * dx, sy * dy);
+    if (!SameView(view, shifted) || abs(sx) > m_width || abs(sy) > m_height)
+    {
+        return false;
+    }
+
+    // The start view and its neighbours form a 3x3 grid of images, the shifted view lies inside it
+    const Entry* grid[3][3] = {};
+    for (int gy = 0; gy < 3; ++gy)
+    {
+        for (int gx = 0; gx < 3; ++gx)
+        {
+            grid[gy][gx] = Find(NeighbourViewport(start, gx - 1, gy - 1));
+        }
+    }
+
+    // Every image the shifted view overlaps must be ready
+    const int gxFirst = (sx + m_width) / m_width, gxLast = (sx + 2 * m_width - 1) / m_width;
+    const int gyFirst = (sy + m_height) / m_height, gyLast = (sy + 2 * m_height - 1) / m_height;
+    for (int gy = gyFirst; gy <= gyLast; ++gy)
+    {
+        for (int gx = gxFirst; gx <= gxLast; ++gx)
+        {
+            if (!grid[gy][gx])
+            {
+                return false;
+            }
+        }
+    }
+
+    // Copy each row in at most two pieces
+    for (int y = 0; y < m_height; ++y)
+    {
+        const int gridY = y + sy + m_height;
+        const int gy = gridY / m_height, rowY = gridY % m_height;
+
+        for (int x = 0; x < m_width;)
+        {
+            const int gridX = x + sx + m_width;
+            const int gx = gridX / m_width, rowX = gridX % m_width;
+            const int count = std::min(m_width - rowX, m_width - x);
+
+            memcpy(&pixelBuffer[y * m_width + x],
+                &grid[gy][gx]->m_buffer.get()[rowY * m_width + rowX],
+                sizeof(Colour) * count);
+
+            x += count;
+        }
+    }
+
+    return true;
+}
+
+bool Prefetcher::Take(const Viewport& view, Colour* pixelBuffer)
+{
+    // The entries are only read once the background thread has stopped
+    Stop();
+
+    if (!m_entries.empty())
+    {
+        // Zooms land exactly on a predicted view
+        if (const Entry* entry = Find(view))
+        {
+            memcpy(pixelBuffer, entry->m_buffer.get(), sizeof(Colour) * m_width * m_height);
+            ++m_hits;
+            return true;
+        }
+
+        if (TakeShifted(view, pixelBuffer))
+        {
+            ++m_hits;
+            return true;
+        }
+    }
+
+    ++m_misses;
+    return false;
+}
+
+long long Prefetcher::GetHits() const
+{
+    return m_hits;
+}
+
+long long Prefetcher::GetMisses() const
+{
+    return m_misses;
+}
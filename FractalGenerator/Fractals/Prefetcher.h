@@ -0,0 +1,99 @@
+/*********************************************************************************************
+**
+**	File Name:		prefetcher.h
+**	Description:	This is the header file that contains the class definition for the
+**                  prefetcher, which renders the views the user is likely to go to next in
+**                  the background while the window is idle
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include "Fractal.h"
+
+class Prefetcher
+{
+private:
+    struct AlignedFree
+    {
+        void operator()(Colour* buffer) const
+        {
+            _aligned_free(buffer);
+        }
+    };
+
+    using Buffer = std::unique_ptr<Colour, AlignedFree>;
+
+    // A view the user may go to next and its image once it has been rendered
+    struct Entry
+    {
+        Viewport m_view;
+        Buffer m_buffer;
+        bool m_ready;
+    };
+
+    int m_width;
+    int m_height;
+
+    // Most memory the images may take and the share of the cores the renders may use
+    size_t m_memoryBudget;
+    double m_cpuShare;
+
+    // Copy of the fractal the background renders run on and the request of the start view
+    // Each entry renders the request moved to its view
+    std::unique_ptr<Fractal> m_fractal;
+    RenderRequest m_request{};
+
+    // The first entry is the view the predictions were made from, the rest are in order of priority
+    std::vector<Entry> m_entries;
+
+    std::atomic<bool> m_cancel{};
+    std::thread m_thread;
+
+    long long m_hits{};
+    long long m_misses{};
+
+    // Body of the background thread
+    void Run();
+
+    // The view a whole window to the side of another (gridX, gridY in -1 to 1)
+    static Viewport NeighbourViewport(const Viewport& view, int gridX, int gridY);
+
+    // Views that differ by less than a thousandth of a pixel
+    bool SameView(const Viewport& a, const Viewport& b) const;
+
+    // Ready entry of a view, nullptr if there is none
+    const Entry* Find(const Viewport& view) const;
+
+    // Image of a view shifted from the start view by whole pixels, pieced together from the neighbours
+    bool TakeShifted(const Viewport& view, Colour* pixelBuffer) const;
+
+public:
+    Prefetcher(int width, int height, size_t memoryBudget, double cpuShare);
+
+    // Stops the background thread
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    // Predict the next views from the finished frame in pixelBuffer and start rendering them
+    // Must only be called while nothing else is rendering the fractal
+    void Start(const Fractal& fractal, const Colour* pixelBuffer);
+
+    // Stop the background renders (at most one tile), images that are already done are kept
+    void Stop();
+
+    // Stop and drop every image, e.g. when the fractal or the gradient changes
+    void Clear();
+
+    // Copy the image of the view into pixelBuffer if it was prefetched, returns false otherwise
+    bool Take(const Viewport& view, Colour* pixelBuffer);
+
+    long long GetHits() const;
+
+    long long GetMisses() const;
+};
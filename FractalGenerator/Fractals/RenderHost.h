@@ -0,0 +1,36 @@
+/*********************************************************************************************
+**
+**	File Name:		renderhost.h
+**	Description:	This is the header file that contains the class definition for the
+**                  render host, what the fractals need from the program that owns them
+**                  (the window app or the command line renderer)
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include "Platform.h"
+
+class TuningProfile;
+
+class RenderHost
+{
+public:
+    // Size of the image the fractals render
+    int m_widthW = 900;
+    int m_heightW = 600;
+
+    virtual ~RenderHost() {}
+
+    // Choices of the user
+    virtual UINT GetLanguage() = 0;
+    virtual UINT GetGradient() = 0;
+    virtual bool GetPinThreads() const = 0;
+    virtual bool GetPerturbation() const = 0;
+
+    // Fastest settings on this machine, may be empty
+    virtual const TuningProfile& GetTuningProfile() const = 0;
+};
@@ -0,0 +1,93 @@
+/*********************************************************************************************
+**
+**	File Name:		renderjob.cpp
+**	Description:	This is the file that contains the function definitions for a render job
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include "RenderJob.h"
+
+RenderJob::RenderJob(Fractal& fractal, const RenderRequest& request, Colour* pixelBuffer, bool progressive, int previewScale, double budgetMs, PassCallback onPass, DoneCallback onDone)
+    : m_fractal(fractal), m_request(request), m_pixelBuffer(pixelBuffer), m_progressive(progressive), m_previewScale(previewScale), m_budgetMs(budgetMs),
+    m_onPass(std::move(onPass)), m_onDone(std::move(onDone))
+{
+    // Start the thread last, once every member it reads is set
+    m_thread = std::thread(&RenderJob::Run, this);
+}
+
+RenderJob::~RenderJob()
+{
+    Cancel();
+    Wait();
+}
+
+void RenderJob::Run()
+{
+    // Only finished passes of a job that is still wanted get published
+    auto publish = [this](int step)
+        {
+            if (!m_cancel && m_onPass)
+            {
+                m_onPass(*this, step);
+            }
+        };
+
+    if (m_budgetMs > 0)
+    {
+        // Publish the best frame so far every time the budget runs out
+        m_fractal.BeginBudgeted(m_request, m_previewScale);
+
+        bool finished = false;
+        while (!finished && !m_cancel)
+        {
+            finished = m_fractal.RenderBudgeted(m_pixelBuffer, m_budgetMs, &m_cancel);
+            publish(m_fractal.GetBudgetStep());
+        }
+    }
+    else if (m_progressive)
+    {
+        m_fractal.RenderProgressive(m_request, m_pixelBuffer, publish, &m_cancel, m_previewScale);
+    }
+    else if (m_fractal.Render(m_request, m_pixelBuffer, &m_cancel, m_previewScale))
+    {
+        publish(m_previewScale);
+    }
+
+    m_done = true;
+
+    if (m_onDone)
+    {
+        m_onDone(*this);
+    }
+}
+
+void RenderJob::Cancel()
+{
+    m_cancel = true;
+}
+
+void RenderJob::Wait()
+{
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool RenderJob::IsCancelled() const
+{
+    return m_cancel;
+}
+
+bool RenderJob::IsDone() const
+{
+    return m_done;
+}
+
+int RenderJob::GetPreviewScale() const
+{
+    return m_previewScale;
+}
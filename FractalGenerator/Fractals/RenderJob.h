@@ -0,0 +1,74 @@
+/*********************************************************************************************
+**
+**	File Name:		renderjob.h
+**	Description:	This is the header file that contains the class definition for a render
+**                  job, a render of a fractal running on its own thread that can be cancelled
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include "Fractal.h"
+
+class RenderJob
+{
+public:
+    // Called from the render thread after each finished pass (step of the preview scale is the final image)
+    using PassCallback = std::function<void(RenderJob&, int)>;
+
+    // Called from the render thread once the job has stopped, finished or cancelled
+    using DoneCallback = std::function<void(RenderJob&)>;
+
+private:
+    Fractal& m_fractal;
+    // Taken on the thread that starts the job, the menu and the profile are not read again
+    RenderRequest m_request;
+    Colour* m_pixelBuffer;
+    bool m_progressive;
+    int m_previewScale;
+    double m_budgetMs;
+
+    PassCallback m_onPass;
+    DoneCallback m_onDone;
+
+    std::atomic<bool> m_cancel{};
+    std::atomic<bool> m_done{};
+    std::thread m_thread;
+
+    // Body of the render thread
+    void Run();
+
+public:
+    // The request is the fractal's GetRequest on the thread starting the job
+    // A budget above 0 renders in deadline mode, a frame is published after every budgetMs
+    RenderJob(
+        Fractal& fractal,
+        const RenderRequest& request,
+        Colour* pixelBuffer,
+        bool progressive,
+        int previewScale,
+        double budgetMs,
+        PassCallback onPass,
+        DoneCallback onDone);
+
+    // Cancels the job and waits for the render thread
+    ~RenderJob();
+
+    RenderJob(const RenderJob&) = delete;
+    RenderJob& operator=(const RenderJob&) = delete;
+
+    // Ask the job to stop, the render stops before its next tile
+    void Cancel();
+
+    // Block until the render thread has stopped
+    void Wait();
+
+    bool IsCancelled() const;
+
+    bool IsDone() const;
+
+    int GetPreviewScale() const;
+};
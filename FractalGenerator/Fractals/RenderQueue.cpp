@@ -0,0 +1,82 @@
+/*********************************************************************************************
+**
+**	File Name:		renderqueue.cpp
+**	Description:	This is the file that contains the function definitions for the render queue
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include "RenderQueue.h"
+
+void RenderQueue::PushZoom(Fractal::ZoomType zoom)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back({ Request::Type::ZOOM, zoom, {} });
+}
+
+void RenderQueue::PushMove(POINT clickPoint)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back({ Request::Type::MOVE, Fractal::ZoomType::ZOOM_IN, clickPoint });
+}
+
+bool RenderQueue::IsEmpty() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.empty();
+}
+
+void RenderQueue::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.clear();
+    m_merged = 0;
+}
+
+int RenderQueue::Apply(Fractal& fractal)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Zooms and moves only change the view, so applying them back to back
+    // lands on the same view as rendering after each one
+    for (auto& request : m_pending)
+    {
+        switch (request.m_type)
+        {
+        case Request::Type::ZOOM:
+        {
+            fractal.ZoomScreen(request.m_zoom);
+            break;
+        }
+        case Request::Type::MOVE:
+        {
+            fractal.MoveScreen(&request.m_clickPoint);
+            break;
+        }
+        } // Switch
+    }
+
+    m_merged = static_cast<int>(m_pending.size());
+    if (m_merged > 1)
+    {
+        m_totalMerged += m_merged - 1;
+    }
+
+    m_pending.clear();
+
+    return m_merged;
+}
+
+int RenderQueue::GetMerged() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_merged;
+}
+
+long long RenderQueue::GetTotalMerged() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_totalMerged;
+}
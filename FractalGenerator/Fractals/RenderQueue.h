@@ -0,0 +1,61 @@
+/*********************************************************************************************
+**
+**	File Name:		renderqueue.h
+**	Description:	This is the header file that contains the class definition for the render
+**                  queue, which folds zoom and move requests that arrive during a render
+**                  into a single render of the final view
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <mutex>
+#include "Fractal.h"
+
+class RenderQueue
+{
+private:
+    struct Request
+    {
+        enum class Type
+        {
+            ZOOM,
+            MOVE
+        } m_type;
+
+        Fractal::ZoomType m_zoom;
+        POINT m_clickPoint;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<Request> m_pending;
+
+    // Number of requests folded into the last render
+    int m_merged{};
+
+    // Number of requests folded into an earlier one since the queue was made
+    long long m_totalMerged{};
+
+public:
+    // Queue a zoom of the view
+    void PushZoom(Fractal::ZoomType zoom);
+
+    // Queue a move of the view to be centered on a point on the window
+    void PushMove(POINT clickPoint);
+
+    bool IsEmpty() const;
+
+    // Drop every pending request, e.g. when the fractal is replaced
+    void Clear();
+
+    // Apply every pending request to the fractal in order, so one render reaches the final view
+    // Returns the number of requests that were merged
+    int Apply(Fractal& fractal);
+
+    int GetMerged() const;
+
+    long long GetTotalMerged() const;
+};
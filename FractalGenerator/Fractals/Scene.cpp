@@ -0,0 +1,258 @@
+/*********************************************************************************************
+**
+**	File Name:		scene.cpp
+**	Description:	This is the file that contains the function definitions for the scene file
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "Scene.h"
+
+// The SIMD kernels count in 16 bit lanes
+static const int s_iterationLimit = 32767;
+
+// Decimals and hex floats, the whole text must be the number
+static bool ReadNumber(const std::string& text, double& value)
+{
+    char* end;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && std::isfinite(value);
+}
+
+// Exact text first, a decimal needs to fit the integer word of the fixed point
+static bool ReadCoordinate(const std::string& text, FixedPoint& value)
+{
+    double number;
+    if (FixedPoint::Parse(text, value))
+    {
+        return true;
+    }
+
+    if (!ReadNumber(text, number) || std::fabs(number) >= 4294967296.0)
+    {
+        return false;
+    }
+
+    value = FixedPoint(number);
+    return true;
+}
+
+namespace
+{
+    // Scene being read and the parts of its view found so far
+    struct PendingScene
+    {
+        Scene scene{ "", std::nullopt, 0, ID_GRADIENT_1, 900, 600, {} };
+        bool hasCentre{};
+        bool hasWidth{};
+        bool hasAspect{};
+        Viewport view{};
+    };
+}
+
+// The scene is complete, false if it has no output or half a view
+static bool FinishScene(PendingScene& pending, std::vector<Scene>& scenes)
+{
+    if (pending.scene.output.empty() || pending.hasCentre != pending.hasWidth || (pending.hasAspect && !pending.hasCentre))
+    {
+        return false;
+    }
+
+    if (pending.hasCentre)
+    {
+        if (!pending.hasAspect)
+        {
+            pending.view.aspect = static_cast<double>(pending.scene.height) / pending.scene.width;
+        }
+        pending.scene.view = pending.view;
+    }
+
+    scenes.push_back(pending.scene);
+    return true;
+}
+
+bool SceneFile::Load(const std::filesystem::path& path, std::vector<Scene>& scenes, int& badLine)
+{
+    badLine = 0;
+
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    scenes.clear();
+    const std::filesystem::path folder = path.parent_path();
+
+    std::optional<PendingScene> pending;
+    std::string line;
+    int number = 0;
+
+    while (std::getline(file, line))
+    {
+        ++number;
+
+        // Files from Windows keep their carriage returns
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key) || key[0] == '#')
+        {
+            continue;
+        }
+
+        if (key == "fractal")
+        {
+            if (pending && !FinishScene(*pending, scenes))
+            {
+                badLine = number;
+                return false;
+            }
+
+            pending.emplace();
+            if (!(fields >> pending->scene.fractal))
+            {
+                badLine = number;
+                return false;
+            }
+
+            continue;
+        }
+
+        // Every other key belongs to the scene the last fractal line started
+        std::vector<std::string> values;
+        std::string value;
+        while (fields >> value)
+        {
+            values.push_back(value);
+        }
+
+        if (!pending || values.empty())
+        {
+            badLine = number;
+            return false;
+        }
+
+        Scene& scene = pending->scene;
+        bool understood = true;
+        double real;
+
+        if (key == "centre" && values.size() == 2)
+        {
+            understood = ReadCoordinate(values[0], pending->view.cx) && ReadCoordinate(values[1], pending->view.cy);
+            pending->hasCentre = true;
+        }
+        else if (key == "width" && values.size() == 1)
+        {
+            // Only the mantissa is rounded, as when the view is zoomed
+            understood = ReadNumber(values[0], real) && real > 0;
+            if (understood)
+            {
+                pending->view.mantissa = 1.0;
+                pending->view.exponent = 0;
+                pending->view.Zoom(real);
+            }
+            pending->hasWidth = true;
+        }
+        else if (key == "width" && values.size() == 2)
+        {
+            double exponent = 0;
+            understood = ReadNumber(values[0], pending->view.mantissa) && pending->view.mantissa >= 1 && pending->view.mantissa < 2 &&
+                ReadNumber(values[1], exponent) && exponent == std::floor(exponent) && std::fabs(exponent) < 1e6;
+            pending->view.exponent = static_cast<int>(exponent);
+            pending->hasWidth = true;
+        }
+        else if (key == "aspect" && values.size() == 1)
+        {
+            understood = ReadNumber(values[0], pending->view.aspect) && pending->view.aspect > 0;
+            pending->hasAspect = true;
+        }
+        else if (key == "iterations" && values.size() == 1)
+        {
+            understood = ReadNumber(values[0], real) && real >= 1 && real <= s_iterationLimit && real == std::floor(real);
+            scene.maxIterations = static_cast<int>(real);
+        }
+        else if (key == "gradient" && values.size() == 1)
+        {
+            understood = ReadNumber(values[0], real) && real >= 1 && real <= 7 && real == std::floor(real);
+            scene.gradient = ID_GRADIENT_1 + static_cast<int>(real) - 1;
+        }
+        else if (key == "size" && values.size() == 1)
+        {
+            understood = sscanf(values[0].c_str(), "%dx%d", &scene.width, &scene.height) == 2 && scene.width > 0 && scene.height > 0;
+        }
+        else if (key == "output")
+        {
+            // The rest of the line, so names may have spaces
+            const size_t start = line.find_first_not_of(" \t", line.find(key) + key.size());
+            scene.output = folder / std::filesystem::path(line.substr(start, line.find_last_not_of(" \t") + 1 - start));
+        }
+        else
+        {
+            understood = false;
+        }
+
+        if (!understood)
+        {
+            badLine = number;
+            return false;
+        }
+    }
+
+    if (pending && !FinishScene(*pending, scenes))
+    {
+        badLine = number;
+        return false;
+    }
+
+    return true;
+}
+
+bool SceneFile::Save(const std::filesystem::path& path, const std::vector<Scene>& scenes)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "# Fractal Generator scenes, fractal-cli --batch renders them\n";
+
+    // Doubles as hex floats, so the text is as exact as the view
+    char line[256];
+    for (const Scene& scene : scenes)
+    {
+        file << "\nfractal " << scene.fractal << '\n';
+
+        if (scene.view)
+        {
+            const Viewport& view = *scene.view;
+            file << "centre " << view.cx.ToString() << ' ' << view.cy.ToString() << '\n';
+
+            snprintf(line, sizeof(line), "width %a %d\naspect %a\n", view.mantissa, view.exponent, view.aspect);
+            file << line;
+        }
+
+        if (scene.maxIterations > 0)
+        {
+            file << "iterations " << scene.maxIterations << '\n';
+        }
+
+        file << "gradient " << scene.gradient - ID_GRADIENT_1 + 1 << '\n';
+        file << "size " << scene.width << 'x' << scene.height << '\n';
+        file << "output " << scene.output.string() << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,60 @@
+/*********************************************************************************************
+**
+**	File Name:		scene.h
+**	Description:	This is the header file that contains the definitions for scenes, the
+**                  description of one render that can be written to a file and rendered again
+**                  exactly, by itself or in a batch
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Fractal.h"
+
+// Everything that decides the pixels of a render and where they are written
+struct Scene
+{
+    // Lower case name, as fractal-cli takes it
+    std::string fractal;
+    // Exact view, the start view of the fractal at the aspect of the size if there is none
+    std::optional<Viewport> view;
+    // Iterations before a point counts as inside the set, 0 for the limit of the fractal
+    int maxIterations;
+    // ID_GRADIENT_*
+    UINT gradient;
+    // Size of the image
+    int width;
+    int height;
+    // PNG for .png, an iteration archive for .iters, otherwise binary PPM
+    std::filesystem::path output;
+};
+
+// Text file of scenes, a line of a key and its values each, # starts a comment
+//
+//   fractal mandelbrot              starts the next scene
+//   centre -0.75 0.1                decimals, or the exact text FixedPoint::ToString writes
+//   width 2.5                       width of the view, or its mantissa and exponent
+//   aspect 0.5625                   height of the view over its width (that of the size)
+//   iterations 2000                 (the limit of the fractal)
+//   gradient 3                      1 to 7 (1)
+//   size 320x180                    (900x600)
+//   output thumbs/0001.png          relative to the folder of the file
+//
+// A view needs both a centre and a width, without them it is the start view
+class SceneFile
+{
+public:
+    // Read the scenes of a file in order, false if it is missing or a line of it is not
+    // understood, badLine is that line (0 if the file can not be read)
+    static bool Load(const std::filesystem::path& path, std::vector<Scene>& scenes, int& badLine);
+
+    // Write scenes so that Load reads back exactly the same views
+    static bool Save(const std::filesystem::path& path, const std::vector<Scene>& scenes);
+};
@@ -0,0 +1,325 @@
+/*********************************************************************************************
+**
+**	File Name:		topology.cpp
+**	Description:	This is the file that contains the function definitions for the processor
+**                  topology
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <thread>
+#ifndef _WIN32
+#include <cctype>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "Topology.h"
+
+const Topology& Topology::Get()
+{
+    static const Topology topology = []()
+        {
+            Topology detected;
+            detected.Detect();
+            return detected;
+        }();
+
+    return topology;
+}
+
+void Topology::Detect()
+{
+#ifdef _WIN32
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+
+    std::vector<char> buffer(length);
+    auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+
+    if (length && GetLogicalProcessorInformationEx(RelationAll, info, &length))
+    {
+        struct NodeMask
+        {
+            int node;
+            GROUP_AFFINITY mask;
+        };
+        std::vector<NodeMask> nodeMasks;
+
+        // Every core lists its logical processors, every node lists the processors it holds
+        for (DWORD offset = 0; offset < length;)
+        {
+            auto entry = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+
+            if (entry->Relationship == RelationProcessorCore)
+            {
+                int sibling = 0;
+                for (WORD g = 0; g < entry->Processor.GroupCount; ++g)
+                {
+                    const GROUP_AFFINITY& mask = entry->Processor.GroupMask[g];
+                    for (BYTE bit = 0; bit < sizeof(KAFFINITY) * 8; ++bit)
+                    {
+                        if (mask.Mask & (static_cast<KAFFINITY>(1) << bit))
+                        {
+                            m_processors.push_back({ mask.Group, bit, m_cores, sibling++, 0 });
+                        }
+                    }
+                }
+
+                ++m_cores;
+            }
+            else if (entry->Relationship == RelationNumaNode)
+            {
+                nodeMasks.push_back({ static_cast<int>(entry->NumaNode.NodeNumber), entry->NumaNode.GroupMask });
+            }
+
+            offset += entry->Size;
+        }
+
+        // Number the nodes from 0 in the order the OS gave them
+        std::sort(nodeMasks.begin(), nodeMasks.end(), [](const NodeMask& a, const NodeMask& b)
+            {
+                return a.node < b.node;
+            });
+
+        for (auto& processor : m_processors)
+        {
+            for (int n = 0; n < static_cast<int>(nodeMasks.size()); ++n)
+            {
+                const GROUP_AFFINITY& mask = nodeMasks[n].mask;
+                if (mask.Group == processor.group && (mask.Mask & (static_cast<KAFFINITY>(1) << processor.number)))
+                {
+                    processor.node = n;
+                }
+            }
+        }
+
+        m_nodes = nodeMasks.empty() ? 1 : static_cast<int>(nodeMasks.size());
+    }
+#else
+    // Every processor this process may run on lists its core, package and node in sysfs
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+    {
+        const std::filesystem::path cpus = "/sys/devices/system/cpu";
+        auto readNumber = [](const std::filesystem::path& path)
+            {
+                std::ifstream file(path);
+                int value = -1;
+                file >> value;
+                return value;
+            };
+
+        // Cores are told apart by package and core id, nodes are numbered from 0 in the order found
+        std::vector<std::pair<int, int>> cores;
+        std::vector<int> nodes;
+        std::vector<int> siblings;
+
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &allowed))
+            {
+                continue;
+            }
+
+            const std::filesystem::path topology = cpus / ("cpu" + std::to_string(cpu)) / "topology";
+            std::pair<int, int> key = { readNumber(topology / "physical_package_id"), readNumber(topology / "core_id") };
+
+            int core = static_cast<int>(std::find(cores.begin(), cores.end(), key) - cores.begin());
+            if (key.second < 0 || core == static_cast<int>(cores.size()))
+            {
+                cores.push_back(key);
+                siblings.push_back(0);
+                core = static_cast<int>(cores.size()) - 1;
+            }
+
+            // The node is a nodeN entry in the directory of the processor
+            int nodeId = 0;
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator(cpus / ("cpu" + std::to_string(cpu)), error))
+            {
+                const std::string name = entry.path().filename().string();
+                if (name.size() > 4 && name.compare(0, 4, "node") == 0 && isdigit(static_cast<unsigned char>(name[4])))
+                {
+                    nodeId = std::stoi(name.substr(4));
+                    break;
+                }
+            }
+
+            int node = static_cast<int>(std::find(nodes.begin(), nodes.end(), nodeId) - nodes.begin());
+            if (node == static_cast<int>(nodes.size()))
+            {
+                nodes.push_back(nodeId);
+            }
+
+            m_processors.push_back({ static_cast<WORD>(cpu / 64), static_cast<BYTE>(cpu % 64), core, siblings[core]++, node });
+        }
+
+        m_cores = static_cast<int>(cores.size());
+        m_nodes = nodes.empty() ? 1 : static_cast<int>(nodes.size());
+    }
+#endif
+
+    if (m_processors.empty())
+    {
+        // Nothing is known, treat every logical processor as a core of its own
+        int logical = std::thread::hardware_concurrency() > 0 ? static_cast<int>(std::thread::hardware_concurrency()) : 1;
+        for (int i = 0; i < logical; ++i)
+        {
+            m_processors.push_back({ static_cast<WORD>(i / 64), static_cast<BYTE>(i % 64), i, 0, 0 });
+        }
+
+        m_cores = logical;
+        m_nodes = 1;
+    }
+
+    // Sibling 0 of every core before any sibling 1, and within that the nodes take turns
+    // so a few threads are spread over every socket's memory
+    std::vector<int> coresSeen(m_nodes, 0);
+    std::vector<int> coreRank(m_cores, -1);
+    for (int i = 0; i < static_cast<int>(m_processors.size()); ++i)
+    {
+        const Processor& processor = m_processors[i];
+        if (coreRank[processor.core] < 0)
+        {
+            coreRank[processor.core] = coresSeen[processor.node]++;
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(m_processors.size()); ++i)
+    {
+        m_pinOrder.push_back(i);
+    }
+
+    std::stable_sort(m_pinOrder.begin(), m_pinOrder.end(), [this, &coreRank](int a, int b)
+        {
+            const Processor& pa = m_processors[a];
+            const Processor& pb = m_processors[b];
+
+            if (pa.sibling != pb.sibling)
+            {
+                return pa.sibling < pb.sibling;
+            }
+
+            if (coreRank[pa.core] != coreRank[pb.core])
+            {
+                return coreRank[pa.core] < coreRank[pb.core];
+            }
+
+            return pa.node < pb.node;
+        });
+}
+
+std::vector<Topology::Processor> Topology::WorkerProcessors(int workers) const
+{
+    std::vector<Processor> processors;
+    for (int i = 0; i < workers; ++i)
+    {
+        processors.push_back(m_processors[m_pinOrder[i % m_pinOrder.size()]]);
+    }
+
+    // Workers next to each other take neighbouring chunks of the frame, keep each node's together
+    std::stable_sort(processors.begin(), processors.end(), [](const Processor& a, const Processor& b)
+        {
+            return a.node < b.node;
+        });
+
+    return processors;
+}
+
+bool Topology::Pin(const Processor& processor)
+{
+#ifdef _WIN32
+    GROUP_AFFINITY affinity = {};
+    affinity.Mask = static_cast<KAFFINITY>(1) << processor.number;
+    affinity.Group = processor.group;
+
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#else
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    CPU_SET(processor.group * 64 + processor.number, &affinity);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(affinity), &affinity) == 0;
+#endif
+}
+
+bool Topology::LowerPriority()
+{
+#ifdef _WIN32
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL) != 0;
+#else
+    // The nice value of a Linux thread is its own, threads it starts inherit it
+    const id_t thread = static_cast<id_t>(syscall(SYS_gettid));
+    const int nice = 10;
+
+    errno = 0;
+    const int current = getpriority(PRIO_PROCESS, thread);
+    if (errno == 0 && current >= nice)
+    {
+        return true;
+    }
+
+    return setpriority(PRIO_PROCESS, thread, nice) == 0;
+#endif
+}
+
+int Topology::GetLogicalCount() const
+{
+    return static_cast<int>(m_processors.size());
+}
+
+int Topology::GetCoreCount() const
+{
+    return m_cores;
+}
+
+int Topology::GetNodeCount() const
+{
+    return m_nodes;
+}
+
+std::wstring Topology::Report() const
+{
+    std::wstring report = std::to_wstring(m_nodes) + L" NUMA node(s), " + std::to_wstring(m_cores) +
+        L" physical core(s), " + std::to_wstring(m_processors.size()) + L" logical processor(s)\n";
+
+    for (int node = 0; node < m_nodes; ++node)
+    {
+        int logical = 0;
+        std::vector<int> cores;
+        for (const auto& processor : m_processors)
+        {
+            if (processor.node == node)
+            {
+                ++logical;
+                if (std::find(cores.begin(), cores.end(), processor.core) == cores.end())
+                {
+                    cores.push_back(processor.core);
+                }
+            }
+        }
+
+        report += L"Node " + std::to_wstring(node) + L": " + std::to_wstring(cores.size()) + L" core(s), " +
+            std::to_wstring(logical) + L" logical processor(s)\n";
+    }
+
+    // The order render threads are pinned in
+    report += L"Pin order:";
+    for (int index : m_pinOrder)
+    {
+        const Processor& processor = m_processors[index];
+        report += L" " + std::to_wstring(processor.group) + L":" + std::to_wstring(processor.number);
+    }
+
+    return report;
+}
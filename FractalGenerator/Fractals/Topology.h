@@ -0,0 +1,70 @@
+/*********************************************************************************************
+**
+**	File Name:		topology.h
+**	Description:	This is the header file that contains the class definition for the
+**                  processor topology, the cores, SMT siblings and NUMA nodes of this machine
+**                  and the order render threads are pinned to them in
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Platform.h"
+
+class Topology
+{
+public:
+    // One logical processor (hardware thread)
+    struct Processor
+    {
+        // Processor group and number within the group, as Windows addresses it
+        // Elsewhere the processor with index group * 64 + number
+        WORD group;
+        BYTE number;
+        // Physical core it belongs to and its place among the SMT siblings of that core
+        int core;
+        int sibling;
+        // NUMA node of the core
+        int node;
+    };
+
+private:
+    std::vector<Processor> m_processors;
+
+    // Indexes into m_processors, physical cores spread over the nodes first, then SMT siblings
+    std::vector<int> m_pinOrder;
+
+    int m_cores{};
+    int m_nodes{};
+
+    // Read the topology from the OS, one core per logical processor on a single node if that fails
+    void Detect();
+
+public:
+    // Detected once, on first use
+    static const Topology& Get();
+
+    // Processors the given number of workers are pinned to, worker i to the i-th one
+    // The processors are grouped by node so workers next to each other share a node
+    std::vector<Processor> WorkerProcessors(int workers) const;
+
+    // Pin the calling thread to one processor, returns false if the OS refused
+    static bool Pin(const Processor& processor);
+
+    // Run the calling thread below normal priority, returns false if the OS refused
+    static bool LowerPriority();
+
+    int GetLogicalCount() const;
+
+    int GetCoreCount() const;
+
+    int GetNodeCount() const;
+
+    // Readable summary of the nodes, cores and logical processors
+    std::wstring Report() const;
+};
@@ -0,0 +1,181 @@
+/*********************************************************************************************
+**
+**	File Name:		tuningprofile.cpp
+**	Description:	This is the file that contains the function definitions for the tuning
+**                  profile
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include "TuningProfile.h"
+
+bool TuningProfile::Load(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    m_entries.clear();
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        // Comments and blank lines
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        // fractal precision backend threads tileWidth tileHeight ms [interleave] [fma]
+        std::istringstream fields(line);
+        Entry entry{};
+        std::string precision, language;
+        if (!(fields >> entry.fractal >> precision >> language >> entry.settings.threads >>
+            entry.settings.tileWidth >> entry.settings.tileHeight >> entry.ms))
+        {
+            continue;
+        }
+
+        // Profiles from before the interleaved and FMA kernels leave the interleave to the default
+        if (!(fields >> entry.settings.interleave))
+        {
+            entry.settings.interleave = 0;
+        }
+
+        // and use the FMA kernels like an untuned machine
+        int fma;
+        if (!(fields >> fma))
+        {
+            fma = 1;
+        }
+        entry.settings.fma = fma != 0;
+
+        entry.useFloat = precision == "float";
+        entry.settings.language = LanguageFromName(language);
+
+        if (entry.settings.language && entry.settings.threads > 0 && entry.settings.tileWidth > 0 && entry.settings.tileHeight > 0)
+        {
+            Set(entry);
+        }
+    }
+
+    return true;
+}
+
+bool TuningProfile::Save(const std::filesystem::path& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "# Fractal Generator tuning profile, written by Autotune\n";
+    file << "# fractal precision backend threads tileWidth tileHeight ms interleave fma\n";
+
+    for (const auto& entry : m_entries)
+    {
+        file << entry.fractal << ' ' << (entry.useFloat ? "float" : "double") << ' ' <<
+            LanguageName(entry.settings.language) << ' ' << entry.settings.threads << ' ' <<
+            entry.settings.tileWidth << ' ' << entry.settings.tileHeight << ' ' << entry.ms << ' ' <<
+            entry.settings.interleave << ' ' << (entry.settings.fma ? 1 : 0) << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
+
+const TuningProfile::Entry* TuningProfile::Find(const std::string& fractal, bool useFloat) const
+{
+    for (const auto& entry : m_entries)
+    {
+        if (entry.fractal == fractal && entry.useFloat == useFloat)
+        {
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void TuningProfile::Set(const Entry& entry)
+{
+    for (auto& existing : m_entries)
+    {
+        if (existing.fractal == entry.fractal && existing.useFloat == entry.useFloat)
+        {
+            existing = entry;
+            return;
+        }
+    }
+
+    m_entries.push_back(entry);
+}
+
+const std::vector<TuningProfile::Entry>& TuningProfile::GetEntries() const
+{
+    return m_entries;
+}
+
+bool TuningProfile::IsEmpty() const
+{
+    return m_entries.empty();
+}
+
+const char* TuningProfile::LanguageName(UINT language)
+{
+    switch (language)
+    {
+    case ID_LANGUAGE_CPP:
+    {
+        return "CPP";
+    }
+    case ID_LANGUAGE_SSE:
+    {
+        return "SSE";
+    }
+    case ID_LANGUAGE_AVX:
+    {
+        return "AVX";
+    }
+    case ID_LANGUAGE_CPP_MT:
+    {
+        return "CPP_MT";
+    }
+    case ID_LANGUAGE_SSE_MT:
+    {
+        return "SSE_MT";
+    }
+    case ID_LANGUAGE_AVX_MT:
+    {
+        return "AVX_MT";
+    }
+    default:
+    {
+        return "AUTO";
+    }
+    } // Switch
+}
+
+UINT TuningProfile::LanguageFromName(const std::string& name)
+{
+    const UINT languages[] = {
+        ID_LANGUAGE_CPP, ID_LANGUAGE_SSE, ID_LANGUAGE_AVX,
+        ID_LANGUAGE_CPP_MT, ID_LANGUAGE_SSE_MT, ID_LANGUAGE_AVX_MT
+    };
+
+    for (UINT language : languages)
+    {
+        if (name == LanguageName(language))
+        {
+            return language;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*********************************************************************************************
+**
+**	File Name:		tuningprofile.h
+**	Description:	This is the header file that contains the class definition for the tuning
+**                  profile, the fastest render settings of each fractal and precision found
+**                  by the autotuner on this machine
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#pragma once
+
+#include <filesystem>
+#include "Fractal.h"
+
+class TuningProfile
+{
+public:
+    // Fastest settings of one fractal in one precision
+    struct Entry
+    {
+        std::string fractal;
+        bool useFloat;
+        RenderSettings settings;
+        // Time of a full frame with these settings
+        double ms;
+    };
+
+private:
+    std::vector<Entry> m_entries;
+
+public:
+    // Read a profile written by Save, returns false if the file is missing or malformed
+    // Lines that can not be read are skipped
+    bool Load(const std::filesystem::path& path);
+
+    // Write the profile as text, one entry per line
+    bool Save(const std::filesystem::path& path) const;
+
+    // Entry of a fractal and precision, nullptr if it was never tuned
+    const Entry* Find(const std::string& fractal, bool useFloat) const;
+
+    // Add an entry, replacing the one of the same fractal and precision
+    void Set(const Entry& entry);
+
+    const std::vector<Entry>& GetEntries() const;
+
+    bool IsEmpty() const;
+
+    // Names of the languages in the profile file
+    static const char* LanguageName(UINT language);
+
+    // 0 if the name is not a language
+    static UINT LanguageFromName(const std::string& name);
+};
@@ -24,13 +24,23 @@
 #define ID_RENDER_GENERATE              40019
 #define ID_RENDER_RECORD                40020
 #define ID_TEST                         40021
+#define ID_RENDER_PROGRESSIVE           40022
+#define ID_RENDER_DEADLINE              40023
+#define ID_RENDER_PREFETCH              40024
+#define ID_RENDER_AUTOTUNE              40025
+#define ID_LANGUAGE_AUTO                40026
+#define ID_RENDER_PINTHREADS            40027
+#define ID_RENDER_TOPOLOGY              40028
+#define ID_RENDER_PERTURBATION          40029
+#define ID_RENDER_SAVEIMAGE             40030
+#define ID_RENDER_SAVESCENE             40031
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        105
-#define _APS_NEXT_COMMAND_VALUE         40022
+#define _APS_NEXT_COMMAND_VALUE         40032
 #define _APS_NEXT_CONTROL_VALUE         1001
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
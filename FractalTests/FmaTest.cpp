@@ -0,0 +1,171 @@
+/*********************************************************************************************
+**
+**	File Name:		fmatest.cpp
+**	Description:	This is the file that contains the test of the FMA kernels, every fractal
+**                  and backend is rendered with and without fused multiply-adds and the
+**                  iteration counts of each tile are compared
+**
+**	Author:			Clarke Needles
+**	Created:		10/19/2026
+**
+**********************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Fractals.h"
+
+// CTest counts a run that returns this as skipped
+static const int s_skipped = 77;
+
+// FMA rounds once where the kernels round twice, which moves the escape of points that are
+// close to the boundary by an iteration or a few (or, deep in a spiral, by many)
+// A tile may differ from the kernels without FMA by this share of its iterations, the worst
+// tile of the start views is a BurningShip float tile at about 2%
+static const double s_tileTolerance = 0.10;
+// and the whole image by this share, the same bound the autotuner keeps FMA under
+static const double s_frameTolerance = 0.01;
+
+static const int s_width = 320;
+static const int s_height = 240;
+static const int s_tileSize = 64;
+// Few enough that every fractal, backend and precision renders in seconds, the points that
+// move are the ones near the boundary, which escape within these anyway
+static const int s_maxIterations = 300;
+
+class TestHost : public RenderHost
+{
+public:
+    TuningProfile m_tuningProfile;
+
+    UINT GetLanguage() override
+    {
+        return ID_LANGUAGE_AVX_MT;
+    }
+
+    UINT GetGradient() override
+    {
+        return ID_GRADIENT_1;
+    }
+
+    bool GetPinThreads() const override
+    {
+        return false;
+    }
+
+    bool GetPerturbation() const override
+    {
+        return false;
+    }
+
+    const TuningProfile& GetTuningProfile() const override
+    {
+        return m_tuningProfile;
+    }
+};
+
+// Iteration counts of the start view of a fractal
+static std::vector<uint16_t> RenderCounts(const Fractal& fractal, UINT language, bool forceDouble, bool fma)
+{
+    RenderRequest request = fractal.GetRequest();
+    request.format = PixelFormat::Iterations;
+    request.stride = s_width * sizeof(uint16_t);
+    request.maxIterations = s_maxIterations;
+    request.forceDouble = forceDouble;
+    request.settings = { language, 0, s_tileSize, s_tileSize, false, 0, fma, false, false };
+
+    std::vector<uint16_t> counts(static_cast<size_t>(s_width) * s_height);
+    if (!fractal.Render(request, counts.data()))
+    {
+        counts.clear();
+    }
+
+    return counts;
+}
+
+// Iterations of each tile, in rows from the top left
+static std::vector<double> TileIterations(const std::vector<uint16_t>& counts)
+{
+    const int columns = (s_width + s_tileSize - 1) / s_tileSize, rows = (s_height + s_tileSize - 1) / s_tileSize;
+
+    std::vector<double> tiles(static_cast<size_t>(columns) * rows);
+    for (int y = 0; y < s_height; ++y)
+    {
+        for (int x = 0; x < s_width; ++x)
+        {
+            tiles[y / s_tileSize * columns + x / s_tileSize] += counts[static_cast<size_t>(y) * s_width + x];
+        }
+    }
+
+    return tiles;
+}
+
+int main()
+{
+    if (!Fractal::HasFMA())
+    {
+        printf("no FMA3 on this CPU, the FMA kernels are never used\n");
+        return s_skipped;
+    }
+
+    auto host = std::make_shared<TestHost>();
+    host->m_widthW = s_width;
+    host->m_heightW = s_height;
+
+    std::vector<std::unique_ptr<Fractal>> fractals;
+    fractals.push_back(std::make_unique<Mandelbrot>(host));
+    fractals.push_back(std::make_unique<BurningShip>(host));
+    fractals.push_back(std::make_unique<Multibrot>(host));
+    fractals.push_back(std::make_unique<Nova>(host));
+    fractals.push_back(std::make_unique<Pheonix>(host));
+
+    int failures = 0;
+    for (const std::unique_ptr<Fractal>& fractal : fractals)
+    {
+        for (UINT language : { ID_LANGUAGE_CPP, ID_LANGUAGE_SSE, ID_LANGUAGE_AVX, ID_LANGUAGE_CPP_MT, ID_LANGUAGE_SSE_MT, ID_LANGUAGE_AVX_MT })
+        {
+            for (bool forceDouble : { false, true })
+            {
+                const std::vector<uint16_t> plain = RenderCounts(*fractal, language, forceDouble, false);
+                const std::vector<uint16_t> fused = RenderCounts(*fractal, language, forceDouble, true);
+                if (plain.empty() || fused.empty())
+                {
+                    printf("FAIL %s %s %s: the render failed\n", fractal->GetName(), TuningProfile::LanguageName(language), forceDouble ? "double" : "float");
+                    ++failures;
+                    continue;
+                }
+
+                int pixels = 0;
+                for (size_t i = 0; i < plain.size(); ++i)
+                {
+                    pixels += plain[i] != fused[i] ? 1 : 0;
+                }
+
+                // Share of the iterations of each tile that moved
+                const std::vector<double> plainTiles = TileIterations(plain), fusedTiles = TileIterations(fused);
+                double worstTile = 0, differing = 0, total = 0;
+                for (size_t i = 0; i < plainTiles.size(); ++i)
+                {
+                    const double difference = fabs(plainTiles[i] - fusedTiles[i]);
+                    worstTile = std::max(worstTile, plainTiles[i] > 0 ? difference / plainTiles[i] : difference);
+                    differing += difference;
+                    total += plainTiles[i];
+                }
+                const double frame = total > 0 ? differing / total : 0.0;
+
+                const bool passed = worstTile <= s_tileTolerance && frame <= s_frameTolerance;
+                failures += passed ? 0 : 1;
+
+                printf("%s %s %s %s: %d pixels differ, worst tile %.3f%%, frame %.4f%%\n", passed ? "ok  " : "FAIL", fractal->GetName(),
+                    TuningProfile::LanguageName(language), forceDouble ? "double" : "float", pixels, worstTile * 100, frame * 100);
+            }
+        }
+    }
+
+    printf("%d failure(s), tolerance %.1f%% of a tile and %.1f%% of the image\n", failures, s_tileTolerance * 100, s_frameTolerance * 100);
+    return failures ? 1 : 0;
+}